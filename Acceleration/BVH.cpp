@@ -0,0 +1,305 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#include "BVH.h"
+
+#include <chrono>
+#include <numeric>
+
+void BVHStats::print(std::ostream& out, const std::string& name) const {
+    out << "BVH [" << name << "]: "
+        << primitiveCount << " primitives, "
+        << nodeCount << " nodes (" << leafCount << " leaves), "
+        << "max depth " << maxDepth << ", "
+        << "SAH cost " << sahCost << ", "
+        << "built in " << buildTimeMs << " ms" << std::endl;
+}
+
+void BVH::build(const std::vector<AABB>& primitiveBounds) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<BVHNode>& nodeList = nodes.edit();
+    std::vector<uint32_t>& indices = primitiveIndices.edit();
+
+    const uint32_t primitiveCount = static_cast<uint32_t>(primitiveBounds.size());
+
+    nodeList.clear();
+    indices.resize(primitiveCount);
+    std::iota(indices.begin(), indices.end(), 0);
+    stats = BVHStats();
+    stats.primitiveCount = primitiveCount;
+
+    if (primitiveCount == 0) {
+        return;
+    }
+
+    std::vector<glm::vec3> centroids(primitiveCount);
+    for (uint32_t i = 0; i < primitiveCount; i++) {
+        centroids[i] = primitiveBounds[i].centroid();
+    }
+
+    // A binary tree with n leaves has at most 2n - 1 nodes
+    nodeList.reserve(2 * primitiveCount - 1);
+    BVHNode root{};
+    root.leftFirst = 0;
+    root.primitiveCount = primitiveCount;
+    nodeList.push_back(root);
+    updateNodeBounds(0, primitiveBounds);
+    subdivide(0, primitiveBounds, centroids, 0);
+    nodeList.shrink_to_fit();
+
+    stats.nodeCount = nodeList.size();
+    for (const BVHNode& node : nodeList) {
+        if (node.isLeaf()) {
+            stats.leafCount++;
+        }
+    }
+    stats.sahCost = computeSAHCost();
+
+    auto end = std::chrono::steady_clock::now();
+    stats.buildTimeMs = std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void BVH::refit(const std::vector<AABB>& primitiveBounds) {
+    std::vector<BVHNode>& nodeList = nodes.edit();
+    // Children are always stored after their parent, so walking backwards
+    // visits both children before the node that encloses them
+    for (size_t i = nodeList.size(); i-- > 0;) {
+        BVHNode& node = nodeList[i];
+        if (node.isLeaf()) {
+            updateNodeBounds(static_cast<uint32_t>(i), primitiveBounds);
+        }
+        else {
+            const BVHNode& left = nodeList[node.leftFirst];
+            const BVHNode& right = nodeList[node.leftFirst + 1];
+            node.boundsMin = glm::min(left.boundsMin, right.boundsMin);
+            node.boundsMax = glm::max(left.boundsMax, right.boundsMax);
+        }
+    }
+    if (!nodeList.empty()) {
+        stats.sahCost = computeSAHCost();
+    }
+}
+
+std::vector<uint32_t> BVH::refitLeaves(const std::vector<AABB>& primitiveBounds, std::span<const uint32_t> leaves,
+    std::span<const uint32_t> parents) {
+    std::vector<uint32_t> changed;
+    if (nodes.empty()) {
+        return changed;
+    }
+    for (uint32_t leaf : leaves) {
+        for (uint32_t node = leaf; ; node = parents[node]) {
+            changed.push_back(node);
+            if (node == 0) {
+                break;
+            }
+        }
+    }
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+
+    std::vector<BVHNode>& nodeList = nodes.edit();
+    auto nodeCost = [&](const BVHNode& node) {
+        float area = AABB{node.boundsMin, node.boundsMax}.surfaceArea();
+        return node.isLeaf() ? INTERSECTION_COST * node.primitiveCount * area : TRAVERSAL_COST * area;
+    };
+    // The cost is a sum over nodes divided by the root's area, so only the
+    // changed terms need recomputing
+    const float oldRootArea = getBounds().surfaceArea();
+    float unnormalizedCost = stats.sahCost * oldRootArea;
+    // Children come after their parent, so descending order refits both
+    // children before the node enclosing them
+    for (size_t i = changed.size(); i-- > 0;) {
+        BVHNode& node = nodeList[changed[i]];
+        unnormalizedCost -= nodeCost(node);
+        if (node.isLeaf()) {
+            updateNodeBounds(changed[i], primitiveBounds);
+        }
+        else {
+            const BVHNode& left = nodeList[node.leftFirst];
+            const BVHNode& right = nodeList[node.leftFirst + 1];
+            node.boundsMin = glm::min(left.boundsMin, right.boundsMin);
+            node.boundsMax = glm::max(left.boundsMax, right.boundsMax);
+        }
+        unnormalizedCost += nodeCost(node);
+    }
+
+    const float rootArea = getBounds().surfaceArea();
+    if (oldRootArea <= 0.0f) {
+        stats.sahCost = computeSAHCost();
+    }
+    else {
+        stats.sahCost = rootArea > 0.0f ? std::max(unnormalizedCost, 0.0f) / rootArea : 0.0f;
+    }
+    return changed;
+}
+
+void BVH::assign(MappedArray<BVHNode> nodes, MappedArray<uint32_t> primitiveIndices, const BVHStats& stats) {
+    this->nodes = std::move(nodes);
+    this->primitiveIndices = std::move(primitiveIndices);
+    this->stats = stats;
+}
+
+void BVH::updateNodeBounds(uint32_t nodeIndex, const std::vector<AABB>& primitiveBounds) {
+    std::vector<BVHNode>& nodeList = nodes.edit();
+    std::vector<uint32_t>& indices = primitiveIndices.edit();
+    BVHNode& node = nodeList[nodeIndex];
+    AABB bounds;
+    for (uint32_t i = 0; i < node.primitiveCount; i++) {
+        bounds.grow(primitiveBounds[indices[node.leftFirst + i]]);
+    }
+    node.boundsMin = bounds.min;
+    node.boundsMax = bounds.max;
+}
+
+void BVH::subdivide(uint32_t nodeIndex, const std::vector<AABB>& primitiveBounds,
+    const std::vector<glm::vec3>& centroids, int depth) {
+    std::vector<BVHNode>& nodeList = nodes.edit();
+    std::vector<uint32_t>& indices = primitiveIndices.edit();
+    stats.maxDepth = std::max(stats.maxDepth, depth);
+
+    const uint32_t first = nodeList[nodeIndex].leftFirst;
+    const uint32_t count = nodeList[nodeIndex].primitiveCount;
+    if (count <= 1) {
+        return;
+    }
+
+    AABB centroidBounds;
+    for (uint32_t i = first; i < first + count; i++) {
+        centroidBounds.grow(centroids[indices[i]]);
+    }
+
+    // Binned SAH: drop the centroids into BIN_COUNT slabs per axis and
+    // evaluate every plane between two bins
+    int bestAxis = -1;
+    int bestSplit = 0;
+    float bestCost = FLT_MAX;
+
+    if (depth < MAX_DEPTH / 2) {
+        for (int axis = 0; axis < 3; axis++) {
+            float axisMin = centroidBounds.min[axis];
+            float axisMax = centroidBounds.max[axis];
+            if (axisMax <= axisMin) {
+                continue;
+            }
+
+            AABB binBounds[BIN_COUNT];
+            uint32_t binCount[BIN_COUNT] = {};
+            float scale = BIN_COUNT / (axisMax - axisMin);
+            for (uint32_t i = first; i < first + count; i++) {
+                uint32_t primitive = indices[i];
+                int bin = std::min(BIN_COUNT - 1, (int)((centroids[primitive][axis] - axisMin) * scale));
+                binCount[bin]++;
+                binBounds[bin].grow(primitiveBounds[primitive]);
+            }
+
+            float leftArea[BIN_COUNT - 1], rightArea[BIN_COUNT - 1];
+            uint32_t leftCount[BIN_COUNT - 1], rightCount[BIN_COUNT - 1];
+            AABB leftBox, rightBox;
+            uint32_t leftSum = 0, rightSum = 0;
+            for (int i = 0; i < BIN_COUNT - 1; i++) {
+                leftSum += binCount[i];
+                leftCount[i] = leftSum;
+                leftBox.grow(binBounds[i]);
+                leftArea[i] = leftBox.surfaceArea();
+
+                rightSum += binCount[BIN_COUNT - 1 - i];
+                rightCount[BIN_COUNT - 2 - i] = rightSum;
+                rightBox.grow(binBounds[BIN_COUNT - 1 - i]);
+                rightArea[BIN_COUNT - 2 - i] = rightBox.surfaceArea();
+            }
+
+            for (int i = 0; i < BIN_COUNT - 1; i++) {
+                if (leftCount[i] == 0 || rightCount[i] == 0) {
+                    continue;
+                }
+                float cost = leftCount[i] * leftArea[i] + rightCount[i] * rightArea[i];
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = i;
+                }
+            }
+        }
+    }
+
+    uint32_t leftCount;
+    if (bestAxis >= 0) {
+        AABB nodeBounds{nodeList[nodeIndex].boundsMin, nodeList[nodeIndex].boundsMax};
+        float nodeArea = nodeBounds.surfaceArea();
+        float splitCost = TRAVERSAL_COST * nodeArea + INTERSECTION_COST * bestCost;
+        float leafCost = INTERSECTION_COST * count * nodeArea;
+        if (splitCost >= leafCost && count <= MAX_LEAF_SIZE) {
+            return;
+        }
+
+        float axisMin = centroidBounds.min[bestAxis];
+        float scale = BIN_COUNT / (centroidBounds.max[bestAxis] - axisMin);
+        auto middle = std::partition(
+            indices.begin() + first,
+            indices.begin() + first + count,
+            [&](uint32_t primitive) {
+                int bin = std::min(BIN_COUNT - 1, (int)((centroids[primitive][bestAxis] - axisMin) * scale));
+                return bin <= bestSplit;
+            });
+        leftCount = static_cast<uint32_t>(middle - (indices.begin() + first));
+    }
+    else {
+        // Every centroid is in the same spot, or the tree is getting too
+        // deep: split the range in half along the widest axis
+        if (count <= MAX_LEAF_SIZE) {
+            return;
+        }
+        glm::vec3 extent = centroidBounds.max - centroidBounds.min;
+        int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+        leftCount = count / 2;
+        std::nth_element(
+            indices.begin() + first,
+            indices.begin() + first + leftCount,
+            indices.begin() + first + count,
+            [&](uint32_t a, uint32_t b) {
+                return centroids[a][axis] < centroids[b][axis];
+            });
+    }
+
+    if (leftCount == 0 || leftCount == count) {
+        return;
+    }
+
+    uint32_t leftChild = static_cast<uint32_t>(nodeList.size());
+    BVHNode left{};
+    left.leftFirst = first;
+    left.primitiveCount = leftCount;
+    BVHNode right{};
+    right.leftFirst = first + leftCount;
+    right.primitiveCount = count - leftCount;
+    nodeList.push_back(left);
+    nodeList.push_back(right);
+
+    nodeList[nodeIndex].leftFirst = leftChild;
+    nodeList[nodeIndex].primitiveCount = 0;
+
+    updateNodeBounds(leftChild, primitiveBounds);
+    updateNodeBounds(leftChild + 1, primitiveBounds);
+    subdivide(leftChild, primitiveBounds, centroids, depth + 1);
+    subdivide(leftChild + 1, primitiveBounds, centroids, depth + 1);
+}
+
+float BVH::computeSAHCost() const {
+    float rootArea = AABB{nodes[0].boundsMin, nodes[0].boundsMax}.surfaceArea();
+    if (rootArea <= 0.0f) {
+        return 0.0f;
+    }
+
+    float cost = 0.0f;
+    for (const BVHNode& node : nodes) {
+        float area = AABB{node.boundsMin, node.boundsMax}.surfaceArea() / rootArea;
+        if (node.isLeaf()) {
+            cost += INTERSECTION_COST * node.primitiveCount * area;
+        }
+        else {
+            cost += TRAVERSAL_COST * area;
+        }
+    }
+    return cost;
+}
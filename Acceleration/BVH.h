@@ -0,0 +1,220 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#ifndef BVH_H
+#define BVH_H
+#include <algorithm>
+#include <cfloat>
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../Utilities/MappedFile.h"
+
+struct AABB {
+    glm::vec3 min = glm::vec3(FLT_MAX);
+    glm::vec3 max = glm::vec3(-FLT_MAX);
+
+    void grow(const glm::vec3& point) {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+    void grow(const AABB& other) {
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+    }
+    [[nodiscard]] bool isEmpty() const {
+        return min.x > max.x || min.y > max.y || min.z > max.z;
+    }
+    [[nodiscard]] glm::vec3 centroid() const {
+        return (min + max) * 0.5f;
+    }
+    [[nodiscard]] float surfaceArea() const {
+        if (isEmpty()) {
+            return 0.0f;
+        }
+        glm::vec3 extent = max - min;
+        return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+    }
+    // Box around the transformed box (Arvo's method, no need to transform the 8 corners)
+    [[nodiscard]] AABB transformed(const glm::mat4& transform) const {
+        if (isEmpty()) {
+            return *this;
+        }
+        glm::vec3 center = glm::vec3(transform * glm::vec4(centroid(), 1.0f));
+        glm::vec3 halfExtent = (max - min) * 0.5f;
+        glm::vec3 newHalfExtent;
+        for (int row = 0; row < 3; row++) {
+            newHalfExtent[row] = std::abs(transform[0][row]) * halfExtent.x
+                + std::abs(transform[1][row]) * halfExtent.y
+                + std::abs(transform[2][row]) * halfExtent.z;
+        }
+        return {center - newHalfExtent, center + newHalfExtent};
+    }
+};
+
+// 32 bytes, same layout as the std430 struct used by the shaders.
+// Interior nodes have primitiveCount == 0 and their children are stored next
+// to each other at leftFirst and leftFirst + 1. Leaves cover the primitives
+// [leftFirst, leftFirst + primitiveCount).
+struct alignas(16) BVHNode {
+    glm::vec3 boundsMin;
+    uint32_t leftFirst;
+    glm::vec3 boundsMax;
+    uint32_t primitiveCount;
+
+    [[nodiscard]] bool isLeaf() const {
+        return primitiveCount > 0;
+    }
+};
+
+struct BVHStats {
+    size_t primitiveCount = 0;
+    size_t nodeCount = 0;
+    size_t leafCount = 0;
+    int maxDepth = 0;
+    float sahCost = 0.0f;
+    double buildTimeMs = 0.0;
+
+    void print(std::ostream& out, const std::string& name) const;
+};
+
+// Binary bounding volume hierarchy built with a binned surface area
+// heuristic. It only knows about primitive bounds: the owner reorders its
+// primitives with getPrimitiveIndices() after the build so that leaves refer
+// to contiguous ranges.
+class BVH {
+public:
+    static constexpr int BIN_COUNT = 16;
+    static constexpr uint32_t MAX_LEAF_SIZE = 4;
+    static constexpr float TRAVERSAL_COST = 1.0f;
+    static constexpr float INTERSECTION_COST = 1.0f;
+    // Also the size of the traversal stacks. Past half of it the builder
+    // switches to median splits, which bounds the remaining depth to log2(n)
+    static constexpr int MAX_DEPTH = 64;
+
+    void build(const std::vector<AABB>& primitiveBounds);
+    // Recomputes every node's bounds for moved primitives while keeping the
+    // topology. Much cheaper than a build, but the tree degrades as things move.
+    void refit(const std::vector<AABB>& primitiveBounds);
+    // Same for a few moved primitives: refits only the given leaves and their
+    // ancestors, parents[i] being node i's parent. The SAH cost is updated
+    // from the changed nodes alone. Returns the refitted nodes, ascending.
+    std::vector<uint32_t> refitLeaves(const std::vector<AABB>& primitiveBounds, std::span<const uint32_t> leaves,
+        std::span<const uint32_t> parents);
+    // Takes a tree built earlier instead of building one, e.g. views into a
+    // mesh cache file
+    void assign(MappedArray<BVHNode> nodes, MappedArray<uint32_t> primitiveIndices, const BVHStats& stats);
+
+    [[nodiscard]] bool isEmpty() const {
+        return nodes.empty();
+    }
+    [[nodiscard]] std::span<const BVHNode> getNodes() const {
+        return nodes.span();
+    }
+    [[nodiscard]] std::span<const uint32_t> getPrimitiveIndices() const {
+        return primitiveIndices.span();
+    }
+    [[nodiscard]] const BVHStats& getStats() const {
+        return stats;
+    }
+    [[nodiscard]] AABB getBounds() const {
+        if (nodes.empty()) {
+            return {};
+        }
+        return {nodes[0].boundsMin, nodes[0].boundsMax};
+    }
+
+    // Slab test, returns the entry distance or FLT_MAX when the box is missed
+    // or starts beyond tMax
+    static float intersectAABB(const glm::vec3& origin, const glm::vec3& invDir,
+        const glm::vec3& boundsMin, const glm::vec3& boundsMax, float tMax) {
+        glm::vec3 t0 = (boundsMin - origin) * invDir;
+        glm::vec3 t1 = (boundsMax - origin) * invDir;
+        glm::vec3 tSmall = glm::min(t0, t1);
+        glm::vec3 tBig = glm::max(t0, t1);
+        float tNear = std::max(std::max(tSmall.x, tSmall.y), std::max(tSmall.z, 0.0f));
+        float tFar = std::min(std::min(tBig.x, tBig.y), std::min(tBig.z, tMax));
+        return tNear <= tFar ? tNear : FLT_MAX;
+    }
+
+    // Front-to-back traversal. intersectLeaf(first, count) tests a primitive
+    // range and lowers tMax when it finds a closer hit, which culls every node
+    // that starts further away.
+    template<typename LeafFunction>
+    void traverse(const glm::vec3& origin, const glm::vec3& direction, float& tMax, LeafFunction&& intersectLeaf) const {
+        if (nodes.empty()) {
+            return;
+        }
+        const BVHNode* nodeData = nodes.data();
+        const glm::vec3 invDir = 1.0f / direction;
+
+        if (intersectAABB(origin, invDir, nodeData[0].boundsMin, nodeData[0].boundsMax, tMax) == FLT_MAX) {
+            return;
+        }
+
+        uint32_t stack[MAX_DEPTH];
+        float stackDist[MAX_DEPTH];
+        int stackSize = 0;
+        uint32_t current = 0;
+
+        while (true) {
+            const BVHNode& node = nodeData[current];
+            if (node.isLeaf()) {
+                intersectLeaf(node.leftFirst, node.primitiveCount);
+            }
+            else {
+                uint32_t nearChild = node.leftFirst;
+                uint32_t farChild = node.leftFirst + 1;
+                float nearDist = intersectAABB(origin, invDir, nodeData[nearChild].boundsMin, nodeData[nearChild].boundsMax, tMax);
+                float farDist = intersectAABB(origin, invDir, nodeData[farChild].boundsMin, nodeData[farChild].boundsMax, tMax);
+                if (farDist < nearDist) {
+                    std::swap(nearChild, farChild);
+                    std::swap(nearDist, farDist);
+                }
+                if (nearDist != FLT_MAX) {
+                    if (farDist != FLT_MAX) {
+                        stack[stackSize] = farChild;
+                        stackDist[stackSize] = farDist;
+                        stackSize++;
+                    }
+                    current = nearChild;
+                    continue;
+                }
+            }
+
+            // Pop the next node that can still beat the closest hit
+            bool found = false;
+            while (stackSize > 0) {
+                stackSize--;
+                if (stackDist[stackSize] < tMax) {
+                    current = stack[stackSize];
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                return;
+            }
+        }
+    }
+
+private:
+    MappedArray<BVHNode> nodes;
+    MappedArray<uint32_t> primitiveIndices;
+    BVHStats stats;
+
+    void subdivide(uint32_t nodeIndex, const std::vector<AABB>& primitiveBounds,
+        const std::vector<glm::vec3>& centroids, int depth);
+    void updateNodeBounds(uint32_t nodeIndex, const std::vector<AABB>& primitiveBounds);
+    float computeSAHCost() const;
+};
+
+
+
+#endif //BVH_H
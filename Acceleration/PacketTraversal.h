@@ -0,0 +1,297 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#ifndef PACKETTRAVERSAL_H
+#define PACKETTRAVERSAL_H
+#include "RayPacket.h"
+
+// Packet kernel shared by PacketTraversalAVX2.cpp and PacketTraversalAVX512.cpp.
+// Simd wraps one instruction set: WIDTH, the Float vector and Mask lane mask
+// types, arithmetic, compares, selects and mask operations.
+//
+// Every lane runs the same node and primitive tests and lanes that miss are
+// masked off. A node is entered as long as one active lane hits it.
+//
+// Those files are compiled with -mavx2 / -mavx512f, so this must not call
+// inline functions from other headers (glm, std, BVHNode::isLeaf...). The
+// linker keeps a single copy of each and could pick the AVX one for the whole
+// program, which breaks the scalar path on CPUs without it.
+template<typename Simd>
+class PacketTraversal {
+public:
+    using Float = typename Simd::Float;
+    using Mask = typename Simd::Mask;
+
+    static void intersect(const PacketScene& scene, RayPacket& packet) {
+        Rays rays;
+        rays.originX = Simd::load(packet.originX);
+        rays.originY = Simd::load(packet.originY);
+        rays.originZ = Simd::load(packet.originZ);
+        rays.directionX = Simd::load(packet.directionX);
+        rays.directionY = Simd::load(packet.directionY);
+        rays.directionZ = Simd::load(packet.directionZ);
+        computeInverseDirection(rays);
+
+        Hits hits;
+        hits.tMax = Simd::load(packet.tMax);
+        hits.instance = Simd::fromInt(-1);
+        hits.primitive = Simd::fromInt(0);
+        hits.u = Simd::set1(0.0f);
+        hits.v = Simd::set1(0.0f);
+
+        const Mask active = Simd::fromBits(packet.activeMask);
+
+        traverse(scene.tlasNodes, rays, hits.tMax, active, [&](uint32_t first, uint32_t count, Mask leafMask) {
+            for (uint32_t i = first; i < first + count; i++) {
+                const uint32_t instanceIndex = scene.tlasInstances[i];
+                const PacketInstance& instance = scene.instances[instanceIndex];
+                Rays localRays = transformRays(rays, instance.inverseTransform);
+                if (instance.isMesh) {
+                    intersectMesh(instance, instanceIndex, localRays, leafMask, hits);
+                }
+                else {
+                    intersectSphere(instance, instanceIndex, localRays, leafMask, hits);
+                }
+            }
+        });
+
+        Simd::store(packet.tMax, hits.tMax);
+        Simd::storeBits(packet.instance, hits.instance);
+        Simd::storeBits(packet.primitive, hits.primitive);
+        Simd::store(packet.u, hits.u);
+        Simd::store(packet.v, hits.v);
+    }
+
+private:
+    struct Rays {
+        Float originX, originY, originZ;
+        Float directionX, directionY, directionZ;
+        Float invDirX, invDirY, invDirZ;
+    };
+
+    // Closest hit per lane, instance and primitive hold integer bits
+    struct Hits {
+        Float tMax;
+        Float instance;
+        Float primitive;
+        Float u, v;
+    };
+
+    static void computeInverseDirection(Rays& rays) {
+        const Float one = Simd::set1(1.0f);
+        rays.invDirX = Simd::div(one, rays.directionX);
+        rays.invDirY = Simd::div(one, rays.directionY);
+        rays.invDirZ = Simd::div(one, rays.directionZ);
+    }
+
+    // The direction isn't renormalized so t stays the same in both spaces,
+    // same as SceneObject::intersectWith
+    static Rays transformRays(const Rays& rays, const float* m) {
+        Rays local;
+        local.originX = transformRow(rays.originX, rays.originY, rays.originZ, m[0], m[1], m[2], m[3]);
+        local.originY = transformRow(rays.originX, rays.originY, rays.originZ, m[4], m[5], m[6], m[7]);
+        local.originZ = transformRow(rays.originX, rays.originY, rays.originZ, m[8], m[9], m[10], m[11]);
+        local.directionX = transformRow(rays.directionX, rays.directionY, rays.directionZ, m[0], m[1], m[2], 0.0f);
+        local.directionY = transformRow(rays.directionX, rays.directionY, rays.directionZ, m[4], m[5], m[6], 0.0f);
+        local.directionZ = transformRow(rays.directionX, rays.directionY, rays.directionZ, m[8], m[9], m[10], 0.0f);
+        computeInverseDirection(local);
+        return local;
+    }
+
+    static Float transformRow(const Float& x, const Float& y, const Float& z, float mx, float my, float mz, float offset) {
+        Float result = Simd::fmadd(x, Simd::set1(mx), Simd::set1(offset));
+        result = Simd::fmadd(y, Simd::set1(my), result);
+        return Simd::fmadd(z, Simd::set1(mz), result);
+    }
+
+    static Float dot(const Float& ax, const Float& ay, const Float& az, const Float& bx, const Float& by, const Float& bz) {
+        return Simd::fmadd(ax, bx, Simd::fmadd(ay, by, Simd::mul(az, bz)));
+    }
+
+    // Vector version of BVH::intersectAABB, tNear is the entry distance of the
+    // lanes in the returned mask
+    static Mask intersectBox(const Rays& rays, const BVHNode& node, const Float& tMax, Float& tNear) {
+        Float t0x = Simd::mul(Simd::sub(Simd::set1(node.boundsMin.x), rays.originX), rays.invDirX);
+        Float t0y = Simd::mul(Simd::sub(Simd::set1(node.boundsMin.y), rays.originY), rays.invDirY);
+        Float t0z = Simd::mul(Simd::sub(Simd::set1(node.boundsMin.z), rays.originZ), rays.invDirZ);
+        Float t1x = Simd::mul(Simd::sub(Simd::set1(node.boundsMax.x), rays.originX), rays.invDirX);
+        Float t1y = Simd::mul(Simd::sub(Simd::set1(node.boundsMax.y), rays.originY), rays.invDirY);
+        Float t1z = Simd::mul(Simd::sub(Simd::set1(node.boundsMax.z), rays.originZ), rays.invDirZ);
+
+        tNear = Simd::max(
+            Simd::max(Simd::min(t0x, t1x), Simd::min(t0y, t1y)),
+            Simd::max(Simd::min(t0z, t1z), Simd::set1(0.0f)));
+        Float tFar = Simd::min(
+            Simd::min(Simd::max(t0x, t1x), Simd::max(t0y, t1y)),
+            Simd::min(Simd::max(t0z, t1z), tMax));
+        return Simd::le(tNear, tFar);
+    }
+
+    static Mask intersectBox(const Rays& rays, const BVHNode& node, const Float& tMax) {
+        Float tNear;
+        return intersectBox(rays, node, tMax, tNear);
+    }
+
+    // Same walk as BVH::traverse with a lane mask per node. tMax is read
+    // through the reference, so hits found in a leaf cull the nodes behind
+    // them. intersectLeaf(first, count, mask) gets the lanes that hit the leaf.
+    template<typename LeafFunction>
+    static void traverse(const BVHNode* nodes, const Rays& rays, const Float& tMax, Mask active, LeafFunction&& intersectLeaf) {
+        Mask mask = Simd::andMask(intersectBox(rays, nodes[0], tMax), active);
+        if (Simd::bits(mask) == 0) {
+            return;
+        }
+
+        uint32_t stack[BVH::MAX_DEPTH];
+        int stackSize = 0;
+        uint32_t current = 0;
+
+        while (true) {
+            const BVHNode& node = nodes[current];
+            if (node.primitiveCount > 0) {
+                intersectLeaf(node.leftFirst, node.primitiveCount, mask);
+            }
+            else {
+                uint32_t nearChild = node.leftFirst;
+                uint32_t farChild = node.leftFirst + 1;
+                Float nearDist, farDist;
+                Mask nearMask = Simd::andMask(intersectBox(rays, nodes[nearChild], tMax, nearDist), active);
+                Mask farMask = Simd::andMask(intersectBox(rays, nodes[farChild], tMax, farDist), active);
+                const uint32_t nearBits = Simd::bits(nearMask);
+                const uint32_t farBits = Simd::bits(farMask);
+
+                if (nearBits != 0 && farBits != 0) {
+                    // Coherent rays mostly agree on the order, follow the
+                    // first lane that hits both children
+                    const uint32_t both = nearBits & farBits;
+                    const uint32_t firstLane = both & (0u - both);
+                    if ((Simd::bits(Simd::lt(farDist, nearDist)) & firstLane) != 0) {
+                        const uint32_t child = nearChild;
+                        nearChild = farChild;
+                        farChild = child;
+                        const Mask childMask = nearMask;
+                        nearMask = farMask;
+                        farMask = childMask;
+                    }
+                    stack[stackSize++] = farChild;
+                    current = nearChild;
+                    mask = nearMask;
+                    continue;
+                }
+                if (nearBits != 0) {
+                    current = nearChild;
+                    mask = nearMask;
+                    continue;
+                }
+                if (farBits != 0) {
+                    current = farChild;
+                    mask = farMask;
+                    continue;
+                }
+            }
+
+            // The lanes that hit a stacked node may have found closer hits
+            // since, so it is tested again with the current tMax
+            bool found = false;
+            while (stackSize > 0) {
+                current = stack[--stackSize];
+                mask = Simd::andMask(intersectBox(rays, nodes[current], tMax), active);
+                if (Simd::bits(mask) != 0) {
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                return;
+            }
+        }
+    }
+
+    static void recordHits(Hits& hits, Mask mask, const Float& t, uint32_t instanceIndex, uint32_t primitiveIndex,
+        const Float& u, const Float& v) {
+        hits.tMax = Simd::select(mask, t, hits.tMax);
+        hits.instance = Simd::select(mask, Simd::fromInt(static_cast<int32_t>(instanceIndex)), hits.instance);
+        hits.primitive = Simd::select(mask, Simd::fromInt(static_cast<int32_t>(primitiveIndex)), hits.primitive);
+        hits.u = Simd::select(mask, u, hits.u);
+        hits.v = Simd::select(mask, v, hits.v);
+    }
+
+    // SphereObject::localIntersect for every lane
+    static void intersectSphere(const PacketInstance& instance, uint32_t instanceIndex, const Rays& rays, Mask mask, Hits& hits) {
+        Float a = dot(rays.directionX, rays.directionY, rays.directionZ, rays.directionX, rays.directionY, rays.directionZ);
+        Float b = Simd::mul(Simd::set1(2.0f),
+            dot(rays.directionX, rays.directionY, rays.directionZ, rays.originX, rays.originY, rays.originZ));
+        Float c = Simd::sub(dot(rays.originX, rays.originY, rays.originZ, rays.originX, rays.originY, rays.originZ),
+            Simd::set1(instance.radius * instance.radius));
+        Float discriminant = Simd::sub(Simd::mul(b, b), Simd::mul(Simd::set1(4.0f), Simd::mul(a, c)));
+
+        const Float zero = Simd::set1(0.0f);
+        Float t = Simd::div(Simd::sub(Simd::sub(zero, b), Simd::sqrt(Simd::max(discriminant, zero))),
+            Simd::mul(Simd::set1(2.0f), a));
+
+        Mask hit = Simd::andMask(mask, Simd::ge(discriminant, zero));
+        hit = Simd::andMask(hit, Simd::gt(t, zero));
+        hit = Simd::andMask(hit, Simd::lt(t, hits.tMax));
+        if (Simd::bits(hit) != 0) {
+            recordHits(hits, hit, t, instanceIndex, 0, zero, zero);
+        }
+    }
+
+    static void intersectMesh(const PacketInstance& instance, uint32_t instanceIndex, const Rays& rays, Mask mask, Hits& hits) {
+        if (instance.nodes == nullptr) {
+            return;
+        }
+        traverse(instance.nodes, rays, hits.tMax, mask, [&](uint32_t first, uint32_t count, Mask leafMask) {
+            for (uint32_t i = first; i < first + count; i++) {
+                intersectTriangle(instance, instanceIndex, i, rays, leafMask, hits);
+            }
+        });
+    }
+
+    // MeshObject's intersectTriangles with one triangle against every lane
+    static void intersectTriangle(const PacketInstance& instance, uint32_t instanceIndex, uint32_t triangleIndex,
+        const Rays& rays, Mask mask, Hits& hits) {
+        // Planes of the TriangleStore, see TriangleStore::Plane for the order
+        const float* triangle = instance.triangles + triangleIndex;
+        const uint32_t stride = instance.triangleCount;
+        const float aX = triangle[0 * stride], aY = triangle[1 * stride], aZ = triangle[2 * stride];
+        const float abX = triangle[3 * stride], abY = triangle[4 * stride], abZ = triangle[5 * stride];
+        const float acX = triangle[6 * stride], acY = triangle[7 * stride], acZ = triangle[8 * stride];
+        const Float edgeABX = Simd::set1(abX), edgeABY = Simd::set1(abY), edgeABZ = Simd::set1(abZ);
+        const Float edgeACX = Simd::set1(acX), edgeACY = Simd::set1(acY), edgeACZ = Simd::set1(acZ);
+        const Float normalX = Simd::set1(abY * acZ - abZ * acY);
+        const Float normalY = Simd::set1(abZ * acX - abX * acZ);
+        const Float normalZ = Simd::set1(abX * acY - abY * acX);
+
+        Float aoX = Simd::sub(rays.originX, Simd::set1(aX));
+        Float aoY = Simd::sub(rays.originY, Simd::set1(aY));
+        Float aoZ = Simd::sub(rays.originZ, Simd::set1(aZ));
+
+        // dao = cross(ao, direction)
+        Float daoX = Simd::sub(Simd::mul(aoY, rays.directionZ), Simd::mul(aoZ, rays.directionY));
+        Float daoY = Simd::sub(Simd::mul(aoZ, rays.directionX), Simd::mul(aoX, rays.directionZ));
+        Float daoZ = Simd::sub(Simd::mul(aoX, rays.directionY), Simd::mul(aoY, rays.directionX));
+
+        const Float zero = Simd::set1(0.0f);
+        Float determinant = Simd::sub(zero, dot(rays.directionX, rays.directionY, rays.directionZ, normalX, normalY, normalZ));
+        Float invDeterminant = Simd::div(Simd::set1(1.0f), determinant);
+
+        Float dst = Simd::mul(dot(aoX, aoY, aoZ, normalX, normalY, normalZ), invDeterminant);
+        Float u = Simd::mul(dot(edgeACX, edgeACY, edgeACZ, daoX, daoY, daoZ), invDeterminant);
+        Float v = Simd::sub(zero, Simd::mul(dot(edgeABX, edgeABY, edgeABZ, daoX, daoY, daoZ), invDeterminant));
+        Float w = Simd::sub(Simd::sub(Simd::set1(1.0f), u), v);
+
+        Mask hit = Simd::andMask(mask, Simd::ge(determinant, Simd::set1(1e-6f)));
+        hit = Simd::andMask(hit, Simd::ge(dst, zero));
+        hit = Simd::andMask(hit, Simd::ge(u, zero));
+        hit = Simd::andMask(hit, Simd::ge(v, zero));
+        hit = Simd::andMask(hit, Simd::ge(w, zero));
+        hit = Simd::andMask(hit, Simd::lt(dst, hits.tMax));
+        if (Simd::bits(hit) != 0) {
+            recordHits(hits, hit, dst, instanceIndex, triangleIndex, u, v);
+        }
+    }
+};
+
+#endif //PACKETTRAVERSAL_H
@@ -0,0 +1,57 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+// Compiled with -mavx2 -mfma (/arch:AVX2), only called once detectSimdLevel()
+// reported AVX2. See PacketTraversal.h for what this file may include.
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+
+#include "PacketTraversal.h"
+
+namespace {
+
+struct SimdAVX2 {
+    using Float = __m256;
+    using Mask = __m256;
+
+    static Float set1(float value) { return _mm256_set1_ps(value); }
+    static Float fromInt(int32_t value) { return _mm256_castsi256_ps(_mm256_set1_epi32(value)); }
+    static Float load(const float* source) { return _mm256_load_ps(source); }
+    static void store(float* destination, Float value) { _mm256_store_ps(destination, value); }
+    static void storeBits(void* destination, Float value) {
+        _mm256_store_si256(static_cast<__m256i*>(destination), _mm256_castps_si256(value));
+    }
+
+    static Float add(Float a, Float b) { return _mm256_add_ps(a, b); }
+    static Float sub(Float a, Float b) { return _mm256_sub_ps(a, b); }
+    static Float mul(Float a, Float b) { return _mm256_mul_ps(a, b); }
+    static Float div(Float a, Float b) { return _mm256_div_ps(a, b); }
+    static Float fmadd(Float a, Float b, Float c) { return _mm256_fmadd_ps(a, b, c); }
+    static Float min(Float a, Float b) { return _mm256_min_ps(a, b); }
+    static Float max(Float a, Float b) { return _mm256_max_ps(a, b); }
+    static Float sqrt(Float a) { return _mm256_sqrt_ps(a); }
+
+    static Mask lt(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static Mask le(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+    static Mask gt(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    static Mask ge(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+    static Mask andMask(Mask a, Mask b) { return _mm256_and_ps(a, b); }
+    static uint32_t bits(Mask mask) { return static_cast<uint32_t>(_mm256_movemask_ps(mask)); }
+    static Mask fromBits(uint32_t laneBits) {
+        const __m256i laneBit = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+        __m256i selected = _mm256_and_si256(_mm256_set1_epi32(static_cast<int32_t>(laneBits)), laneBit);
+        return _mm256_castsi256_ps(_mm256_cmpeq_epi32(selected, laneBit));
+    }
+    // mask ? a : b
+    static Float select(Mask mask, Float a, Float b) { return _mm256_blendv_ps(b, a, mask); }
+};
+
+}
+
+void intersectPacketAVX2(const PacketScene& scene, RayPacket& packet) {
+    PacketTraversal<SimdAVX2>::intersect(scene, packet);
+}
+
+#endif
@@ -0,0 +1,53 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+// Compiled with -mavx512f (/arch:AVX512), only called once detectSimdLevel()
+// reported AVX-512. See PacketTraversal.h for what this file may include.
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+
+#include "PacketTraversal.h"
+
+namespace {
+
+struct SimdAVX512 {
+    using Float = __m512;
+    using Mask = __mmask16;
+
+    static Float set1(float value) { return _mm512_set1_ps(value); }
+    static Float fromInt(int32_t value) { return _mm512_castsi512_ps(_mm512_set1_epi32(value)); }
+    static Float load(const float* source) { return _mm512_load_ps(source); }
+    static void store(float* destination, Float value) { _mm512_store_ps(destination, value); }
+    static void storeBits(void* destination, Float value) {
+        _mm512_store_si512(destination, _mm512_castps_si512(value));
+    }
+
+    static Float add(Float a, Float b) { return _mm512_add_ps(a, b); }
+    static Float sub(Float a, Float b) { return _mm512_sub_ps(a, b); }
+    static Float mul(Float a, Float b) { return _mm512_mul_ps(a, b); }
+    static Float div(Float a, Float b) { return _mm512_div_ps(a, b); }
+    static Float fmadd(Float a, Float b, Float c) { return _mm512_fmadd_ps(a, b, c); }
+    static Float min(Float a, Float b) { return _mm512_min_ps(a, b); }
+    static Float max(Float a, Float b) { return _mm512_max_ps(a, b); }
+    static Float sqrt(Float a) { return _mm512_sqrt_ps(a); }
+
+    static Mask lt(Float a, Float b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+    static Mask le(Float a, Float b) { return _mm512_cmp_ps_mask(a, b, _CMP_LE_OQ); }
+    static Mask gt(Float a, Float b) { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+    static Mask ge(Float a, Float b) { return _mm512_cmp_ps_mask(a, b, _CMP_GE_OQ); }
+    static Mask andMask(Mask a, Mask b) { return static_cast<Mask>(a & b); }
+    static uint32_t bits(Mask mask) { return mask; }
+    static Mask fromBits(uint32_t laneBits) { return static_cast<Mask>(laneBits); }
+    // mask ? a : b
+    static Float select(Mask mask, Float a, Float b) { return _mm512_mask_blend_ps(mask, b, a); }
+};
+
+}
+
+void intersectPacketAVX512(const PacketScene& scene, RayPacket& packet) {
+    PacketTraversal<SimdAVX512>::intersect(scene, packet);
+}
+
+#endif
@@ -0,0 +1,104 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#include "RayPacket.h"
+
+#include <stdexcept>
+#include <string>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define PACKET_KERNELS_X86 1
+#if defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+// Defined in the per-ISA translation units
+void intersectPacketAVX2(const PacketScene& scene, RayPacket& packet);
+void intersectPacketAVX512(const PacketScene& scene, RayPacket& packet);
+#endif
+
+static SimdLevel querySimdLevel() {
+#if defined(PACKET_KERNELS_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool fma = (info[2] & (1 << 12)) != 0;
+    if (!osxsave) {
+        return SimdLevel::Scalar;
+    }
+    // The OS has to save the AVX (and AVX-512) registers on context switches
+    const unsigned long long xcr0 = _xgetbv(0);
+    __cpuidex(info, 7, 0);
+    const bool avx2 = (info[1] & (1 << 5)) != 0;
+    const bool avx512f = (info[1] & (1 << 16)) != 0;
+    if (avx512f && (xcr0 & 0xE6) == 0xE6) {
+        return SimdLevel::AVX512;
+    }
+    if (avx2 && fma && (xcr0 & 0x6) == 0x6) {
+        return SimdLevel::AVX2;
+    }
+    return SimdLevel::Scalar;
+#elif defined(PACKET_KERNELS_X86)
+    // Also checks that the OS enabled the registers
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return SimdLevel::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return SimdLevel::AVX2;
+    }
+    return SimdLevel::Scalar;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+SimdLevel detectSimdLevel() {
+    static const SimdLevel level = querySimdLevel();
+    return level;
+}
+
+SimdLevel resolveSimdLevel(SimdLevel level) {
+    SimdLevel supported = detectSimdLevel();
+    return static_cast<int>(level) <= static_cast<int>(supported) ? level : supported;
+}
+
+int simdLevelWidth(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX2:
+            return 8;
+        case SimdLevel::AVX512:
+            return 16;
+        default:
+            return 1;
+    }
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX2:
+            return "AVX2";
+        case SimdLevel::AVX512:
+            return "AVX-512";
+        default:
+            return "scalar";
+    }
+}
+
+void intersectPacket(SimdLevel level, const PacketScene& scene, RayPacket& packet) {
+#if defined(PACKET_KERNELS_X86)
+    switch (level) {
+        case SimdLevel::AVX2:
+            intersectPacketAVX2(scene, packet);
+            return;
+        case SimdLevel::AVX512:
+            intersectPacketAVX512(scene, packet);
+            return;
+        default:
+            break;
+    }
+#endif
+    throw std::runtime_error(std::string("No packet kernel for ") + simdLevelName(level));
+}
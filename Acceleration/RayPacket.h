@@ -0,0 +1,74 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#ifndef RAYPACKET_H
+#define RAYPACKET_H
+#include <cstdint>
+
+#include "BVH.h"
+#include "../ObjectClasses/Mesh.h"
+
+// Instruction sets the packet kernels are compiled for, the width is the
+// number of rays traced together
+enum class SimdLevel {
+    Scalar,
+    AVX2,
+    AVX512
+};
+
+static constexpr int MAX_PACKET_WIDTH = 16;
+
+// Up to MAX_PACKET_WIDTH rays in structure of arrays layout, only the first
+// simdLevelWidth() lanes are used. tMax is the maximum distance going in and
+// the closest hit coming out, instance is -1 for lanes that missed.
+struct alignas(64) RayPacket {
+    float originX[MAX_PACKET_WIDTH];
+    float originY[MAX_PACKET_WIDTH];
+    float originZ[MAX_PACKET_WIDTH];
+    float directionX[MAX_PACKET_WIDTH];
+    float directionY[MAX_PACKET_WIDTH];
+    float directionZ[MAX_PACKET_WIDTH];
+    float tMax[MAX_PACKET_WIDTH];
+
+    int32_t instance[MAX_PACKET_WIDTH];
+    uint32_t primitive[MAX_PACKET_WIDTH];
+    // Barycentrics of the hit triangle, same convention as MeshObject::triangleIntersect
+    float u[MAX_PACKET_WIDTH];
+    float v[MAX_PACKET_WIDTH];
+
+    // Bit i set when lane i holds a ray
+    uint32_t activeMask = 0;
+};
+
+// One top level BVH instance flattened for the kernels
+struct PacketInstance {
+    // First three rows of the world to object matrix
+    float inverseTransform[12];
+    // Mesh instances have a BVH and the planes of their TriangleStore,
+    // spheres only a radius
+    const BVHNode* nodes = nullptr;
+    const float* triangles = nullptr;
+    uint32_t triangleCount = 0;
+    float radius = 0.0f;
+    bool isMesh = false;
+};
+
+// Plain pointer view of a Scene, built by the scene before a packet render
+struct PacketScene {
+    const BVHNode* tlasNodes = nullptr;
+    const uint32_t* tlasInstances = nullptr;
+    const PacketInstance* instances = nullptr;
+};
+
+// Best level the CPU and OS support, detected once
+SimdLevel detectSimdLevel();
+// level, lowered to what the CPU supports
+SimdLevel resolveSimdLevel(SimdLevel level);
+int simdLevelWidth(SimdLevel level);
+const char* simdLevelName(SimdLevel level);
+
+// Closest hit of every active lane. level must be supported and not Scalar.
+void intersectPacket(SimdLevel level, const PacketScene& scene, RayPacket& packet);
+
+#endif //RAYPACKET_H
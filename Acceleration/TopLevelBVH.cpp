@@ -0,0 +1,69 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#include "TopLevelBVH.h"
+
+bool TopLevelBVH::update(const std::vector<AABB>& instanceBounds) {
+    if (instanceBounds.size() != getInstanceCount()) {
+        build(instanceBounds);
+        return true;
+    }
+    if (bvh.isEmpty()) {
+        return false;
+    }
+
+    bvh.refit(instanceBounds);
+    if (bvh.getStats().sahCost > builtSAHCost * REBUILD_THRESHOLD) {
+        build(instanceBounds);
+        return true;
+    }
+    return false;
+}
+
+bool TopLevelBVH::update(const std::vector<AABB>& instanceBounds, std::span<const uint32_t> movedInstances,
+    std::vector<uint32_t>& refittedNodes) {
+    refittedNodes.clear();
+    if (instanceBounds.size() != getInstanceCount()) {
+        build(instanceBounds);
+        return true;
+    }
+    if (bvh.isEmpty()) {
+        return false;
+    }
+
+    std::vector<uint32_t> leaves;
+    leaves.reserve(movedInstances.size());
+    for (uint32_t instance : movedInstances) {
+        leaves.push_back(instanceLeaves[instance]);
+    }
+    refittedNodes = bvh.refitLeaves(instanceBounds, leaves, parents);
+    if (bvh.getStats().sahCost > builtSAHCost * REBUILD_THRESHOLD) {
+        refittedNodes.clear();
+        build(instanceBounds);
+        return true;
+    }
+    return false;
+}
+
+void TopLevelBVH::build(const std::vector<AABB>& instanceBounds) {
+    bvh.build(instanceBounds);
+    builtSAHCost = bvh.getStats().sahCost;
+
+    std::span<const BVHNode> nodes = bvh.getNodes();
+    std::span<const uint32_t> order = bvh.getPrimitiveIndices();
+    parents.assign(nodes.size(), 0);
+    instanceLeaves.assign(instanceBounds.size(), 0);
+    for (uint32_t i = 0; i < nodes.size(); i++) {
+        const BVHNode& node = nodes[i];
+        if (node.isLeaf()) {
+            for (uint32_t j = 0; j < node.primitiveCount; j++) {
+                instanceLeaves[order[node.leftFirst + j]] = i;
+            }
+        }
+        else {
+            parents[node.leftFirst] = i;
+            parents[node.leftFirst + 1] = i;
+        }
+    }
+}
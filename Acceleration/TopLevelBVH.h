@@ -0,0 +1,48 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#ifndef TOPLEVELBVH_H
+#define TOPLEVELBVH_H
+#include <span>
+#include <vector>
+
+#include "BVH.h"
+
+// BVH over the world space bounds of whole objects. Its primitive indices are
+// instance indices, the owner decides what an instance is.
+class TopLevelBVH {
+public:
+    // Refitting stops being worth it once the SAH cost has grown this much
+    // compared to the last full build
+    static constexpr float REBUILD_THRESHOLD = 1.5f;
+
+    // Refits when the instance count is unchanged, rebuilds otherwise or when
+    // the refitted tree got too much worse. Returns true after a rebuild, i.e.
+    // when the instance order changed.
+    bool update(const std::vector<AABB>& instanceBounds);
+    // Same when only movedInstances changed their bounds: refits just their
+    // leaves and ancestors, whose indices go to refittedNodes. After a
+    // rebuild every node is new and refittedNodes is left empty.
+    bool update(const std::vector<AABB>& instanceBounds, std::span<const uint32_t> movedInstances,
+        std::vector<uint32_t>& refittedNodes);
+    void build(const std::vector<AABB>& instanceBounds);
+
+    [[nodiscard]] const BVH& getBVH() const {
+        return bvh;
+    }
+    [[nodiscard]] size_t getInstanceCount() const {
+        return bvh.getPrimitiveIndices().size();
+    }
+
+private:
+    BVH bvh;
+    float builtSAHCost = 0.0f;
+    // Topology lookups for partial refits, valid until the next build
+    std::vector<uint32_t> parents;
+    std::vector<uint32_t> instanceLeaves;
+};
+
+
+
+#endif //TOPLEVELBVH_H
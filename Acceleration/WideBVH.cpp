@@ -0,0 +1,130 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#include "WideBVH.h"
+
+#include <chrono>
+
+const char* bvhLayoutName(BVHLayout layout) {
+    switch (layout) {
+        case BVHLayout::Wide4:
+            return "BVH4";
+        case BVHLayout::Wide8:
+            return "BVH8";
+        default:
+            return "BVH2";
+    }
+}
+
+void WideBVHStats::print(std::ostream& out, const std::string& name) const {
+    out << "Wide BVH [" << name << "]: "
+        << nodeCount << " nodes (" << leafCount << " leaves), "
+        << "max depth " << maxDepth << ", "
+        << occupancy << " children per node, "
+        << memoryBytes / 1024 << " KiB, "
+        << "collapsed in " << buildTimeMs << " ms" << std::endl;
+}
+
+template<int Width>
+void WideBVH<Width>::build(const BVH& binary) {
+    auto start = std::chrono::steady_clock::now();
+
+    nodes.clear();
+    stats = WideBVHStats();
+    std::span<const BVHNode> binaryNodes = binary.getNodes();
+    if (binaryNodes.empty()) {
+        return;
+    }
+
+    struct PendingNode {
+        uint32_t wideIndex;
+        uint32_t binaryIndex;
+        int depth;
+    };
+    std::vector<PendingNode> pending;
+    pending.push_back({0, 0, 1});
+    nodes.emplace_back();
+
+    size_t usedSlots = 0;
+    while (!pending.empty()) {
+        const PendingNode current = pending.back();
+        pending.pop_back();
+        stats.maxDepth = std::max(stats.maxDepth, current.depth);
+
+        // Start from the two binary children and keep replacing the interior
+        // child with the largest surface area by its own children
+        uint32_t candidates[Width];
+        int candidateCount = 0;
+        const BVHNode& binaryNode = binaryNodes[current.binaryIndex];
+        if (binaryNode.isLeaf()) {
+            // Only happens for a root that is a leaf
+            candidates[candidateCount++] = current.binaryIndex;
+        }
+        else {
+            candidates[candidateCount++] = binaryNode.leftFirst;
+            candidates[candidateCount++] = binaryNode.leftFirst + 1;
+            while (candidateCount < Width) {
+                int largest = -1;
+                float largestArea = -1.0f;
+                for (int i = 0; i < candidateCount; i++) {
+                    const BVHNode& candidate = binaryNodes[candidates[i]];
+                    if (candidate.isLeaf()) {
+                        continue;
+                    }
+                    float area = AABB{candidate.boundsMin, candidate.boundsMax}.surfaceArea();
+                    if (area > largestArea) {
+                        largestArea = area;
+                        largest = i;
+                    }
+                }
+                if (largest < 0) {
+                    break;
+                }
+                const uint32_t opened = candidates[largest];
+                candidates[largest] = binaryNodes[opened].leftFirst;
+                candidates[candidateCount++] = binaryNodes[opened].leftFirst + 1;
+            }
+        }
+
+        Node node;
+        for (int i = 0; i < Width; i++) {
+            // Degenerate box far away, the traversal also skips EMPTY_CHILD
+            node.boundsMinX[i] = node.boundsMinY[i] = node.boundsMinZ[i] = FLT_MAX;
+            node.boundsMaxX[i] = node.boundsMaxY[i] = node.boundsMaxZ[i] = FLT_MAX;
+            node.children[i] = Node::EMPTY_CHILD;
+            node.primitiveCount[i] = 0;
+        }
+        for (int i = 0; i < candidateCount; i++) {
+            const BVHNode& child = binaryNodes[candidates[i]];
+            node.boundsMinX[i] = child.boundsMin.x;
+            node.boundsMinY[i] = child.boundsMin.y;
+            node.boundsMinZ[i] = child.boundsMin.z;
+            node.boundsMaxX[i] = child.boundsMax.x;
+            node.boundsMaxY[i] = child.boundsMax.y;
+            node.boundsMaxZ[i] = child.boundsMax.z;
+            if (child.isLeaf()) {
+                node.children[i] = child.leftFirst;
+                node.primitiveCount[i] = child.primitiveCount;
+                stats.leafCount++;
+            }
+            else {
+                const uint32_t childIndex = static_cast<uint32_t>(nodes.size());
+                nodes.emplace_back();
+                node.children[i] = childIndex;
+                pending.push_back({childIndex, candidates[i], current.depth + 1});
+            }
+        }
+        nodes[current.wideIndex] = node;
+        usedSlots += candidateCount;
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    stats.nodeCount = nodes.size();
+    stats.occupancy = (float)usedSlots / (float)nodes.size();
+    stats.memoryBytes = nodes.size() * sizeof(Node);
+    stats.buildTimeMs = std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+template class WideBVH<4>;
+template class WideBVH<8>;
@@ -0,0 +1,253 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#ifndef WIDEBVH_H
+#define WIDEBVH_H
+#include <bit>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#define WIDE_BVH_SSE 1
+#endif
+
+#include "BVH.h"
+
+// Acceleration layouts a Mesh can be traversed with on the CPU. The binary
+// BVH is always built (the GPU uses it), the wide ones are collapsed from it.
+enum class BVHLayout {
+    Binary,
+    Wide4,
+    Wide8
+};
+
+const char* bvhLayoutName(BVHLayout layout);
+
+// Width children per node, bounds stored per axis so that all of them are
+// tested against a ray at once. 32 * Width bytes: two cache lines for BVH4,
+// four for BVH8. A child with primitiveCount == 0 is an interior node,
+// otherwise a leaf over [children[i], children[i] + primitiveCount[i]) like
+// BVHNode. Unused slots hold EMPTY_CHILD.
+template<int Width>
+struct alignas(64) WideBVHNode {
+    static constexpr uint32_t EMPTY_CHILD = UINT32_MAX;
+
+    float boundsMinX[Width];
+    float boundsMinY[Width];
+    float boundsMinZ[Width];
+    float boundsMaxX[Width];
+    float boundsMaxY[Width];
+    float boundsMaxZ[Width];
+    uint32_t children[Width];
+    uint32_t primitiveCount[Width];
+};
+
+static_assert(sizeof(WideBVHNode<4>) == 128);
+static_assert(sizeof(WideBVHNode<8>) == 256);
+
+struct WideBVHStats {
+    size_t nodeCount = 0;
+    size_t leafCount = 0;
+    int maxDepth = 0;
+    // Average number of used child slots per node
+    float occupancy = 0.0f;
+    size_t memoryBytes = 0;
+    double buildTimeMs = 0.0;
+
+    void print(std::ostream& out, const std::string& name) const;
+};
+
+// BVH4 / BVH8 collapsed from a binary BVH. Each node pulls up the largest
+// interior descendants of its binary node until its slots are full. Leaves are
+// kept as they are, so the primitive order of the binary BVH stays valid.
+template<int Width>
+class WideBVH {
+public:
+    using Node = WideBVHNode<Width>;
+
+    // Enough for every sibling on the way down a tree as deep as the binary one
+    static constexpr int STACK_SIZE = (Width - 1) * BVH::MAX_DEPTH + 1;
+
+    void build(const BVH& binary);
+
+    [[nodiscard]] bool isEmpty() const {
+        return nodes.empty();
+    }
+    [[nodiscard]] const std::vector<Node>& getNodes() const {
+        return nodes;
+    }
+    [[nodiscard]] const WideBVHStats& getStats() const {
+        return stats;
+    }
+
+    // Returns a bit per child whose box the ray enters before tMax, with the
+    // entry distances in tNear. Empty slots may report hits, callers skip them.
+    static uint32_t intersectChildren(const Node& node, const glm::vec3& origin, const glm::vec3& invDir,
+        float tMax, float* tNear);
+
+    // Same contract as BVH::traverse. The hit children of a node are pushed
+    // far to near so the closest one is visited first.
+    template<typename LeafFunction>
+    void traverse(const glm::vec3& origin, const glm::vec3& direction, float& tMax, LeafFunction&& intersectLeaf) const {
+        if (nodes.empty()) {
+            return;
+        }
+        const glm::vec3 invDir = 1.0f / direction;
+
+        struct StackEntry {
+            uint32_t child;
+            uint32_t primitiveCount;
+            float distance;
+        };
+        StackEntry stack[STACK_SIZE];
+        int stackSize = 0;
+        uint32_t current = 0;
+
+        while (true) {
+            const Node& node = nodes[current];
+            alignas(32) float tNear[Width];
+            uint32_t hitMask = intersectChildren(node, origin, invDir, tMax, tNear);
+
+            const int firstPushed = stackSize;
+            while (hitMask != 0) {
+                const int i = std::countr_zero(hitMask);
+                hitMask &= hitMask - 1;
+                if (node.children[i] == Node::EMPTY_CHILD) {
+                    continue;
+                }
+                StackEntry entry = {node.children[i], node.primitiveCount[i], tNear[i]};
+                int slot = stackSize++;
+                while (slot > firstPushed && stack[slot - 1].distance < entry.distance) {
+                    stack[slot] = stack[slot - 1];
+                    slot--;
+                }
+                stack[slot] = entry;
+            }
+
+            // Leaves are intersected as they come off the stack, in distance
+            // order, until the next interior node that can still beat tMax
+            bool found = false;
+            while (stackSize > 0) {
+                const StackEntry entry = stack[--stackSize];
+                if (entry.distance >= tMax) {
+                    continue;
+                }
+                if (entry.primitiveCount > 0) {
+                    intersectLeaf(entry.child, entry.primitiveCount);
+                    continue;
+                }
+                current = entry.child;
+                found = true;
+                break;
+            }
+            if (!found) {
+                return;
+            }
+        }
+    }
+
+private:
+    std::vector<Node> nodes;
+    WideBVHStats stats;
+};
+
+#if defined(WIDE_BVH_SSE)
+// Slab test of 4 children starting at first, same math as BVH::intersectAABB
+inline uint32_t intersectChildrenSSE(const float* minX, const float* minY, const float* minZ,
+    const float* maxX, const float* maxY, const float* maxZ,
+    const glm::vec3& origin, const glm::vec3& invDir, float tMax, float* tNear) {
+    const __m128 originX = _mm_set1_ps(origin.x);
+    const __m128 originY = _mm_set1_ps(origin.y);
+    const __m128 originZ = _mm_set1_ps(origin.z);
+    const __m128 invDirX = _mm_set1_ps(invDir.x);
+    const __m128 invDirY = _mm_set1_ps(invDir.y);
+    const __m128 invDirZ = _mm_set1_ps(invDir.z);
+
+    __m128 t0x = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(minX), originX), invDirX);
+    __m128 t0y = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(minY), originY), invDirY);
+    __m128 t0z = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(minZ), originZ), invDirZ);
+    __m128 t1x = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(maxX), originX), invDirX);
+    __m128 t1y = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(maxY), originY), invDirY);
+    __m128 t1z = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(maxZ), originZ), invDirZ);
+
+    __m128 nearDist = _mm_max_ps(
+        _mm_max_ps(_mm_min_ps(t0x, t1x), _mm_min_ps(t0y, t1y)),
+        _mm_max_ps(_mm_min_ps(t0z, t1z), _mm_setzero_ps()));
+    __m128 farDist = _mm_min_ps(
+        _mm_min_ps(_mm_max_ps(t0x, t1x), _mm_max_ps(t0y, t1y)),
+        _mm_min_ps(_mm_max_ps(t0z, t1z), _mm_set1_ps(tMax)));
+
+    _mm_store_ps(tNear, nearDist);
+    return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(nearDist, farDist)));
+}
+#endif
+
+#if defined(__AVX__)
+// All 8 children at once when the build targets AVX (e.g. -march=native)
+inline uint32_t intersectChildrenAVX(const WideBVHNode<8>& node, const glm::vec3& origin, const glm::vec3& invDir,
+    float tMax, float* tNear) {
+    const __m256 originX = _mm256_set1_ps(origin.x);
+    const __m256 originY = _mm256_set1_ps(origin.y);
+    const __m256 originZ = _mm256_set1_ps(origin.z);
+    const __m256 invDirX = _mm256_set1_ps(invDir.x);
+    const __m256 invDirY = _mm256_set1_ps(invDir.y);
+    const __m256 invDirZ = _mm256_set1_ps(invDir.z);
+
+    __m256 t0x = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.boundsMinX), originX), invDirX);
+    __m256 t0y = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.boundsMinY), originY), invDirY);
+    __m256 t0z = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.boundsMinZ), originZ), invDirZ);
+    __m256 t1x = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.boundsMaxX), originX), invDirX);
+    __m256 t1y = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.boundsMaxY), originY), invDirY);
+    __m256 t1z = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.boundsMaxZ), originZ), invDirZ);
+
+    __m256 nearDist = _mm256_max_ps(
+        _mm256_max_ps(_mm256_min_ps(t0x, t1x), _mm256_min_ps(t0y, t1y)),
+        _mm256_max_ps(_mm256_min_ps(t0z, t1z), _mm256_setzero_ps()));
+    __m256 farDist = _mm256_min_ps(
+        _mm256_min_ps(_mm256_max_ps(t0x, t1x), _mm256_max_ps(t0y, t1y)),
+        _mm256_min_ps(_mm256_max_ps(t0z, t1z), _mm256_set1_ps(tMax)));
+
+    _mm256_store_ps(tNear, nearDist);
+    return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(nearDist, farDist, _CMP_LE_OQ)));
+}
+#endif
+
+template<int Width>
+inline uint32_t WideBVH<Width>::intersectChildren(const Node& node, const glm::vec3& origin, const glm::vec3& invDir,
+    float tMax, float* tNear) {
+#if defined(__AVX__)
+    if constexpr (Width == 8) {
+        return intersectChildrenAVX(node, origin, invDir, tMax, tNear);
+    }
+#endif
+#if defined(WIDE_BVH_SSE)
+    // SSE2 is part of x86-64, BVH8 takes two passes without AVX
+    uint32_t hitMask = 0;
+    for (int first = 0; first < Width; first += 4) {
+        hitMask |= intersectChildrenSSE(node.boundsMinX + first, node.boundsMinY + first, node.boundsMinZ + first,
+            node.boundsMaxX + first, node.boundsMaxY + first, node.boundsMaxZ + first,
+            origin, invDir, tMax, tNear + first) << first;
+    }
+    return hitMask;
+#else
+    uint32_t hitMask = 0;
+    for (int i = 0; i < Width; i++) {
+        tNear[i] = BVH::intersectAABB(origin, invDir,
+            glm::vec3(node.boundsMinX[i], node.boundsMinY[i], node.boundsMinZ[i]),
+            glm::vec3(node.boundsMaxX[i], node.boundsMaxY[i], node.boundsMaxZ[i]), tMax);
+        if (tNear[i] != FLT_MAX) {
+            hitMask |= 1u << i;
+        }
+    }
+    return hitMask;
+#endif
+}
+
+extern template class WideBVH<4>;
+extern template class WideBVH<8>;
+
+#endif //WIDEBVH_H
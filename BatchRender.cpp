@@ -0,0 +1,249 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+// pt_render: renders a scene on the CPU and writes the image, without a
+// window or an OpenGL context, so it runs on render nodes and in scripts.
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "Camera.h"
+#include "Scene.h"
+#include "Utilities/ImageWriter.h"
+#include "Utilities/MeshBuilder.h"
+#include "Utilities/MeshCache.h"
+#include "Utilities/SceneLoader.h"
+
+struct BatchOptions {
+    std::string scene = "default";
+    std::string output = "render.png";
+    // Sample count AOV, only written when set
+    std::string sampleCountOutput;
+    int width = 1920;
+    int height = 1080;
+    int samplesPerPixel = 5;
+    int maxBounces = 10;
+    RenderSettings render;
+    bool quiet = false;
+    bool meshCache = true;
+    bool quantizePositions = false;
+};
+
+static void printUsage(const char* program) {
+    printf("Usage: %s [options]\n"
+        "  --scene <path>          JSON scene file, \"default\" for the built in scene (default)\n"
+        "  --output <path>         .png or .ppm image (render.png)\n"
+        "  --width <n>             image width (1920)\n"
+        "  --height <n>            image height (1080)\n"
+        "  --spp <n>               samples per pixel, the minimum with --adaptive-max (5)\n"
+        "  --bounces <n>           maximum path length (10)\n"
+        "  --threads <n>           worker threads, 0 for every hardware thread (0)\n"
+        "  --tile <n>              tile size in pixels (32)\n"
+        "  --sampler <name>        sobol or independent (sobol)\n"
+        "  --seed <n>              sampler seed (0)\n"
+        "  --simd <name>           primary ray packets: scalar, avx2 or avx512 (scalar)\n"
+        "  --adaptive-max <n>      adaptive sampling up to n samples per pixel (off)\n"
+        "  --adaptive-error <e>    adaptive sampling error target (0.01)\n"
+        "  --sample-counts <path>  also write the samples per pixel as an image\n"
+        "  --no-mesh-cache         always parse meshes, don't read or write .ptmesh files\n"
+        "  --quantize-positions    16 bit mesh vertex positions within the mesh bounds\n"
+        "  --quiet                 no progress output\n",
+        program);
+}
+
+// Throws std::runtime_error with a message for the user on bad arguments
+static BatchOptions parseArguments(int argc, char** argv) {
+    BatchOptions options;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string argument = argv[i];
+        if (argument == "--quiet") {
+            options.quiet = true;
+            continue;
+        }
+        if (argument == "--no-mesh-cache") {
+            options.meshCache = false;
+            continue;
+        }
+        if (argument == "--quantize-positions") {
+            options.quantizePositions = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            throw std::runtime_error("Missing value for " + argument);
+        }
+        const std::string value = argv[++i];
+
+        auto toInt = [&](int minimum) {
+            size_t used = 0;
+            int result = 0;
+            try {
+                result = std::stoi(value, &used);
+            }
+            catch (const std::exception&) {
+                used = 0;
+            }
+            if (used != value.size() || result < minimum) {
+                throw std::runtime_error("Invalid value for " + argument + ": " + value);
+            }
+            return result;
+        };
+
+        if (argument == "--scene") {
+            options.scene = value;
+        }
+        else if (argument == "--output") {
+            options.output = value;
+        }
+        else if (argument == "--sample-counts") {
+            options.sampleCountOutput = value;
+        }
+        else if (argument == "--width") {
+            options.width = toInt(1);
+        }
+        else if (argument == "--height") {
+            options.height = toInt(1);
+        }
+        else if (argument == "--spp") {
+            options.samplesPerPixel = toInt(1);
+        }
+        else if (argument == "--bounces") {
+            options.maxBounces = toInt(1);
+        }
+        else if (argument == "--threads") {
+            options.render.threadCount = toInt(0);
+        }
+        else if (argument == "--tile") {
+            options.render.tileSize = toInt(1);
+        }
+        else if (argument == "--seed") {
+            options.render.seed = toInt(0);
+        }
+        else if (argument == "--adaptive-max") {
+            options.render.adaptiveMaxSamples = toInt(0);
+        }
+        else if (argument == "--adaptive-error") {
+            try {
+                options.render.adaptiveError = std::stof(value);
+            }
+            catch (const std::exception&) {
+                throw std::runtime_error("Invalid value for " + argument + ": " + value);
+            }
+        }
+        else if (argument == "--sampler") {
+            if (value == "sobol") {
+                options.render.sampler = SamplerType::Sobol;
+            }
+            else if (value == "independent") {
+                options.render.sampler = SamplerType::Independent;
+            }
+            else {
+                throw std::runtime_error("Unknown sampler: " + value);
+            }
+        }
+        else if (argument == "--simd") {
+            if (value == "scalar") {
+                options.render.packetSimd = SimdLevel::Scalar;
+            }
+            else if (value == "avx2") {
+                options.render.packetSimd = SimdLevel::AVX2;
+            }
+            else if (value == "avx512") {
+                options.render.packetSimd = SimdLevel::AVX512;
+            }
+            else {
+                throw std::runtime_error("Unknown SIMD level: " + value);
+            }
+        }
+        else {
+            throw std::runtime_error("Unknown option: " + argument);
+        }
+    }
+
+    options.render.width = options.width;
+    options.render.height = options.height;
+    options.render.samplesPerPixel = options.samplesPerPixel;
+    options.render.maxBounces = options.maxBounces;
+    return options;
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        }
+    }
+
+    BatchOptions options;
+    try {
+        options = parseArguments(argc, argv);
+    }
+    catch (const std::runtime_error& error) {
+        printf("%s\n\n", error.what());
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    MeshCache::setEnabled(options.meshCache);
+    MeshBuilder::setVertexFormat(options.quantizePositions ? VertexFormat::Quantized : VertexFormat::Float);
+
+    using clock = std::chrono::steady_clock;
+    auto loadStart = clock::now();
+
+    // The built in scene uses the same view as the interactive app
+    float aspectRatio = (float)options.width / (float)options.height;
+    Camera camera(60.f, glm::vec3(-8, -0, -1), glm::vec3(-0.78f, -1.f, -0.01f), glm::vec3(0.0f, 1.0f, 0.0f), aspectRatio);
+    Scene scene(options.samplesPerPixel, options.maxBounces, &camera);
+    try {
+        if (options.scene == "default") {
+            scene.buildDefaultScene();
+        }
+        else {
+            SceneFile file = SceneLoader::load(options.scene, scene, options.render.threadCount);
+            camera = file.camera.createCamera(aspectRatio);
+            if (!options.quiet) {
+                file.report.print(std::cout);
+            }
+        }
+    }
+    catch (const std::runtime_error& error) {
+        printf("%s\n", error.what());
+        return 1;
+    }
+
+    auto loadEnd = clock::now();
+
+    if (!options.quiet) {
+        options.render.onProgress = [](int tilesDone, int tileCount) {
+            fprintf(stderr, "\rTiles: %d/%d", tilesDone, tileCount);
+            if (tilesDone == tileCount) {
+                fprintf(stderr, "\n");
+            }
+        };
+    }
+    std::vector<glm::vec3> image = scene.render(options.render);
+    const RenderStats& stats = scene.getLastRenderStats();
+
+    if (!writeImage(options.output, options.width, options.height, image)) {
+        return 1;
+    }
+    if (!options.sampleCountOutput.empty()
+        && !writeImage(options.sampleCountOutput, options.width, options.height, scene.getSampleCountImage())) {
+        return 1;
+    }
+
+    const double pixelCount = (double)options.width * options.height;
+    printf("Rendered %s at %dx%d to %s\n", options.scene.c_str(), options.width, options.height, options.output.c_str());
+    printf("  load:    %.3f s\n", std::chrono::duration<double>(loadEnd - loadStart).count());
+    printf("  render:  %.3f s on %u threads (%s packets, %s sampler)\n",
+        stats.seconds, stats.threadCount, simdLevelName(stats.simdLevel), samplerTypeName(options.render.sampler));
+    printf("  samples: %llu (%.1f per pixel)\n", (unsigned long long)stats.samples, (double)stats.samples / pixelCount);
+    printf("  rays:    %llu (%.3f Mrays/s)\n", (unsigned long long)stats.rays, stats.raysPerSecond() / 1e6);
+    return 0;
+}
@@ -4,74 +4,128 @@
 
 #include "ComputeShader.h"
 
+#include "ProgramCache.h"
+
+ComputeShader::ComputeShader(const char* filename, const ShaderDefines& defines) : name(filename) {
+    // Includes are pasted in and the defines written out, so editing either
+    // changes the key
+    ShaderSource source = ShaderSource::load(filename, defines);
+    std::string& code = source.code;
+    sourceFiles = source.fileList();
+    cacheKey = ProgramCache::key({code}, "");
+    program = ProgramCache::load(cacheKey);
+    if (program != 0) {
+        uniforms.reflect(program);
+        return;
+    }
+
+    pendingShader = compileShader(code);
+    program = glCreateProgram();
+    ProgramCache::prepare(program);
+    glAttachShader(program, pendingShader);
+    glLinkProgram(program);
+}
+
 void ComputeShader::use() {
+    finishLinking();
     glUseProgram(program);
 }
 
+void ComputeShader::finishLinking() {
+    if (pendingShader == 0) {
+        return;
+    }
+    GLuint shader = pendingShader;
+    pendingShader = 0;
+
+    // Blocks until the background compile is done
+    int success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        int length;
+        if (success) {
+            glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+        }
+        else {
+            glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+        }
+        std::vector<char> infoLog(length + 1);
+        if (success) {
+            glGetProgramInfoLog(program, length, NULL, infoLog.data());
+        }
+        else {
+            glGetShaderInfoLog(shader, length, NULL, infoLog.data());
+        }
+        printf("%s\n", infoLog.data());
+        printf("Source strings:\n%s", sourceFiles.c_str());
+        glDeleteShader(shader);
+        glDeleteProgram(program);
+        program = 0;
+        throw std::runtime_error("Error: Couldn't compile compute shader: " + name);
+    }
+
+    glDetachShader(program, shader);
+    glDeleteShader(shader);
+    uniforms.reflect(program);
+    printf("Compiled %s%s\n", name.c_str(), ProgramCache::store(cacheKey, program) ? ", binary cached" : "");
+}
+
+bool ComputeShader::isReady() {
+    if (pendingShader == 0 || !ProgramCache::parallelCompileSupported()) {
+        return true;
+    }
+    GLint done = GL_FALSE;
+    glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &done);
+    return done == GL_TRUE;
+}
+
 void ComputeShader::dispatch(int x, int y, int z, GLbitfield bitfield) {
     glDispatchCompute(x, y, z);
     glMemoryBarrier(bitfield);
 }
 
-void ComputeShader::deleteProgram() {
-    glDeleteProgram(program);
+void ComputeShader::dispatchIndirect(GLintptr offset, GLbitfield bitfield) {
+    glDispatchComputeIndirect(offset);
+    glMemoryBarrier(bitfield);
 }
 
-
-std::string ComputeShader::readFile(const char* filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cout << "Failed to open file " << filename << std::endl;
-        return "";
-    }
-    std::stringstream contents;
-    contents << file.rdbuf();
-    return contents.str();
+void ComputeShader::deleteProgram() {
+    glDeleteProgram(program);
 }
 
+// Doesn't wait for the result, finishLinking() reports errors
 GLuint ComputeShader::compileShader(std::string& shaderSource) {
     GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
     const char* source = shaderSource.c_str();
     glShaderSource(shader, 1, &source, NULL);
     glCompileShader(shader);
-
-    int success;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        int length;
-        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
-        char* infoLog = (char*)malloc(length);
-        glGetShaderInfoLog(shader, length, NULL, infoLog);
-        printf("%s\n", infoLog);
-        free(infoLog);
-        glDeleteShader(shader);
-        return 0;
-    }
     return shader;
 }
 
 
-void ComputeShader::setFloat4(std::string name, glm::vec4 value) {
-    int location = glGetUniformLocation(program, name.c_str());
-    glUniform4f(location, value.x, value.y, value.z, value.w);
+void ComputeShader::setFloat4(std::string_view name, glm::vec4 value) {
+    if (UniformTable::Uniform* uniform = uniforms.find(name)) {
+        glUniform4f(uniform->location, value.x, value.y, value.z, value.w);
+    }
 }
 
-void ComputeShader::setInt(std::string name, int value) {
-    int location = glGetUniformLocation(program, name.c_str());
-    glUniform1i(location, value);
+void ComputeShader::setInt(std::string_view name, int value) {
+    uniforms.setInt(name, value);
 }
 
-void ComputeShader::setFloat3(std::string name, glm::vec3 value) {
-    int location = glGetUniformLocation(program, name.c_str());
-    glUniform3f(location, value.x, value.y, value.z);
+void ComputeShader::setFloat3(std::string_view name, glm::vec3 value) {
+    if (UniformTable::Uniform* uniform = uniforms.find(name)) {
+        glUniform3f(uniform->location, value.x, value.y, value.z);
+    }
 }
 
-void ComputeShader::setFloat44(std::string name, glm::mat4 value) {
-    int location = glGetUniformLocation(program, name.c_str());
-    glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
+void ComputeShader::setFloat44(std::string_view name, glm::mat4 value) {
+    if (UniformTable::Uniform* uniform = uniforms.find(name)) {
+        glUniformMatrix4fv(uniform->location, 1, GL_FALSE, glm::value_ptr(value));
+    }
 }
 
-void ComputeShader::setBool(std::string name, bool value) {
-    int location = glGetUniformLocation(program, name.c_str());
-    glUniform1i(location, value);
-}
\ No newline at end of file
+void ComputeShader::setBool(std::string_view name, bool value) {
+    uniforms.setInt(name, value);
+}
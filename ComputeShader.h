@@ -15,37 +15,52 @@
 #include <glm/vec4.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "ShaderSource.h"
+#include "UniformTable.h"
+
 
 class ComputeShader {
 public:
     ComputeShader() {
         program = 0;
     }
-    ComputeShader(const char* filename) {
-        std::string code = readFile(filename);
-        GLuint shader = compileShader(code);
-
-        if (shader == 0) {
-            throw std::runtime_error("Error: Couldn't compile compute shader: " + std::string(filename));
-        }
-
-        program = glCreateProgram();
-        glAttachShader(program, shader);
-        glLinkProgram(program);
-        glDeleteShader(shader);
-    }
+    // Loads the program from the ProgramCache, or starts compiling it. A
+    // compile is only waited for at the first use, where its errors are
+    // thrown, so the driver can build several programs at once. The source
+    // goes through ShaderSource, resolving includes and adding the defines.
+    ComputeShader(const char* filename, const ShaderDefines& defines = {});
     void use();
+    // Whether use() would return without waiting on the compile. Always
+    // true without parallel compile, where there is no asking.
+    [[nodiscard]] bool isReady();
     void dispatch(int x, int y, int z, GLbitfield bitfield);
+    // Group counts from the bound GL_DISPATCH_INDIRECT_BUFFER at offset
+    void dispatchIndirect(GLintptr offset, GLbitfield bitfield);
     void deleteProgram();
-    void setFloat4(std::string name, glm::vec4 value);
-    void setInt(std::string name, int value);
-    void setFloat3(std::string name, glm::vec3 value);
-    void setFloat44(std::string name, glm::mat4 value);
-    void setBool(std::string name, bool value);
+    // Setters apply to the current program, call use() first. Names the
+    // program doesn't use are ignored.
+    void setFloat4(std::string_view name, glm::vec4 value);
+    void setInt(std::string_view name, int value);
+    void setFloat3(std::string_view name, glm::vec3 value);
+    void setFloat44(std::string_view name, glm::mat4 value);
+    void setBool(std::string_view name, bool value);
+
+    // Waits for the program to be linked
+    [[nodiscard]] const UniformTable& getUniforms() {
+        finishLinking();
+        return uniforms;
+    }
 private:
-    std::string readFile(const char* filename);
     GLuint compileShader(std::string& shaderSource);
+    void finishLinking();
     GLuint program;
+    // Still compiling in the background until finishLinking()
+    GLuint pendingShader = 0;
+    uint64_t cacheKey = 0;
+    std::string name;
+    // Printed with compile errors, which name files by source string number
+    std::string sourceFiles;
+    UniformTable uniforms;
 };
 
 
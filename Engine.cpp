@@ -4,12 +4,143 @@
 
 #include "Engine.h"
 
+#include <cassert>
+
 void framebuffer_size_callback(GLFWwindow *window, int width, int height) {
     glViewport(0, 0, width, height);
 }
 
+// Copies in pieces of at most COPY_CHUNK bytes across the pool, so that a
+// single big mesh is spread over every thread as well
+struct CopyJob {
+    void* destination;
+    const void* source;
+    size_t size;
+};
+
+static void parallelCopy(ThreadPool& pool, const std::vector<CopyJob>& jobs) {
+    constexpr size_t COPY_CHUNK = 1 << 20;
+    std::vector<CopyJob> pieces;
+    for (const CopyJob& job : jobs) {
+        for (size_t offset = 0; offset < job.size; offset += COPY_CHUNK) {
+            pieces.push_back({(char*)job.destination + offset, (const char*)job.source + offset,
+                std::min(COPY_CHUNK, job.size - offset)});
+        }
+    }
+    pool.parallelFor(pieces.size(), [&](size_t i, unsigned int) {
+        std::memcpy(pieces[i].destination, pieces[i].source, pieces[i].size);
+    });
+}
+
+static MaterialInfo packMaterial(const Material& material) {
+    MaterialInfo matData;
+    matData.color = glm::vec4(material.getColor(), 0);
+    matData.emissionColor = glm::vec4(material.getEmissionColor(), 0);
+    matData.emissionStrength = material.getEmissionStrength();
+    matData.specular = material.getSpecular();
+    return matData;
+}
+
+// The getters may update the object's cached transform, hence non-const
+static SphereInfo packSphere(SphereObject& sphere) {
+    SphereInfo sphereData;
+    sphereData.transform = sphere.getTransform();
+    sphereData.invTransorm = sphere.getInverseTransform();
+    sphereData.prevTransform = sphere.getPrevTransform();
+    sphereData.prevInverseTransform = sphere.getPrevInverseTransform();
+    sphereData.mat = packMaterial(*sphere.getMaterial());
+    sphereData.objectID = glm::uvec4(sphere.getObjectID(), 0, 0, 1);
+    return sphereData;
+}
+
+static MeshInfo packMesh(MeshObject& meshObject, const MeshRange& range) {
+    const Mesh& mesh = *meshObject.getMesh();
+    MeshInfo meshInfo;
+    meshInfo.transform = meshObject.getTransform();
+    meshInfo.invTransform = meshObject.getInverseTransform();
+    meshInfo.prevTransform = meshObject.getPrevTransform();
+    meshInfo.prevInverseTransform = meshObject.getPrevInverseTransform();
+    meshInfo.boundsMin = glm::vec4(mesh.getMin(), 1.f);
+    meshInfo.boundsMax = glm::vec4(mesh.getMax(), 1.f);
+    // Node indices inside a mesh's BVH are relative to its root, the shader adds info.z
+    meshInfo.info = glm::uvec4(range.firstTriangle, (unsigned int)mesh.getTriangleCount(),
+        range.firstNode, (unsigned int)mesh.getBVH().getNodes().size());
+    // Vertex indices are relative to the mesh's first vertex as well
+    meshInfo.vertexInfo = glm::uvec4(range.firstVertexWord, VertexPacking::stride(mesh.getVertexFormat()), 0, 0);
+    meshInfo.quantizationStep = glm::vec4(mesh.getQuantizationStep(), 0.f);
+    meshInfo.material = packMaterial(*meshObject.getMaterial());
+    meshInfo.objectID = glm::uvec4(meshObject.getObjectID(), 0, 0, 0);
+    return meshInfo;
+}
+
+// Uploads the elements at the dirty indices with one copy per run. Clean
+// elements up to this many bytes between two dirty ones are rewritten too,
+// which costs less than the extra copy.
+constexpr size_t MERGE_GAP_BYTES = 4096;
+
+// Runs are packed straight into the frame ring and copied on the GPU. What
+// doesn't fit this frame goes through glBufferSubData instead.
+template<typename Element, typename Pack>
+static void writeDirty(FrameRing& ring, StorageBuffer& buffer, std::span<const uint32_t> dirty, Pack&& pack) {
+    constexpr uint32_t maxGap = (uint32_t)(MERGE_GAP_BYTES / sizeof(Element));
+    std::vector<Element> staging;
+    for (const ChangeTracker::Range& range : ChangeTracker::coalesce(dirty, maxGap)) {
+        const size_t count = range.last - range.first + 1;
+        const size_t offset = (size_t)range.first * sizeof(Element);
+        Element* elements = ring.copyTo<Element>(buffer.id(), StorageBuffer::HEADER_SIZE + offset, count);
+        const bool ringFull = elements == nullptr;
+        if (ringFull) {
+            staging.resize(count);
+            elements = staging.data();
+        }
+        for (uint32_t i = range.first; i <= range.last; i++) {
+            elements[i - range.first] = pack(i);
+        }
+        if (ringFull) {
+            buffer.write(offset, elements, count * sizeof(Element));
+        }
+    }
+}
+
 void Engine::createComputeShader(std::string shaderName) {
-    raytracer = ComputeShader(shaderName.c_str());
+    raytraceShaderName = std::move(shaderName);
+}
+
+ComputeShader& Engine::getRaytracer(bool denoise, int fixedBounces) {
+    const std::pair key{denoise, fixedBounces};
+    auto found = raytracers.find(key);
+    if (found != raytracers.end()) {
+        return found->second;
+    }
+    ShaderDefines defines = sceneDefines;
+    defines["DENOISER"] = denoise ? "1" : "0";
+    if (fixedBounces > 0) {
+        defines["FIXED_MAX_BOUNCE"] = std::to_string(fixedBounces);
+    }
+    return raytracers.emplace(key, ComputeShader(raytraceShaderName.c_str(), defines)).first->second;
+}
+
+ComputeShader& Engine::selectRaytracer() {
+    // Without parallel compile a new variant would stall the frame, only
+    // the ones started in run() are used then
+    const std::pair key{denoiserActive, mrb};
+    if (mrb <= MAX_SPECIALIZED_BOUNCES && (ProgramCache::parallelCompileSupported() || raytracers.contains(key))) {
+        ComputeShader& specialized = getRaytracer(denoiserActive, mrb);
+        if (specialized.isReady()) {
+            return specialized;
+        }
+    }
+    return getRaytracer(denoiserActive, 0);
+}
+
+void Engine::checkFrameDataBlock() {
+    // A shader block that grew past FrameData would read past what we bind
+    const UniformTable::Block* frameData = getRaytracer(denoiserActive, 0).getUniforms().findBlock("FrameData");
+    if (frameData && (frameData->binding != (GLint)FRAME_DATA_BINDING || frameData->dataSize > (GLint)sizeof(FrameData))) {
+        throw std::runtime_error("FrameData block of the raytrace shader is " + std::to_string(frameData->dataSize)
+            + " bytes at binding " + std::to_string(frameData->binding) + ", expected at most " + std::to_string(sizeof(FrameData))
+            + " bytes at binding " + std::to_string(FRAME_DATA_BINDING));
+    }
 }
 
 void Engine::createShaderProgram(std::string vertexShaderName, std::string fragmentShaderName) {
@@ -41,6 +172,8 @@ void Engine::createGLWFContext(const char *title) {
         glfwTerminate();
         std::exit(EXIT_FAILURE);
     }
+    // Every program created before the first frame then compiles at once
+    ProgramCache::enableParallelCompile();
 
     glViewport(0, 0, width, height);
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
@@ -78,27 +211,33 @@ unsigned int Engine::createRenderTarget() {
 }
 
 void Engine::raytracePass(int frame, int currentFrame, int historyFrame) {
-    raytracer.use();
-
-    raytracer.setInt("frameCnt", frame);
-    raytracer.setInt("RayPerPixel", rpp);
-    raytracer.setInt("MaxRayBounce", mrb);
-    raytracer.setFloat3("ViewCenter", camera->getPos());
-    raytracer.setBool("denoiserActive", denoiserActive);
-
-    // Matrix Uniforms
-    raytracer.setFloat44("InverseProjection", camera->getInverseProjection());
-    raytracer.setFloat44("CameraToWorld", camera->getInverseView());
-    raytracer.setFloat44("CurrentVP", camera->getViewProjection());
-    raytracer.setFloat44("PrevVP", camera->getPreviousViewProjection());
-
     denoiser.bindTexture(currentFrame);
+    if (wavefrontActive && WavefrontTracer::isSupported()) {
+        wavefront.trace(denoiserActive, rpp, mrb, denoiser.getNoisyTexture());
+        return;
+    }
 
+    ComputeShader& raytracer = selectRaytracer();
+    raytracer.use();
     raytracer.dispatch(ceil(width / 16.f), ceil(height / 16.f), 1, GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
 }
 
-void Engine::accumulationPass(int frame, int currentFrame, int historyFrame) {
-    denoiser.accumulationPass(currentFrame, historyFrame, frame);
+void Engine::writeFrameData(int frame) {
+    // First allocation of the frame, the slice always has room for it
+    FrameData* data = frameRing.allocateUniform<FrameData>(frameDataOffset);
+    data->inverseProjection = camera->getInverseProjection();
+    data->cameraToWorld = camera->getInverseView();
+    data->prevViewProjection = camera->getPreviousViewProjection();
+    data->viewProjection = camera->getViewProjection();
+    data->viewCenter = camera->getPos();
+    data->frame = frame;
+    data->raysPerPixel = rpp;
+    data->maxBounces = mrb;
+    data->denoiserActive = denoiserActive ? 1 : 0;
+}
+
+void Engine::accumulationPass(int currentFrame, int historyFrame) {
+    denoiser.accumulationPass(currentFrame, historyFrame);
 }
 
 void Engine::varianceEstimatePass(int currentFrame) {
@@ -129,7 +268,7 @@ void Engine::renderToScreen(int currentFrame, unsigned int quadVAO) {
 
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, textureToDisplay);
-    glUniform1i(glGetUniformLocation(shader.getProgram(), "u_DebugTexture"), 0);
+    shader.setInt("u_DebugTexture", 0);
 
     glBindVertexArray(quadVAO);
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
@@ -142,6 +281,9 @@ void Engine::renderGUI() {
     ImGui::Text("FPS: %.1f", ImGui::GetIO().Framerate);
     ImGui::SliderInt("Ray Per Pixel", &rpp, 1, 1000);
     ImGui::SliderInt("Max Ray Bounce", &mrb, 1, 1000);
+    ImGui::BeginDisabled(!WavefrontTracer::isSupported());
+    ImGui::Checkbox("Wavefront", &wavefrontActive);
+    ImGui::EndDisabled();
     ImGui::End();
 
     // --- 2. Camera Info Window ---
@@ -206,11 +348,23 @@ void Engine::run() {
     int currentFrame = 0;
     int historyFrame = 1;
 
-    initializeSSBO();
-
-    double startTime = glfwGetTime();
+    // The scene decides which instance types the kernels handle, they
+    // compile while it uploads
+    sceneDefines = {
+        {"HAS_SPHERES", scene->getSpheres().empty() ? "0" : "1"},
+        {"HAS_MESHES", scene->getMeshes().empty() ? "0" : "1"},
+    };
+    wavefront.setSceneDefines(sceneDefines);
+    getRaytracer(denoiserActive, 0);
+    getRaytracer(!denoiserActive, 0);
+    if (mrb <= MAX_SPECIALIZED_BOUNCES) {
+        getRaytracer(denoiserActive, mrb);
+    }
 
-    glm::vec3 initPos = scene->getSpheres()[0].getPosition();
+    initializeSSBO();
+    frameRing.create(FRAME_UPLOAD_SIZE);
+    // Waits for the shaders that were compiling in the meantime
+    checkFrameDataBlock();
 
     while (!glfwWindowShouldClose(window)) {
 
@@ -226,10 +380,16 @@ void Engine::run() {
 
         frameCount++;
 
+        frameRing.beginFrame();
+        writeFrameData(frameCount);
+        updateSceneBuffers();
+        frameRing.submit();
+        // The one binding of the frame's constants, for every pass
+        glBindBufferRange(GL_UNIFORM_BUFFER, FRAME_DATA_BINDING, frameRing.id(), (GLintptr)frameDataOffset, sizeof(FrameData));
         raytracePass(frameCount, currentFrame, historyFrame);
 
         if (denoiserActive) {
-            accumulationPass(frameCount, currentFrame, historyFrame);
+            accumulationPass(currentFrame, historyFrame);
 
             varianceEstimatePass(currentFrame);
             atrousFilterPass(currentFrame, historyFrame);
@@ -238,6 +398,7 @@ void Engine::run() {
         renderToScreen(currentFrame, quadVAO);
 
         renderGUI();
+        frameRing.endFrame();
 
         glfwSwapBuffers(window);
         glfwPollEvents();
@@ -247,154 +408,256 @@ void Engine::run() {
 }
 
 void Engine::initializeSSBO() {
+    if (!packingPool) {
+        packingPool = std::make_unique<ThreadPool>();
+    }
+    auto start = std::chrono::steady_clock::now();
     initializeSphereSSBO();
     initializeMeshSSBO();
+    initializeTLAS();
+    trackSceneChanges();
+    double uploadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    size_t uploadBytes = 0;
+    for (const StorageBuffer* buffer : {&sphereBuffer, &meshBuffer, &vertexBuffer, &indexBuffer, &bvhBuffer,
+        &tlasNodeBuffer, &tlasInstanceBuffer}) {
+        uploadBytes += buffer->sizeBytes();
+    }
+    printf("Scene upload: %u spheres, %u meshes (%zu unique), %u unique triangles, %.1f MiB in %.1f ms on %u threads (%s)\n",
+        sphereBuffer.count(), meshBuffer.count(), uniqueMeshCount, indexBuffer.count() / 3, uploadBytes / (1024.0 * 1024.0), uploadMs,
+        packingPool->size(), sphereBuffer.isPersistent() ? "persistently mapped" : "mapped once");
 }
 
 void Engine::initializeSphereSSBO() {
-    std::vector<SphereObject> spheres = scene->getSpheres();
-    std::vector<SphereInfo> sphereInfos;
-
-    for (int i = 0; i < spheres.size(); i++) {
-        SphereObject sphere = spheres[i];
-        std::shared_ptr<Material> material = sphere.getMaterial();
-        SphereInfo sphereData;
-        sphereData.transform = sphere.getTransform();
-        sphereData.invTransorm = sphere.getInverseTransform();
-        sphereData.prevTransform = sphere.getPrevTransform();
-        sphereData.prevInverseTransform = sphere.getPrevInverseTransform();
-        MaterialInfo matData;
-        matData.color = glm::vec4(material->getColor(), 0);
-        matData.emissionColor = glm::vec4(material->getEmissionColor(), 0);
-        matData.emissionStrength = material->getEmissionStrength();
-        matData.specular = material->getSpecular();
-        sphereData.mat = matData;
-        sphereData.objectID = glm::uvec4(sphere.getObjectID(), 0, 0, 1);
-
-        sphereInfos.push_back(sphereData);
-    }
-
-    int numSpheres = sphereInfos.size();
-    size_t sphere_header_size = 16;
-    size_t sphere_data_size = sizeof(SphereInfo) * sphereInfos.size();
-    std::vector<char> sphere_ssbo_data(sphere_header_size + sphere_data_size);
-    std::memcpy(sphere_ssbo_data.data(), &numSpheres, sizeof(int));
-    std::memset(sphere_ssbo_data.data() + sizeof(int), 0, sphere_header_size - sizeof(int));
-    std::memcpy(sphere_ssbo_data.data() + sphere_header_size, sphereInfos.data(), sphere_data_size);
-    glGenBuffers(1, &sphereSSBO);
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, sphereSSBO);
-    glBufferData(GL_SHADER_STORAGE_BUFFER, sphere_ssbo_data.size(), sphere_ssbo_data.data(), GL_STATIC_READ);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, sphereSSBO); // BINDING POINT 1
+    // Each task only touches its own object, whose getters may update its
+    // cached transform
+    std::vector<SphereObject>& spheres = scene->getSpheres();
+    SphereInfo* sphereInfos = sphereBuffer.allocate<SphereInfo>(1, (uint32_t)spheres.size());
+
+    packingPool->parallelFor(spheres.size(), [&](size_t i, unsigned int) {
+        sphereInfos[i] = packSphere(spheres[i]);
+    });
+    sphereBuffer.finish();
 }
 
 void Engine::initializeMeshSSBO() {
-    std::vector<MeshObject> meshes = scene->getMeshes();
-    std::vector<TriangleInfo> triangles;
-    std::vector<MeshInfo> meshInfos;
-    unsigned int currentTriangleOffset = 0;
-
-    for (auto meshObject : meshes) {
-        auto mesh = meshObject.getMesh();
-        MeshInfo meshInfo;
-        meshInfo.transform = meshObject.getTransform();
-        meshInfo.invTransform = meshObject.getInverseTransform();
-        meshInfo.prevTransform = meshObject.getPrevTransform();
-        meshInfo.prevInverseTransform = meshObject.getInverseTransform();
-        meshInfo.boundsMin = glm::vec4(mesh->getMin(), 1.f);
-        meshInfo.boundsMax = glm::vec4(mesh->getMax(), 1.f);
-        meshInfo.info = glm::uvec4((unsigned int)currentTriangleOffset, (unsigned int)mesh->getTriangles().size(), 0, 0);
-        std::shared_ptr<Material> meshObjectMat = meshObject.getMaterial();
-        MaterialInfo matData;
-        matData.color = glm::vec4(meshObjectMat->getColor(), 0);
-        matData.emissionColor = glm::vec4(meshObjectMat->getEmissionColor(), 0);
-        matData.emissionStrength = meshObjectMat->getEmissionStrength();
-        matData.specular = meshObjectMat->getSpecular();
-        meshInfo.material = matData;
-        meshInfo.objectID = glm::uvec4(meshObject.getObjectID(), 0, 0, 0);
-        meshInfos.push_back(meshInfo);
-        std::vector<Triangle> meshTriangles = mesh->getTriangles();
-        std:: cout << meshTriangles.size() << std::endl;
-        for (const auto& triangle : meshTriangles) {
-            TriangleInfo triangleData;
-            std::memcpy(&triangleData, &triangle, sizeof(TriangleInfo));
-            triangleData.positionA.w = 1.f;
-            triangleData.positionB.w = 1.f;
-            triangleData.positionC.w = 1.f;
-            triangleData.normalA.w = 0.f;
-            triangleData.normalB.w = 0.f;
-            triangleData.normalC.w = 0.f;
-            triangles.push_back(triangleData);
+    std::vector<MeshObject>& meshes = scene->getMeshes();
+
+    // Where each Mesh goes in the shared buffers, the only serial pass. The
+    // geometry and BVH of a Mesh are stored once, every object using it
+    // points at the same ranges.
+    std::unordered_map<const Mesh*, uint32_t> geometryIndices;
+    std::vector<const Mesh*> uniqueMeshes;
+    geometryRanges.clear();
+    meshGeometry.assign(meshes.size(), 0);
+    size_t triangleCount = 0;
+    size_t vertexWordCount = 0;
+    size_t nodeCount = 0;
+    for (size_t i = 0; i < meshes.size(); i++) {
+        const Mesh* mesh = meshes[i].getMesh().get();
+        auto [it, inserted] = geometryIndices.try_emplace(mesh, (uint32_t)uniqueMeshes.size());
+        if (inserted) {
+            uniqueMeshes.push_back(mesh);
+            geometryRanges.push_back({(uint32_t)triangleCount, (uint32_t)vertexWordCount, (uint32_t)nodeCount});
+            triangleCount += mesh->getTriangleCount();
+            vertexWordCount += mesh->getPackedVertices().size();
+            nodeCount += mesh->getBVH().getNodes().size();
+        }
+        meshGeometry[i] = it->second;
+    }
+    uniqueMeshCount = uniqueMeshes.size();
+
+    MeshInfo* meshInfos = meshBuffer.allocate<MeshInfo>(3, (uint32_t)meshes.size());
+    uint32_t* vertexWords = vertexBuffer.allocate<uint32_t>(2, (uint32_t)vertexWordCount);
+    uint32_t* triangleIndices = indexBuffer.allocate<uint32_t>(7, (uint32_t)(3 * triangleCount));
+    // Triangles are already stored in leaf order
+    BVHNode* bvhNodes = bvhBuffer.allocate<BVHNode>(4, (uint32_t)nodeCount);
+
+    std::vector<CopyJob> copies;
+    copies.reserve(3 * uniqueMeshes.size());
+    for (size_t i = 0; i < uniqueMeshes.size(); i++) {
+        const Mesh& mesh = *uniqueMeshes[i];
+        std::span<const uint32_t> meshVertices = mesh.getPackedVertices();
+        std::span<const uint32_t> meshIndices = mesh.getPackedIndices();
+        std::span<const BVHNode> meshNodes = mesh.getBVH().getNodes();
+        copies.push_back({vertexWords + geometryRanges[i].firstVertexWord, meshVertices.data(), meshVertices.size_bytes()});
+        copies.push_back({triangleIndices + 3 * (size_t)geometryRanges[i].firstTriangle, meshIndices.data(), meshIndices.size_bytes()});
+        copies.push_back({bvhNodes + geometryRanges[i].firstNode, meshNodes.data(), meshNodes.size_bytes()});
+    }
+
+    packingPool->parallelFor(meshes.size(), [&](size_t i, unsigned int) {
+        meshInfos[i] = packMesh(meshes[i], geometryRanges[meshGeometry[i]]);
+    });
+    parallelCopy(*packingPool, copies);
+
+    meshBuffer.finish();
+    vertexBuffer.finish();
+    indexBuffer.finish();
+    bvhBuffer.finish();
+}
+
+void Engine::trackSceneChanges() {
+    std::vector<SphereObject>& spheres = scene->getSpheres();
+    std::vector<MeshObject>& meshes = scene->getMeshes();
+    // Only SceneLoader and render() fill the table, not buildDefaultScene()
+    scene->updateMaterialTable();
+    const size_t materialCount = scene->getMaterials().size();
+    sphereChanges.reset(spheres.size());
+    meshChanges.reset(meshes.size());
+    materialChanges.reset(materialCount);
+
+    // Material users grouped by material ID, counted first
+    materialUserOffsets.assign(materialCount + 1, 0);
+    auto forEachInstance = [&](auto&& visit) {
+        for (uint32_t i = 0; i < spheres.size(); i++) {
+            visit(i, (SceneObject&)spheres[i]);
+        }
+        for (uint32_t i = 0; i < meshes.size(); i++) {
+            visit((uint32_t)spheres.size() + i, (SceneObject&)meshes[i]);
+        }
+    };
+    forEachInstance([&](uint32_t, SceneObject& object) {
+        assert(object.getMaterialID() < materialCount);
+        materialUserOffsets[object.getMaterialID() + 1]++;
+    });
+    for (size_t m = 0; m < materialCount; m++) {
+        materialUserOffsets[m + 1] += materialUserOffsets[m];
+    }
+    materialUsers.resize(materialUserOffsets.back());
+    std::vector<uint32_t> fill(materialUserOffsets.begin(), materialUserOffsets.end() - 1);
+    forEachInstance([&](uint32_t instance, SceneObject& object) {
+        materialUsers[fill[object.getMaterialID()]++] = instance;
+        object.getMaterial()->track(&materialChanges, object.getMaterialID());
+    });
+
+    for (uint32_t i = 0; i < spheres.size(); i++) {
+        spheres[i].track(&sphereChanges, i);
+    }
+    for (uint32_t i = 0; i < meshes.size(); i++) {
+        meshes[i].track(&meshChanges, i);
+    }
+}
+
+void Engine::untrackSceneChanges() {
+    if (scene == nullptr) {
+        return;
+    }
+    for (auto& sphere : scene->getSpheres()) {
+        sphere.track(nullptr, 0);
+        sphere.getMaterial()->track(nullptr, 0);
+    }
+    for (auto& meshObject : scene->getMeshes()) {
+        meshObject.track(nullptr, 0);
+        meshObject.getMaterial()->track(nullptr, 0);
+    }
+}
+
+void Engine::updateSceneBuffers() {
+    std::vector<SphereObject>& spheres = scene->getSpheres();
+    std::vector<MeshObject>& meshes = scene->getMeshes();
+    const uint32_t sphereCount = (uint32_t)spheres.size();
+
+    // Every record embeds its material, an edit rewrites all of its users
+    for (uint32_t material : materialChanges.take()) {
+        for (uint32_t u = materialUserOffsets[material]; u < materialUserOffsets[material + 1]; u++) {
+            const uint32_t instance = materialUsers[u];
+            if (instance < sphereCount) {
+                sphereChanges.mark(instance);
+            }
+            else {
+                meshChanges.mark(instance - sphereCount);
+            }
+        }
+    }
+    if (sphereChanges.empty() && meshChanges.empty()) {
+        return;
+    }
+    const std::vector<uint32_t> dirtySpheres = sphereChanges.take();
+    const std::vector<uint32_t> dirtyMeshes = meshChanges.take();
+
+    // Material edits mark records too, only moved instances change the TLAS
+    std::vector<uint32_t> moved;
+    auto checkMoved = [&](uint32_t instance, const SceneObject& object) {
+        const uint64_t revision = object.getTransformRevision();
+        if (revision != instanceRevisions[instance]) {
+            instanceRevisions[instance] = revision;
+            instanceBounds[instance] = getInstanceBounds(instance);
+            moved.push_back(instance);
         }
-        currentTriangleOffset +=  meshTriangles.size();
-    }
-
-    // Triangle SSBO Buffer
-    size_t triangle_header_size = 16;
-    size_t triangle_data_size = sizeof(TriangleInfo) * triangles.size();
-    std::vector<char> triangle_ssbo_data(triangle_header_size + triangle_data_size);
-    int numTriangles = triangles.size();
-    std::memcpy(triangle_ssbo_data.data(), &numTriangles, sizeof(int));
-    std::memset(triangle_ssbo_data.data() + sizeof(int), 0, triangle_header_size - sizeof(int));
-    std::memcpy(triangle_ssbo_data.data() + triangle_header_size, triangles.data(), triangle_data_size);
-    glGenBuffers(1, &triangleSSBO);
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, triangleSSBO);
-    glBufferData(GL_SHADER_STORAGE_BUFFER, triangle_ssbo_data.size(), triangle_ssbo_data.data(), GL_STATIC_READ);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, triangleSSBO);
-
-    // Mesh SSBO Buffer
-    size_t mesh_header_size = 16;
-    size_t mesh_data_size = sizeof(MeshInfo) * meshInfos.size();
-    std::vector<char> mesh_ssbo_data(mesh_header_size + mesh_data_size);
-    int numMeshes = meshInfos.size();
-    std::memcpy(mesh_ssbo_data.data(), &numMeshes, sizeof(int));
-    std::memset(mesh_ssbo_data.data() + sizeof(int), 0, mesh_header_size - sizeof(int));
-    std::memcpy(mesh_ssbo_data.data() + mesh_header_size, meshInfos.data(), mesh_data_size);
-    glGenBuffers(1, &meshSSBO);
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, meshSSBO);
-    glBufferData(GL_SHADER_STORAGE_BUFFER, mesh_ssbo_data.size(), mesh_ssbo_data.data(), GL_STATIC_READ);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, meshSSBO);
-}
-
-// Temporary function
-void Engine::updateMovingSphere(int sphereIndex) {
-
-    SphereObject& sphere = scene->getSpheres()[sphereIndex];
-    glm::mat4 transform = sphere.getTransform();
-    glm::mat4 invTransform = glm::inverse(transform);
-    glm::mat4 prevTransform = sphere.getPrevTransform();
-    glm::mat4 prevInvTransform = sphere.getPrevInverseTransform();
-
-    // SSBO Metadata (must match your createSSBO() logic)
-    const size_t sphereHeaderSize = 16;
-    const size_t sphereInfoSize = sizeof(SphereInfo);
-
-    // Offset to the start of the specific SphereInfo struct
-    size_t startOffset = sphereHeaderSize + (sphereIndex * sphereInfoSize);
-
-    // The SphereInfo struct starts with the transform matrix (mat4)
-    size_t dataOffset = startOffset + offsetof(SphereInfo, transform);
-
-    // Size of the data chunk to update (transform + inverse transform)
-    size_t updateSize = 4 * sizeof(glm::mat4);
-
-    // 1. Create a contiguous data block for the two matrices
-    std::vector<char> updateData(updateSize);
-    std::memcpy(updateData.data(), glm::value_ptr(transform), sizeof(glm::mat4));
-    std::memcpy(updateData.data() + sizeof(glm::mat4), glm::value_ptr(invTransform), sizeof(glm::mat4));
-    std::memcpy(updateData.data() + 2 * sizeof(glm::mat4), glm::value_ptr(prevTransform), sizeof(glm::mat4));
-    std::memcpy(updateData.data() + 3 * sizeof(glm::mat4), glm::value_ptr(prevInvTransform), sizeof(glm::mat4));
-
-    // 2. Bind the SSBO
-    // Assuming you have the SSBO handle stored (e.g., ssbo_spheres_handle)
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, sphereSSBO);
-
-    // 3. Perform the sub-data update
-    glBufferSubData(
-        GL_SHADER_STORAGE_BUFFER,
-        dataOffset,              // Start writing at the transform matrix
-        updateSize,              // Write the transform and inverse transform
-        updateData.data()
-    );
-
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0); // Unbind
+    };
+    for (uint32_t i : dirtySpheres) {
+        checkMoved(i, spheres[i]);
+    }
+    for (uint32_t i : dirtyMeshes) {
+        checkMoved(sphereCount + i, meshes[i]);
+    }
+
+    writeDirty<SphereInfo>(frameRing, sphereBuffer, dirtySpheres, [&](uint32_t i) {
+        return packSphere(spheres[i]);
+    });
+    writeDirty<MeshInfo>(frameRing, meshBuffer, dirtyMeshes, [&](uint32_t i) {
+        return packMesh(meshes[i], geometryRanges[meshGeometry[i]]);
+    });
+
+    if (!moved.empty()) {
+        std::vector<uint32_t> refittedNodes;
+        bool rebuilt = tlas.update(instanceBounds, moved, refittedNodes);
+        uploadTLAS(rebuilt, refittedNodes);
+    }
+}
+
+AABB Engine::getInstanceBounds(uint32_t instance) {
+    std::vector<SphereObject>& spheres = scene->getSpheres();
+    if (instance < spheres.size()) {
+        // The shader intersects every sphere as a unit sphere in local space
+        const AABB unitSphere{glm::vec3(-1.0f), glm::vec3(1.0f)};
+        return unitSphere.transformed(spheres[instance].getTransform());
+    }
+    MeshObject& meshObject = scene->getMeshes()[instance - spheres.size()];
+    const auto& mesh = meshObject.getMesh();
+    return AABB{mesh->getMin(), mesh->getMax()}.transformed(meshObject.getTransform());
+}
+
+void Engine::initializeTLAS() {
+    std::vector<SphereObject>& spheres = scene->getSpheres();
+    std::vector<MeshObject>& meshes = scene->getMeshes();
+
+    instanceRevisions.clear();
+    for (auto& sphere : spheres) {
+        instanceRevisions.push_back(sphere.getTransformRevision());
+    }
+    for (auto& meshObject : meshes) {
+        instanceRevisions.push_back(meshObject.getTransformRevision());
+    }
+    instanceBounds.resize(instanceRevisions.size());
+    for (uint32_t i = 0; i < instanceBounds.size(); i++) {
+        instanceBounds[i] = getInstanceBounds(i);
+    }
+
+    tlas.build(instanceBounds);
+    uploadTLAS(true);
+}
+
+void Engine::uploadTLAS(bool rebuilt, std::span<const uint32_t> refittedNodes) {
+    std::span<const BVHNode> nodes = tlas.getBVH().getNodes();
+
+    if (!rebuilt) {
+        // A refit only moves node bounds, the instance order is unchanged
+        writeDirty<BVHNode>(frameRing, tlasNodeBuffer, refittedNodes, [&](uint32_t i) {
+            return nodes[i];
+        });
+        return;
+    }
+
+    BVHNode* nodeData = tlasNodeBuffer.allocate<BVHNode>(5, (uint32_t)nodes.size());
+    std::memcpy(nodeData, nodes.data(), nodes.size_bytes());
+    tlasNodeBuffer.finish();
+
+    const uint32_t sphereCount = (uint32_t)scene->getSpheres().size();
+    std::span<const uint32_t> order = tlas.getBVH().getPrimitiveIndices();
+    uint32_t* instances = tlasInstanceBuffer.allocate<uint32_t>(6, (uint32_t)order.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        instances[i] = order[i] < sphereCount ? order[i] : (order[i] - sphereCount) | MESH_INSTANCE_BIT;
+    }
+    tlasInstanceBuffer.finish();
 }
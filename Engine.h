@@ -8,9 +8,13 @@
 #include "stb_image_write.h"
 #include <string>
 #include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <iostream>
 #include <ostream>
 #include <filesystem>
+#include <map>
+#include <unordered_map>
 namespace fs = std::filesystem;
 
 #include "ImGui/imgui.h"
@@ -22,6 +26,12 @@ namespace fs = std::filesystem;
 #include "Scene.h"
 #include "CameraController.h"
 #include "SVGFDenoiser.h"
+#include "WavefrontTracer.h"
+#include "StorageBuffer.h"
+#include "ProgramCache.h"
+#include "FrameRing.h"
+#include "Utilities/ChangeTracker.h"
+#include "Acceleration/TopLevelBVH.h"
 
 #ifndef ENGINE_H
 #define ENGINE_H
@@ -39,20 +49,47 @@ struct alignas(16) SphereInfo {
     glm::uvec4 objectID;
 };
 
-struct alignas(16) TriangleInfo {
-    glm::vec4 positionA, positionB, positionC;
-    glm::vec4 normalA, normalB, normalC;
-};
+// Uploaded as is to the BVH SSBO, must match the shader's BVHNode
+static_assert(sizeof(BVHNode) == 32, "BVHNode must stay 32 bytes for std430");
 
 struct alignas(16) MeshInfo {
     glm::mat4 transform, invTransform;
     glm::mat4 prevTransform, prevInverseTransform;
     glm::vec4 boundsMin, boundsMax;
-    glm::uvec4 info;
+    glm::uvec4 info; // first triangle, triangle count, first BVH node, BVH node count
+    glm::uvec4 vertexInfo; // first vertex word, words per vertex (VertexPacking::stride)
+    glm::vec4 quantizationStep; // of quantized positions, which start at boundsMin
     MaterialInfo material;
     glm::uvec4 objectID;
 };
 
+// std140 mirror of the raytrace shader's FrameData uniform block
+struct alignas(16) FrameData {
+    glm::mat4 inverseProjection, cameraToWorld, prevViewProjection, viewProjection;
+    glm::vec3 viewCenter;
+    int32_t frame;
+    int32_t raysPerPixel, maxBounces;
+    uint32_t denoiserActive;
+    float padding;
+};
+static_assert(sizeof(FrameData) == 288, "FrameData must match the std140 block");
+
+constexpr GLuint FRAME_DATA_BINDING = 0;
+// Per-frame upload space, updates beyond it fall back to glBufferSubData
+constexpr size_t FRAME_UPLOAD_SIZE = 4 << 20;
+// Bounce counts up to this get a raytrace kernel with the count compiled in,
+// higher ones read it from FrameData
+constexpr int MAX_SPECIALIZED_BOUNCES = 16;
+
+// Where a Mesh's geometry sits in the shared vertex, index and BVH buffers
+struct MeshRange {
+    uint32_t firstTriangle, firstVertexWord, firstNode;
+};
+
+// TLAS leaves store instance references: a sphere index, or a mesh index
+// with this bit set
+constexpr uint32_t MESH_INSTANCE_BIT = 0x80000000u;
+
 enum class DebugMode {
     NOISY_TEXTURE = 0,
     DEPTH_TEXTURE = 1,
@@ -70,7 +107,7 @@ inline void resetAccumulation(unsigned int textureID) {
 class Engine {
 public:
     Engine(const std::string& title, const int width, const int height) :
-        denoiser(width, height)
+        denoiser(width, height), wavefront(width, height)
     {
         this->width = width;
         this->height = height;
@@ -84,6 +121,13 @@ public:
     }
     ~Engine() {
         std::cout << "Engine closing" << std::endl;
+        untrackSceneChanges();
+        for (StorageBuffer* buffer : {&sphereBuffer, &meshBuffer, &vertexBuffer, &indexBuffer, &bvhBuffer,
+            &tlasNodeBuffer, &tlasInstanceBuffer}) {
+            buffer->release();
+        }
+        frameRing.release();
+        wavefront.release();
         ImGui_ImplOpenGL3_Shutdown();
         ImGui_ImplGlfw_Shutdown();
         glfwDestroyWindow(window);
@@ -100,6 +144,8 @@ public:
         cameraController = std::make_unique<CameraController>(*camera, 0.05f, 0.1f);
     }
 
+    // Only remembers the file, run() compiles the kernel variants once the
+    // scene is known
     void createComputeShader(std::string shaderName);
     void createShaderProgram(std::string vertexShaderName, std::string fragmentShaderName);
 
@@ -115,14 +161,45 @@ private:
     std::unique_ptr<CameraController> cameraController;
 
     Shader shader;
-    ComputeShader raytracer;
+    // Raytrace kernels by denoiser setting and compiled-in bounce count (0
+    // for the generic kernel reading MaxRayBounce), compiled on first need
+    std::string raytraceShaderName;
+    ShaderDefines sceneDefines;
+    std::map<std::pair<bool, int>, ComputeShader> raytracers;
     SVGFDenoiser denoiser;
+    WavefrontTracer wavefront;
 
     DebugMode debugMode;
 
-    GLuint meshSSBO, triangleSSBO, sphereSSBO;
+    StorageBuffer sphereBuffer, meshBuffer, vertexBuffer, indexBuffer, bvhBuffer;
+    StorageBuffer tlasNodeBuffer, tlasInstanceBuffer;
+    // Frame constants and scene updates, read by the GPU frames later
+    FrameRing frameRing;
+    size_t frameDataOffset = 0;
+    // Packs the scene straight into the mapped buffers
+    std::unique_ptr<ThreadPool> packingPool;
+    // Distinct Mesh objects among the mesh instances, each uploaded once
+    size_t uniqueMeshCount = 0;
+    // Per distinct Mesh, and which of them each mesh instance uses
+    std::vector<MeshRange> geometryRanges;
+    std::vector<uint32_t> meshGeometry;
+
+    // Marked by the scene objects' and materials' setters, drained once per
+    // frame by updateSceneBuffers()
+    ChangeTracker sphereChanges, meshChanges, materialChanges;
+    // Instances (spheres, then meshes) using each material ID, users of
+    // material m are [materialUserOffsets[m], materialUserOffsets[m + 1])
+    std::vector<uint32_t> materialUserOffsets, materialUsers;
+
+    // Top level BVH over every sphere and mesh instance, refitted around the
+    // instances whose transform changed
+    TopLevelBVH tlas;
+    std::vector<AABB> instanceBounds;
+    std::vector<uint64_t> instanceRevisions;
 
     bool denoiserActive = true;
+    // Traces with the WavefrontTracer kernels instead of the megakernel
+    bool wavefrontActive = false;
     int screenShots = 11;
 
     // Private functions
@@ -132,14 +209,30 @@ private:
     void initializeSSBO();
     void initializeSphereSSBO();
     void initializeMeshSSBO();
+    void initializeTLAS();
     void updateSSBO();
 
-    void updateMovingSphere(int sphereIndex);
+    void trackSceneChanges();
+    void untrackSceneChanges();
+    // Uploads the records and TLAS nodes changed since the last frame
+    void updateSceneBuffers();
+
+    AABB getInstanceBounds(uint32_t instance);
+    // After a rebuild everything is uploaded, after a refit only refittedNodes
+    void uploadTLAS(bool rebuilt, std::span<const uint32_t> refittedNodes = {});
 
     unsigned int createRenderTarget();
 
+    ComputeShader& getRaytracer(bool denoise, int fixedBounces);
+    // The kernel specialized for the current settings once it has compiled,
+    // the generic one meanwhile
+    ComputeShader& selectRaytracer();
+
+    void writeFrameData(int frame);
+    void checkFrameDataBlock();
+
     void raytracePass(int frame, int currentFrame, int historyFrame);
-    void accumulationPass(int frame, int currentFrame, int historyFrame);
+    void accumulationPass(int currentFrame, int historyFrame);
     void varianceEstimatePass(int currentFrame);
     void atrousFilterPass(int currentFrame, int historyFrame);
     void renderToScreen(int currentFrame, unsigned int quadVAO);
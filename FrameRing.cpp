@@ -0,0 +1,131 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#include "FrameRing.h"
+
+#include <stdexcept>
+#include <string>
+
+#include "StorageBuffer.h"
+
+void FrameRing::create(size_t frameSize) {
+    release();
+
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    uniformAlignment = alignment > 0 ? (size_t)alignment : 256;
+    // Every slice starts aligned for uniform blocks
+    sliceSize = (frameSize + uniformAlignment - 1) / uniformAlignment * uniformAlignment;
+    const size_t totalSize = sliceSize * FRAMES_IN_FLIGHT;
+    persistent = StorageBuffer::persistentMappingSupported();
+
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    if (persistent) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_COPY_WRITE_BUFFER, (GLsizeiptr)totalSize, nullptr, flags);
+        mapped = (char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, (GLsizeiptr)totalSize, flags);
+    }
+    else {
+        glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)totalSize, nullptr, GL_STREAM_DRAW);
+        staging.resize(totalSize);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    if (persistent && mapped == nullptr) {
+        release();
+        throw std::runtime_error("Failed to map a frame ring of " + std::to_string(totalSize) + " bytes");
+    }
+}
+
+void FrameRing::release() {
+    for (GLsync& fence : fences) {
+        if (fence) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+    if (buffer == 0) {
+        return;
+    }
+    if (mapped != nullptr) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        mapped = nullptr;
+    }
+    staging.clear();
+    glDeleteBuffers(1, &buffer);
+    buffer = 0;
+}
+
+void FrameRing::beginFrame() {
+    slice = (slice + 1) % FRAMES_IN_FLIGHT;
+    used = 0;
+    submitted = 0;
+    copies.clear();
+
+    GLsync& fence = fences[slice];
+    if (!fence) {
+        return;
+    }
+    GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    if (result == GL_TIMEOUT_EXPIRED) {
+        stalls++;
+        do {
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        } while (result == GL_TIMEOUT_EXPIRED);
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+    if (result == GL_WAIT_FAILED) {
+        throw std::runtime_error("Waiting for a frame ring fence failed");
+    }
+}
+
+void* FrameRing::allocate(size_t size, size_t alignment, size_t& offset) {
+    const size_t start = (used + alignment - 1) / alignment * alignment;
+    if (start + size > sliceSize) {
+        overflows++;
+        return nullptr;
+    }
+    used = start + size;
+    offset = sliceStart() + start;
+    return memory() + offset;
+}
+
+void* FrameRing::copyTo(GLuint destination, size_t destinationOffset, size_t size) {
+    size_t offset;
+    void* data = allocate(size, 16, offset);
+    if (data != nullptr) {
+        copies.push_back({destination, offset, destinationOffset, size});
+    }
+    return data;
+}
+
+void FrameRing::submit() {
+    if (!persistent && used > submitted) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)(sliceStart() + submitted), (GLsizeiptr)(used - submitted),
+            staging.data() + sliceStart() + submitted);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+    submitted = used;
+
+    if (copies.empty()) {
+        return;
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+    for (const Copy& copy : copies) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, copy.destination);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, (GLintptr)copy.sourceOffset,
+            (GLintptr)copy.destinationOffset, (GLsizeiptr)copy.size);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    copies.clear();
+}
+
+void FrameRing::endFrame() {
+    fences[slice] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
@@ -0,0 +1,101 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#ifndef FRAMERING_H
+#define FRAMERING_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+
+// Per-frame upload memory: one buffer split into FRAMES_IN_FLIGHT slices
+// used round robin, each guarded by a fence placed after the last command
+// of its frame. The CPU writes frame N+2's data while the GPU still reads
+// frame N's, and only waits when it gets FRAMES_IN_FLIGHT frames ahead.
+//
+// A frame allocates uniform data and queued copies into other buffers
+// (dirty SSBO records) from its slice, then submit() makes the writes
+// visible and issues the copies on the GPU. With persistent mapping the
+// slices are written in place. Otherwise the slice is staged in CPU memory
+// and uploaded by submit() with one glBufferSubData, which the fence keeps
+// from ever touching memory the GPU is still reading.
+class FrameRing {
+public:
+    static constexpr uint32_t FRAMES_IN_FLIGHT = 3;
+
+    // frameSize bytes per slice. Needs a current GL context.
+    void create(size_t frameSize);
+    void release();
+
+    // Waits for the GPU to be done with the next slice, which becomes the
+    // current one
+    void beginFrame();
+    // Memory in the current slice, nullptr when the slice is full. offset
+    // is where it is in the buffer, e.g. for glBindBufferRange.
+    void* allocate(size_t size, size_t alignment, size_t& offset);
+    template<typename T>
+    T* allocateUniform(size_t& offset) {
+        return static_cast<T*>(allocate(sizeof(T), uniformAlignment, offset));
+    }
+    // Memory for size bytes that submit() copies to destinationOffset in the
+    // destination buffer. nullptr when the slice is full, the caller then
+    // has to upload another way.
+    void* copyTo(GLuint destination, size_t destinationOffset, size_t size);
+    template<typename T>
+    T* copyTo(GLuint destination, size_t destinationOffset, size_t count) {
+        return static_cast<T*>(copyTo(destination, destinationOffset, count * sizeof(T)));
+    }
+    // Makes this frame's writes visible and issues its copies. Allocate
+    // everything before, dispatch what reads it after.
+    void submit();
+    // Fences the current slice, after the frame's last command reading it
+    void endFrame();
+
+    [[nodiscard]] GLuint id() const {
+        return buffer;
+    }
+    [[nodiscard]] bool isPersistent() const {
+        return persistent;
+    }
+    // Frames for which beginFrame() had to wait for the GPU
+    [[nodiscard]] uint64_t getStallCount() const {
+        return stalls;
+    }
+    // Allocations that didn't fit in their slice
+    [[nodiscard]] uint64_t getOverflowCount() const {
+        return overflows;
+    }
+
+private:
+    struct Copy {
+        GLuint destination;
+        size_t sourceOffset, destinationOffset, size;
+    };
+
+    GLuint buffer = 0;
+    bool persistent = false;
+    char* mapped = nullptr;
+    // Stand-in for the mapping when there is no persistent mapping
+    std::vector<char> staging;
+    size_t sliceSize = 0;
+    size_t uniformAlignment = 256;
+
+    GLsync fences[FRAMES_IN_FLIGHT] = {};
+    uint32_t slice = FRAMES_IN_FLIGHT - 1;
+    size_t used = 0;
+    size_t submitted = 0;
+    std::vector<Copy> copies;
+
+    uint64_t stalls = 0;
+    uint64_t overflows = 0;
+
+    [[nodiscard]] char* memory() {
+        return persistent ? mapped : staging.data();
+    }
+    [[nodiscard]] size_t sliceStart() const {
+        return (size_t)slice * sliceSize;
+    }
+};
+
+#endif //FRAMERING_H
@@ -3,3 +3,23 @@
 //
 
 #include "Material.h"
+#include <stdexcept>
+
+uint32_t MaterialTable::getID(const std::shared_ptr<Material>& material) {
+    if (!material) {
+        throw std::runtime_error("Scene object has no material");
+    }
+    auto found = ids.find(material.get());
+    if (found != ids.end()) {
+        return found->second;
+    }
+    uint32_t id = static_cast<uint32_t>(materials.size());
+    materials.push_back(material);
+    ids.emplace(material.get(), id);
+    return id;
+}
+
+void MaterialTable::clear() {
+    materials.clear();
+    ids.clear();
+}
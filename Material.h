@@ -4,9 +4,14 @@
 
 #ifndef MATERIAL_H
 #define MATERIAL_H
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "glm/vec3.hpp"
+#include "Utilities/ChangeTracker.h"
 
 
 class Material {
@@ -16,11 +21,52 @@ public:
         glm::vec3 getEmissionColor() const { return emissionColor; }
         float getEmissionStrength() const { return emissionStrength; }
         float getSpecular() const { return specular; }
+
+        // Edits are reported to the tracker given by track(), if any
+        void setColor(const glm::vec3 color) { this->color = color; markChanged(); }
+        void setEmissionColor(const glm::vec3 emissionColor) { this->emissionColor = emissionColor; markChanged(); }
+        void setEmissionStrength(float emissionStrength) { this->emissionStrength = emissionStrength; markChanged(); }
+        void setSpecular(float specular) { this->specular = specular; markChanged(); }
+
+        // index is the material's ID in whatever the tracker covers, nullptr stops tracking
+        void track(ChangeTracker* tracker, uint32_t index) {
+                this->tracker = tracker;
+                trackedIndex = index;
+        }
 private:
         glm::vec3 color;
         glm::vec3 emissionColor;
         float emissionStrength;
         float specular;
+
+        ChangeTracker* tracker = nullptr;
+        uint32_t trackedIndex = 0;
+
+        void markChanged() {
+                if (tracker) {
+                        tracker->mark(trackedIndex);
+                }
+        }
+};
+
+// Dense 32-bit IDs for the materials of a scene. Hits only carry the ID and
+// the material is looked up once per path vertex, so the intersection code
+// never touches the shared_ptr reference counts.
+class MaterialTable {
+public:
+        // Adds the material on first use
+        uint32_t getID(const std::shared_ptr<Material>& material);
+        void clear();
+
+        [[nodiscard]] const Material& operator[](uint32_t id) const {
+                return *materials[id];
+        }
+        [[nodiscard]] size_t size() const {
+                return materials.size();
+        }
+private:
+        std::vector<std::shared_ptr<Material>> materials;
+        std::unordered_map<const Material*, uint32_t> ids;
 };
 
 
@@ -4,48 +4,14 @@
 
 #include "Mesh.h"
 
+#include <algorithm>
+#include <unordered_map>
 
-void Mesh::setupForGPUTransfer() {
-    auto vertices = getVertices();
-    auto normals = getNormals();
-    auto uvs = getUvs();
-
-    auto vertexIndices = getVertIndices();
-    auto normalIndices = getNormalIndices();
-    auto uvIndices = getTexIndices();
-
-    for (int i = 0; i < vertexIndices.size(); i += 3) {
-        int v_idx_A = vertexIndices[i + 0];
-        int v_idx_B = vertexIndices[i + 1];
-        int v_idx_C = vertexIndices[i + 2];
-
-        int n_idx_A = normalIndices[i + 0];
-        int n_idx_B = normalIndices[i + 1];
-        int n_idx_C = normalIndices[i + 2];
-
-        int uv_idx_A = uvIndices[i + 0];
-        int uv_idx_B = uvIndices[i + 1];
-        int uv_idx_C = uvIndices[i + 2];
-
-        glm::vec3 v1 = vertices[v_idx_A];
-        glm::vec3 v2 = vertices[v_idx_B];
-        glm::vec3 v3 = vertices[v_idx_C];
-
-        glm::vec3 n1 = normals[n_idx_A];
-        glm::vec3 n2 = normals[n_idx_B];
-        glm::vec3 n3 = normals[n_idx_C];
-        Triangle triangle{};
-        triangle.positionA = glm::vec4(v1, 1);
-        triangle.positionB = glm::vec4(v2, 1);
-        triangle.positionC = glm::vec4(v3, 1);
-        triangle.normalA = glm::vec4(n1, 0);
-        triangle.normalB = glm::vec4(n2, 0);
-        triangle.normalC = glm::vec4(n3, 0);
-        triangles.push_back(triangle);
-    }
-
-    glm::vec3 min = glm::vec3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
-    glm::vec3 max = glm::vec3(FLT_MAX, FLT_MAX, FLT_MAX);
+
+void Mesh::setupForGPUTransfer(std::span<const glm::vec3> vertices, std::span<const glm::vec3> normals,
+    std::span<const unsigned int> vertexIndices, std::span<const unsigned int> normalIndices) {
+    glm::vec3 min = glm::vec3(FLT_MAX, FLT_MAX, FLT_MAX);
+    glm::vec3 max = glm::vec3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
     for (glm::vec3 v : vertices) {
         min.x = std::min(min.x, v.x);
         min.y = std::min(min.y, v.y);
@@ -57,4 +23,154 @@ void Mesh::setupForGPUTransfer() {
 
     minBound = min;
     maxBound = max;
+    quantizationStep = vertexFormat == VertexFormat::Quantized
+        ? VertexPacking::quantizationStep(min, max) : glm::vec3(0.0f);
+
+    // Weld each distinct position and encoded normal into one packed vertex.
+    // The first normal of a position is found without hashing, only the
+    // positions with several normals (hard edges) go through the map.
+    constexpr uint32_t NO_VERTEX = UINT32_MAX;
+    const uint32_t stride = VertexPacking::stride(vertexFormat);
+    std::vector<uint32_t> firstVertex(vertices.size(), NO_VERTEX);
+    std::vector<uint32_t> firstNormal(vertices.size());
+    std::unordered_map<uint64_t, uint32_t> hardEdgeVertices;
+    std::vector<uint32_t> packedVertices;
+    std::vector<uint32_t> packedIndices(vertexIndices.size());
+    uint32_t vertexCount = 0;
+    auto addVertex = [&](uint32_t position, uint32_t normal) {
+        packedVertices.resize(packedVertices.size() + stride);
+        VertexPacking::pack(vertexFormat, vertices[position], normals[normal], min, quantizationStep,
+            packedVertices.data() + packedVertices.size() - stride);
+        return vertexCount++;
+    };
+
+    for (size_t i = 0; i < vertexIndices.size(); i++) {
+        const uint32_t position = vertexIndices[i];
+        const uint32_t normal = normalIndices[i];
+        const uint32_t encodedNormal = VertexPacking::encodeNormal(normals[normal]);
+        if (firstVertex[position] == NO_VERTEX) {
+            firstVertex[position] = addVertex(position, normal);
+            firstNormal[position] = encodedNormal;
+            packedIndices[i] = firstVertex[position];
+        }
+        else if (firstNormal[position] == encodedNormal) {
+            packedIndices[i] = firstVertex[position];
+        }
+        else {
+            auto [it, inserted] = hardEdgeVertices.try_emplace((uint64_t)position << 32 | encodedNormal, vertexCount);
+            if (inserted) {
+                addVertex(position, normal);
+            }
+            packedIndices[i] = it->second;
+        }
+    }
+    this->packedVertices = std::move(packedVertices);
+    this->packedIndices = std::move(packedIndices);
+}
+
+void Mesh::buildBVH() {
+    const size_t triangleCount = getTriangleCount();
+    std::vector<AABB> triangleBounds(triangleCount);
+    for (size_t i = 0; i < triangleCount; i++) {
+        for (int corner = 0; corner < 3; corner++) {
+            triangleBounds[i].grow(getPackedPosition(packedIndices[3 * i + corner]));
+        }
+    }
+
+    bvh.build(triangleBounds);
+
+    // Store the triangles in leaf order, so that a leaf is a contiguous range
+    // and neighbouring leaves are close in memory
+    std::span<const uint32_t> order = bvh.getPrimitiveIndices();
+    std::vector<uint32_t> sortedPackedIndices(packedIndices.size());
+    std::vector<unsigned int> sortedTexIndices(texIndices.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        uint32_t source = order[i];
+        for (int corner = 0; corner < 3; corner++) {
+            sortedPackedIndices[3 * i + corner] = packedIndices[3 * source + corner];
+            if (!texIndices.empty()) {
+                sortedTexIndices[3 * i + corner] = texIndices[3 * source + corner];
+            }
+        }
+    }
+
+    // Renumber the packed vertices in order of first use, so the vertices of
+    // a leaf are close together as well
+    constexpr uint32_t NO_VERTEX = UINT32_MAX;
+    const uint32_t stride = VertexPacking::stride(vertexFormat);
+    std::vector<uint32_t> renumbered(getPackedVertexCount(), NO_VERTEX);
+    std::vector<uint32_t> sortedPackedVertices(packedVertices.size());
+    uint32_t vertexCount = 0;
+    for (uint32_t& vertex : sortedPackedIndices) {
+        if (renumbered[vertex] == NO_VERTEX) {
+            std::copy_n(packedVertices.data() + vertex * stride, stride, sortedPackedVertices.data() + vertexCount * stride);
+            renumbered[vertex] = vertexCount++;
+        }
+        vertex = renumbered[vertex];
+    }
+    sortedPackedVertices.resize(vertexCount * stride);
+
+    packedVertices = std::move(sortedPackedVertices);
+    packedIndices = std::move(sortedPackedIndices);
+    texIndices = std::move(sortedTexIndices);
+
+    buildTriangleStreams();
+}
+
+void Mesh::buildTriangleStreams() {
+    // The CPU intersects the same, possibly quantized, positions as the GPU
+    std::vector<glm::vec3> positions(getPackedVertexCount());
+    for (uint32_t vertex = 0; vertex < positions.size(); vertex++) {
+        positions[vertex] = getPackedPosition(vertex);
+    }
+    triangleStore.build(positions, packedIndices.span());
+}
+
+void TriangleStore::build(std::span<const glm::vec3> positions, std::span<const uint32_t> indices) {
+    count = indices.size() / 3;
+    std::vector<float>& planeData = data.edit();
+    planeData.resize(PLANE_COUNT * count);
+    float* planes[PLANE_COUNT];
+    for (int component = 0; component < PLANE_COUNT; component++) {
+        planes[component] = planeData.data() + component * count;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        glm::vec3 a = positions[indices[3 * i + 0]];
+        glm::vec3 edge1 = positions[indices[3 * i + 1]] - a;
+        glm::vec3 edge2 = positions[indices[3 * i + 2]] - a;
+        planes[A_X][i] = a.x;
+        planes[A_Y][i] = a.y;
+        planes[A_Z][i] = a.z;
+        planes[EDGE1_X][i] = edge1.x;
+        planes[EDGE1_Y][i] = edge1.y;
+        planes[EDGE1_Z][i] = edge1.z;
+        planes[EDGE2_X][i] = edge2.x;
+        planes[EDGE2_Y][i] = edge2.y;
+        planes[EDGE2_Z][i] = edge2.z;
+    }
+}
+
+void TriangleStore::assign(MappedArray<float> planes, size_t triangleCount) {
+    data = std::move(planes);
+    count = triangleCount;
+}
+
+size_t Mesh::getMemoryBytes() const {
+    return texCoords.size() * sizeof(glm::vec2)
+        + texIndices.size() * sizeof(unsigned int)
+        + (packedVertices.size() + packedIndices.size()) * sizeof(uint32_t)
+        + TriangleStore::PLANE_COUNT * triangleStore.size() * sizeof(float)
+        + bvh.getNodes().size() * sizeof(BVHNode)
+        + bvh.getPrimitiveIndices().size() * sizeof(uint32_t);
+}
+
+void Mesh::setBVHLayout(BVHLayout layout) {
+    if (layout == BVHLayout::Wide4 && bvh4.isEmpty()) {
+        bvh4.build(bvh);
+    }
+    if (layout == BVHLayout::Wide8 && bvh8.isEmpty()) {
+        bvh8.build(bvh);
+    }
+    bvhLayout = layout;
 }
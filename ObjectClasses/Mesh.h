@@ -4,40 +4,95 @@
 
 #ifndef MESH_H
 #define MESH_H
+#include <cstdint>
 #include <iostream>
+#include <memory>
 #include <ostream>
+#include <span>
 #include <vector>
 
 #include <glm/glm.hpp>
 
-struct alignas(16) Triangle {
-    glm::vec4 positionA, positionB, positionC, normalA, normalB, normalC;
-    // TODO: ADD TEX COORDS
+#include "../Acceleration/BVH.h"
+#include "../Acceleration/WideBVH.h"
+#include "../Utilities/MappedFile.h"
+#include "../Utilities/VertexPacking.h"
+
+// Triangle positions for the CPU intersection kernels, in structure of
+// arrays layout: one plane of size() floats per component of vertex A and of
+// the edges A->B and A->C. Nothing else is read while searching for a hit.
+class TriangleStore {
+public:
+    enum Plane {
+        A_X, A_Y, A_Z,
+        EDGE1_X, EDGE1_Y, EDGE1_Z,
+        EDGE2_X, EDGE2_Y, EDGE2_Z,
+        PLANE_COUNT
+    };
+
+    // Three indices into positions per triangle
+    void build(std::span<const glm::vec3> positions, std::span<const uint32_t> indices);
+    // Planes built earlier, e.g. views into a mesh cache file
+    void assign(MappedArray<float> planes, size_t triangleCount);
+
+    [[nodiscard]] size_t size() const {
+        return count;
+    }
+    [[nodiscard]] const float* plane(Plane component) const {
+        return data.data() + component * count;
+    }
+    // All planes back to back, plane k starts at k * size()
+    [[nodiscard]] const float* getData() const {
+        return data.data();
+    }
+
+private:
+    MappedArray<float> data;
+    size_t count = 0;
 };
 
 class Mesh {
 public:
 
-    [[nodiscard]] const std::vector<glm::vec3>& getVertices() const {
-        return vertices;
+    [[nodiscard]] std::span<const glm::vec2> getUvs() const {
+        return texCoords.span();
+    }
+    // Three per triangle in packed (leaf) order, empty without UVs
+    [[nodiscard]] std::span<const unsigned int> getTexIndices() const {
+        return texIndices.span();
+    }
+    [[nodiscard]] size_t getTriangleCount() const {
+        return packedIndices.size() / 3;
+    }
+    // Vertices with their position and normal welded, VertexPacking words in
+    // the layout of the shaders' vertex SSBO
+    [[nodiscard]] std::span<const uint32_t> getPackedVertices() const {
+        return packedVertices.span();
+    }
+    [[nodiscard]] size_t getPackedVertexCount() const {
+        return packedVertices.size() / VertexPacking::stride(vertexFormat);
     }
-    [[nodiscard]] const std::vector<glm::vec3>& getNormals() const {
-        return normals;
+    // Three packed vertices per triangle, in the shaders' index SSBO layout
+    [[nodiscard]] std::span<const uint32_t> getPackedIndices() const {
+        return packedIndices.span();
     }
-    [[nodiscard]] const std::vector<glm::vec2>& getUvs() const {
-        return texCoords;
+    [[nodiscard]] VertexFormat getVertexFormat() const {
+        return vertexFormat;
     }
-    [[nodiscard]] const std::vector<unsigned int>& getVertIndices() const {
-        return vertIndices;
+    // Quantized positions are getMin() + q * getQuantizationStep()
+    [[nodiscard]] const glm::vec3& getQuantizationStep() const {
+        return quantizationStep;
     }
-    [[nodiscard]] const std::vector<unsigned int>& getNormalIndices() const {
-        return normalIndices;
+    [[nodiscard]] glm::vec3 getPackedPosition(uint32_t vertex) const {
+        return VertexPacking::unpackPosition(vertexFormat,
+            packedVertices.data() + vertex * VertexPacking::stride(vertexFormat), minBound, quantizationStep);
     }
-    [[nodiscard]] const std::vector<unsigned int>& getTexIndices() const {
-        return texIndices;
+    [[nodiscard]] glm::vec3 getPackedNormal(uint32_t vertex) const {
+        const uint32_t stride = VertexPacking::stride(vertexFormat);
+        return VertexPacking::decodeNormal(packedVertices[vertex * stride + stride - 1]);
     }
-    [[nodiscard]] const std::vector<Triangle>& getTriangles() const {
-        return triangles;
+    [[nodiscard]] const TriangleStore& getTriangleStore() const {
+        return triangleStore;
     }
     [[nodiscard]] const glm::vec3& getMin() const {
         return minBound;
@@ -45,42 +100,88 @@ public:
     [[nodiscard]] const glm::vec3& getMax() const {
         return maxBound;
     }
+    [[nodiscard]] const BVH& getBVH() const {
+        return bvh;
+    }
+    [[nodiscard]] const WideBVH<4>& getBVH4() const {
+        return bvh4;
+    }
+    [[nodiscard]] const WideBVH<8>& getBVH8() const {
+        return bvh8;
+    }
+    // Layout MeshObject::localIntersect traverses on the CPU
+    [[nodiscard]] BVHLayout getBVHLayout() const {
+        return bvhLayout;
+    }
+    // Collapses the binary BVH into the wide layout the first time it is
+    // selected. Not thread safe, call it while building the scene.
+    void setBVHLayout(BVHLayout layout);
 
+    // The positions, normals and their indices are only read to weld the
+    // packed vertices and are freed once the constructor returns
     Mesh(std::vector<glm::vec3> vertices,
         std::vector<glm::vec3> normals,
         std::vector<glm::vec2> texCoords,
         std::vector<unsigned int> indices,
         std::vector<unsigned int> normalIndices,
-        std::vector<unsigned int> texIndices) :
-    vertices(std::move(vertices)),
-    normals(std::move(normals)),
+        std::vector<unsigned int> texIndices,
+        VertexFormat vertexFormat = VertexFormat::Float) :
     texCoords(std::move(texCoords)),
-    vertIndices(std::move(indices)),
-    normalIndices(std::move(normalIndices)),
-    texIndices(std::move(texIndices)) {
-        setupForGPUTransfer();
+    texIndices(std::move(texIndices)),
+    vertexFormat(vertexFormat) {
+        setupForGPUTransfer(vertices, normals, indices, normalIndices);
     }
 
 
 
 
+    Mesh(const Mesh&) = delete;
+    Mesh& operator=(const Mesh&) = delete;
+
+    // Bytes of every array, mapped or owned, without the wide BVHs
+    [[nodiscard]] size_t getMemoryBytes() const;
+
+    // True when the arrays are views into a mapped cache file
+    [[nodiscard]] bool isMapped() const {
+        return mapping != nullptr;
+    }
+
 private:
-    std::vector<glm::vec3> vertices;
-    std::vector<glm::vec3> normals;
-    std::vector<glm::vec2> texCoords;
-    std::vector<unsigned int> vertIndices;
-    std::vector<unsigned int> normalIndices;
-    std::vector<unsigned int> texIndices;
+    // Empty mesh for MeshCache to fill with views into its mapping
+    Mesh() = default;
+
+    // Keeps the cache file mapped while the arrays point into it
+    std::shared_ptr<const MappedFile> mapping;
 
-    std::vector<Triangle> triangles;
+    // Kept for UV lookups, everything else is in the packed arrays
+    MappedArray<glm::vec2> texCoords;
+    MappedArray<unsigned int> texIndices;
+
+    VertexFormat vertexFormat = VertexFormat::Float;
+    MappedArray<uint32_t> packedVertices;
+    MappedArray<uint32_t> packedIndices;
+    // CPU copies of the packed positions, in the same (leaf) order
+    TriangleStore triangleStore;
 
     glm::vec3 minBound, maxBound;
+    glm::vec3 quantizationStep = glm::vec3(0.0f);
+
+    // Leaves index straight into the triangles of packedIndices (and
+    // texIndices), which are reordered to match when the BVH is built
+    BVH bvh;
+    WideBVH<4> bvh4;
+    WideBVH<8> bvh8;
+    BVHLayout bvhLayout = BVHLayout::Binary;
 
-    void setupForGPUTransfer();
+    void setupForGPUTransfer(std::span<const glm::vec3> vertices, std::span<const glm::vec3> normals,
+        std::span<const unsigned int> vertexIndices, std::span<const unsigned int> normalIndices);
+    void buildBVH();
+    void buildTriangleStreams();
 
 
 
     friend class MeshBuilder;
+    friend class MeshCache;
 };
 
 
@@ -4,54 +4,131 @@
 
 #include "MeshObject.h"
 
-void MeshObject::localIntersect(Ray &ray, HitInfo &hit_info) const {
-    if (!mesh) {
-        printf("<Mesh Object has no mesh data associated>");
-        return;
-    }
+namespace {
+
+constexpr uint32_t NO_TRIANGLE = UINT32_MAX;
+
+struct TriangleHit {
+    float hitDist;
+    uint32_t triangle;
+    float u;
+    float v;
+};
 
-    const auto& verts = mesh->getVertices();
-    const auto& norms = mesh->getNormals();
-    const auto& uvs = mesh->getUvs();
-    const auto& indices = mesh->getVertIndices();
+// Closest hit among the triangles [first, first + count). Reads only the
+// position planes and has no early exit, every test is folded into a select,
+// so the compiler is free to vectorize it.
+void intersectTriangles(const TriangleStore& store, uint32_t first, uint32_t count,
+    const glm::vec3& origin, const glm::vec3& direction, TriangleHit& closest) {
+    const float* aX = store.plane(TriangleStore::A_X);
+    const float* aY = store.plane(TriangleStore::A_Y);
+    const float* aZ = store.plane(TriangleStore::A_Z);
+    const float* edge1X = store.plane(TriangleStore::EDGE1_X);
+    const float* edge1Y = store.plane(TriangleStore::EDGE1_Y);
+    const float* edge1Z = store.plane(TriangleStore::EDGE1_Z);
+    const float* edge2X = store.plane(TriangleStore::EDGE2_X);
+    const float* edge2Y = store.plane(TriangleStore::EDGE2_Y);
+    const float* edge2Z = store.plane(TriangleStore::EDGE2_Z);
 
-    for (size_t i = 0; i < indices.size(); i += 3) {
-        unsigned int i0 = indices[i + 0];
-        unsigned int i1 = indices[i + 1];
-        unsigned int i2 = indices[i + 2];
+    for (uint32_t i = first; i < first + count; i++) {
+        // normal = cross(edge1, edge2)
+        float normalX = edge1Y[i] * edge2Z[i] - edge1Z[i] * edge2Y[i];
+        float normalY = edge1Z[i] * edge2X[i] - edge1X[i] * edge2Z[i];
+        float normalZ = edge1X[i] * edge2Y[i] - edge1Y[i] * edge2X[i];
 
-        std::vector<glm::vec3> verts_tmp = {verts[i0], verts[i1], verts[i2]};
-        std::vector<glm::vec2> uvs_tmp = {uvs[i0], uvs[i1], uvs[i2]};
-        std::vector<glm::vec3> normals_tmp = {norms[i0], norms[i1], norms[i2]};
+        float aoX = origin.x - aX[i];
+        float aoY = origin.y - aY[i];
+        float aoZ = origin.z - aZ[i];
 
+        // dao = cross(ao, direction)
+        float daoX = aoY * direction.z - aoZ * direction.y;
+        float daoY = aoZ * direction.x - aoX * direction.z;
+        float daoZ = aoX * direction.y - aoY * direction.x;
 
-        triangleIntersect(ray, hit_info, verts_tmp, normals_tmp, uvs_tmp);
+        float determinant = -(direction.x * normalX + direction.y * normalY + direction.z * normalZ);
+        float invDeterminant = 1.0f / determinant;
+
+        float dst = (aoX * normalX + aoY * normalY + aoZ * normalZ) * invDeterminant;
+        float u = (edge2X[i] * daoX + edge2Y[i] * daoY + edge2Z[i] * daoZ) * invDeterminant;
+        float v = -(edge1X[i] * daoX + edge1Y[i] * daoY + edge1Z[i] * daoZ) * invDeterminant;
+        float w = 1 - u - v;
+
+        // Back faces and grazing hits are culled
+        bool hit = (determinant >= 1e-6f) & (dst >= 0) & (u >= 0) & (v >= 0) & (w >= 0) & (dst < closest.hitDist);
+        closest.hitDist = hit ? dst : closest.hitDist;
+        closest.triangle = hit ? i : closest.triangle;
+        closest.u = hit ? u : closest.u;
+        closest.v = hit ? v : closest.v;
     }
 }
 
-void MeshObject::triangleIntersect(Ray &ray, HitInfo &hit_info, std::vector<glm::vec3> triangleVerts, std::vector<glm::vec3> triangleNorms, std::vector<glm::vec2> triangleUVs) const {
-    glm::vec3 edgeAB = triangleVerts[1] - triangleVerts[0];
-    glm::vec3 edgeAC = triangleVerts[2] - triangleVerts[0];
-    glm::vec3 normal = glm::cross(edgeAB, edgeAC);
-    glm::vec3 ao = ray.origin() - triangleVerts[0];
-    glm::vec3 dao = glm::cross(ao, ray.direction());
+}
+
+void MeshObject::localIntersect(Ray &ray, HitInfo &hit_info) const {
+    if (!mesh) {
+        printf("<Mesh Object has no mesh data associated>");
+        return;
+    }
 
-    float determinant = -glm::dot(ray.direction(), normal);
-    float invDeterminant = 1.0f / determinant;
+    const TriangleStore& store = mesh->getTriangleStore();
+    const glm::vec3 origin = ray.origin();
+    const glm::vec3 direction = ray.direction();
 
-    float dst = glm::dot(ao, normal) * invDeterminant;
-    float u = glm::dot(edgeAC, dao) * invDeterminant;
-    float v = glm::dot(edgeAB, dao) * invDeterminant;
-    float w = 1 - u - v;
+    // hitDist doubles as the traversal's tMax, so every closer triangle hit
+    // shrinks the search
+    TriangleHit closest = {hit_info.hitDist, NO_TRIANGLE, 0.0f, 0.0f};
+    auto intersectLeaf = [&](uint32_t first, uint32_t count) {
+        intersectTriangles(store, first, count, origin, direction, closest);
+    };
+    switch (mesh->getBVHLayout()) {
+        case BVHLayout::Wide4:
+            mesh->getBVH4().traverse(origin, direction, closest.hitDist, intersectLeaf);
+            break;
+        case BVHLayout::Wide8:
+            mesh->getBVH8().traverse(origin, direction, closest.hitDist, intersectLeaf);
+            break;
+        default:
+            mesh->getBVH().traverse(origin, direction, closest.hitDist, intersectLeaf);
+            break;
+    }
 
-    glm::vec3 norm1 = triangleNorms[0];
-    glm::vec3 norm2 = triangleNorms[1];
-    glm::vec3 norm3 = triangleNorms[2];
+    if (closest.triangle == NO_TRIANGLE) {
+        return;
+    }
+    hit_info.hit = true;
+    hit_info.hitDist = closest.hitDist;
+    hit_info.normal = interpolateNormal(*mesh, closest.triangle, closest.u, closest.v);
+    hit_info.texCoords = interpolateTexCoords(*mesh, closest.triangle, closest.u, closest.v);
+    hit_info.materialID = getMaterialID();
+}
 
-    hit_info.hit = determinant >= 1e-6 && dst >= 0 && u >= 0 && v >= 0 && w >= 0;
-    hit_info.normal = glm::normalize(norm1 * u + norm2 * v + norm3 * w);
-    hit_info.hitDist = dst;
-    hit_info.material = getMaterial();
+HitInfo MeshObject::getTriangleHit(uint32_t triangleIndex, float hitDist, float u, float v) const {
+    HitInfo hit_info;
+    hit_info.hit = true;
+    hit_info.hitDist = hitDist;
+    hit_info.materialID = getMaterialID();
+    // Same as SceneObject::intersectWith does for the scalar hits
+    hit_info.normal = getNormalTransform() * interpolateNormal(*mesh, triangleIndex, u, v);
+    hit_info.texCoords = interpolateTexCoords(*mesh, triangleIndex, u, v);
+    return hit_info;
 }
 
+glm::vec3 MeshObject::interpolateNormal(const Mesh& mesh, uint32_t triangle, float u, float v) {
+    const uint32_t* corners = mesh.getPackedIndices().data() + 3 * triangle;
+    float w = 1 - u - v;
+    return glm::normalize(mesh.getPackedNormal(corners[0]) * w
+        + mesh.getPackedNormal(corners[1]) * u
+        + mesh.getPackedNormal(corners[2]) * v);
+}
 
+glm::vec2 MeshObject::interpolateTexCoords(const Mesh& mesh, uint32_t triangle, float u, float v) {
+    std::span<const unsigned int> texIndices = mesh.getTexIndices();
+    std::span<const glm::vec2> texCoords = mesh.getUvs();
+    if (texIndices.size() < 3 * (triangle + 1) || texCoords.empty()) {
+        return glm::vec2(0.0f);
+    }
+    float w = 1 - u - v;
+    return texCoords[texIndices[3 * triangle + 0]] * w
+        + texCoords[texIndices[3 * triangle + 1]] * u
+        + texCoords[texIndices[3 * triangle + 2]] * v;
+}
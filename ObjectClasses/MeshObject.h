@@ -8,7 +8,7 @@
 #include "Mesh.h"
 
 
-class MeshObject : public SceneObject{
+class MeshObject final : public SceneObject{
 public:
     MeshObject(
         glm::vec3 position,
@@ -22,10 +22,19 @@ public:
         scale,
         std::move(material)
     ) {
-        printf("Mesh Object with ID %llu created!", this->getObjectID());
     }
 
     void localIntersect(Ray& ray, HitInfo& hit_info) const override;
+    // World space hit for a triangle found by the packet kernels, u and v are
+    // the barycentrics computed the same way as intersectTriangles
+    [[nodiscard]] HitInfo getTriangleHit(uint32_t triangleIndex, float hitDist, float u, float v) const;
+
+    [[nodiscard]] AABB getLocalBounds() const override {
+        if (!mesh) {
+            return {};
+        }
+        return {mesh->getMin(), mesh->getMax()};
+    }
 
     void setMesh(std::shared_ptr<Mesh> meshData) {
         mesh = std::move(meshData);
@@ -37,7 +46,10 @@ public:
 private:
     std::shared_ptr<Mesh> mesh;
 
-    void triangleIntersect(Ray& ray, HitInfo& hit_info, std::vector<glm::vec3> triangleVerts, std::vector<glm::vec3> triangleNorms, std::vector<glm::vec2> triangleUVs) const;
+    // Barycentric interpolation of the decoded vertex normals and the texture
+    // coordinates, only done for the closest hit
+    static glm::vec3 interpolateNormal(const Mesh& mesh, uint32_t triangle, float u, float v);
+    static glm::vec2 interpolateTexCoords(const Mesh& mesh, uint32_t triangle, float u, float v);
 };
 
 
@@ -29,12 +29,8 @@ glm::mat4 SceneObject::createTransform(glm::vec3 position, glm::vec3 rotation, g
 void SceneObject::updateTransform() const {
     prevTransform = transform;
     prevInverseTransform = inverseTransform;
-    transform = glm::mat4(1.0f);
-    transform = glm::scale(transform, scale);
-    transform = glm::rotate(transform, glm::radians(rotation.z), glm::vec3(0, 0, 1));
-    transform = glm::rotate(transform, glm::radians(rotation.y), glm::vec3(0, 1, 0));
-    transform = glm::rotate(transform, glm::radians(rotation.x), glm::vec3(1, 0, 0));
-    transform = glm::translate(transform, position);
+    // Same T * R * S order as the constructor
+    transform = createTransform(position, rotation, scale);
     inverseTransform = glm::inverse(transform);
     buildNormalTransform();
 }
@@ -45,23 +41,7 @@ void SceneObject::buildNormalTransform() const{
 
 
 void SceneObject::intersect(Ray &ray, HitInfo &hit_info) {
-    glm::vec3 localOrigin = getInverseTransform() * glm::vec4(ray.origin(), 1.0f);
-    glm::vec3 localDirection = getInverseTransform() * glm::vec4(ray.direction(), 0.0f);
-
-    Ray localRay(localOrigin, localDirection);
-
-    HitInfo localHitInfo;
-    localHitInfo.hit = false;
-    localHitInfo.hitDist = std::numeric_limits<float>::max();
-
-    localIntersect(localRay, localHitInfo);
-    if (localHitInfo.hit && localHitInfo.hitDist < hit_info.hitDist) {
-        hit_info.hitDist = localHitInfo.hitDist;
-        hit_info.material = localHitInfo.material;
-        hit_info.normal = normalTransform * localHitInfo.normal;
-        hit_info.hit = localHitInfo.hit;
-    }
+    intersectWith(ray, hit_info, [this](Ray& localRay, HitInfo& localHitInfo) {
+        localIntersect(localRay, localHitInfo);
+    });
 }
-
-
-
@@ -11,6 +11,8 @@
 
 #include "../Material.h"
 #include "../Ray.h"
+#include "../Acceleration/BVH.h"
+#include "../Utilities/ChangeTracker.h"
 
 
 class SceneObject {
@@ -70,27 +72,68 @@ public:
     [[nodiscard]] std::shared_ptr<Material> getMaterial() const {
         return material;
     }
+    // Index of the material in the scene's MaterialTable, what hits carry
+    [[nodiscard]] uint32_t getMaterialID() const {
+        return materialID;
+    }
+    void setMaterialID(uint32_t id) {
+        materialID = id;
+    }
+
+    // Bumped by every transform setter, lets acceleration structures notice
+    // moved objects without clearing isDirty themselves
+    [[nodiscard]] uint64_t getTransformRevision() const {
+        return transformRevision;
+    }
+
+    // Setters report the object to this tracker under index, nullptr stops
+    // tracking. A copy of the object keeps reporting under the same index.
+    void track(ChangeTracker* tracker, uint32_t index) {
+        this->tracker = tracker;
+        trackedIndex = index;
+    }
 
     void setPosition(const glm::vec3 position) {
         this->position = position;
         isDirty = true;
+        transformRevision++;
+        markChanged();
     }
     void setScale(const glm::vec3 scale) {
         this->scale = scale;
         isDirty = true;
+        transformRevision++;
+        markChanged();
     }
     void setRotation(const glm::vec3 rotation) {
         this->rotation = rotation;
         isDirty = true;
+        transformRevision++;
+        markChanged();
     }
 
     void intersect(Ray& ray, HitInfo& hit_info);
+    // Same as intersect, for callers that know the concrete type: localIntersect
+    // is then called directly instead of through the vtable
+    template<typename Object>
+    void intersectAs(Ray& ray, HitInfo& hit_info) {
+        intersectWith(ray, hit_info, [this](Ray& localRay, HitInfo& localHitInfo) {
+            static_cast<const Object*>(this)->Object::localIntersect(localRay, localHitInfo);
+        });
+    }
     virtual void localIntersect(Ray& ray, HitInfo& hit_info) const = 0;
+
+    // Bounds of the object in its own space, before the transform
+    [[nodiscard]] virtual AABB getLocalBounds() const = 0;
+    [[nodiscard]] AABB getWorldBounds() {
+        return getLocalBounds().transformed(getTransform());
+    }
 private:
     static uint64_t nextID;
     const uint64_t objectID;
 
     std::shared_ptr<Material> material;
+    uint32_t materialID = 0;
     glm::vec3 position;
     glm::vec3 rotation;
     glm::vec3 scale;
@@ -101,6 +144,15 @@ private:
     mutable glm::mat4 prevTransform;
     mutable glm::mat4 prevInverseTransform;
     mutable bool isDirty = false;
+    uint64_t transformRevision = 0;
+    ChangeTracker* tracker = nullptr;
+    uint32_t trackedIndex = 0;
+
+    void markChanged() {
+        if (tracker) {
+            tracker->mark(trackedIndex);
+        }
+    }
 
     void updateTransform() const;
 
@@ -108,6 +160,29 @@ private:
 
     void buildNormalTransform() const;
 
+    template<typename LocalIntersect>
+    void intersectWith(Ray& ray, HitInfo& hit_info, LocalIntersect&& intersectLocal) {
+        glm::vec3 localOrigin = getInverseTransform() * glm::vec4(ray.origin(), 1.0f);
+        glm::vec3 localDirection = getInverseTransform() * glm::vec4(ray.direction(), 0.0f);
+
+        Ray localRay(localOrigin, localDirection);
+
+        // t is the same in both spaces since the direction isn't renormalized, so
+        // the closest hit so far can cull the local search
+        HitInfo localHitInfo;
+        localHitInfo.hit = false;
+        localHitInfo.hitDist = hit_info.hitDist;
+
+        intersectLocal(localRay, localHitInfo);
+        if (localHitInfo.hit && localHitInfo.hitDist < hit_info.hitDist) {
+            hit_info.hitDist = localHitInfo.hitDist;
+            hit_info.materialID = localHitInfo.materialID;
+            hit_info.normal = normalTransform * localHitInfo.normal;
+            hit_info.texCoords = localHitInfo.texCoords;
+            hit_info.hit = localHitInfo.hit;
+        }
+    }
+
 protected:
 
     SceneObject(
@@ -126,7 +201,7 @@ protected:
         prevTransform(transform),
         prevInverseTransform(glm::inverse(transform))
     {
-        // Empty Constructor
+        buildNormalTransform();
     }
 
     SceneObject(
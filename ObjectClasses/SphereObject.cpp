@@ -14,7 +14,7 @@ void SphereObject::localIntersect(Ray &ray, HitInfo &hit_info) const {
         glm::vec3 normal = ray.at(t) - getPosition();
         if (t > 0.0f && t < hit_info.hitDist) {
             hit_info.hitDist = t;
-            hit_info.material = getMaterial();
+            hit_info.materialID = getMaterialID();
             hit_info.hit = true;
             hit_info.normal = glm::normalize(normal);
         }
@@ -10,7 +10,7 @@
 #include "../Material.h"
 
 
-class SphereObject : public SceneObject {
+class SphereObject final : public SceneObject {
 public:
 
     SphereObject(
@@ -26,7 +26,6 @@ public:
             std::move(material)
         ),
         radius(radius) {
-        printf("Sphere with ID %llu created!", this->getObjectID());
     }
 
     [[nodiscard]] float getRadius() const {
@@ -35,6 +34,10 @@ public:
 
     void localIntersect(Ray &ray, HitInfo &hit_info) const override;
 
+    [[nodiscard]] AABB getLocalBounds() const override {
+        return {glm::vec3(-radius), glm::vec3(radius)};
+    }
+
 private:
     float radius;
 };
@@ -0,0 +1,155 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#include "ProgramCache.h"
+
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr uint32_t MAGIC = 0x42475250; // "PRGB"
+
+struct CacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t binaryFormat;
+    uint32_t binaryLength;
+};
+
+uint64_t hashBytes(uint64_t hash, std::string_view bytes) {
+    for (unsigned char byte : bytes) {
+        hash = (hash ^ byte) * 0x100000001b3ull;
+    }
+    // Separates consecutive strings, "ab" + "c" and "a" + "bc" differ
+    return (hash ^ 0xff) * 0x100000001b3ull;
+}
+
+std::string_view glString(GLenum name) {
+    const GLubyte* value = glGetString(name);
+    return value ? std::string_view((const char*)value) : std::string_view();
+}
+
+}
+
+void ProgramCache::enableParallelCompile() {
+    if (GLAD_GL_KHR_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+    }
+    else if (GLAD_GL_ARB_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+    }
+}
+
+bool ProgramCache::parallelCompileSupported() {
+    return GLAD_GL_KHR_parallel_shader_compile || GLAD_GL_ARB_parallel_shader_compile;
+}
+
+uint64_t ProgramCache::key(std::initializer_list<std::string_view> sources, std::string_view defines) {
+    // The driver only changes between runs, hashed once
+    static const uint64_t driverHash = [] {
+        uint64_t hash = 0xcbf29ce484222325ull ^ VERSION;
+        for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+            hash = hashBytes(hash, glString(name));
+        }
+        return hash;
+    }();
+
+    uint64_t hash = hashBytes(driverHash, defines);
+    for (std::string_view source : sources) {
+        hash = hashBytes(hash, source);
+    }
+    return hash;
+}
+
+std::string ProgramCache::cachePath(uint64_t key) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+    return (fs::path(DIRECTORY) / name).string();
+}
+
+GLuint ProgramCache::load(uint64_t key) {
+    std::ifstream stream(cachePath(key), std::ios::binary);
+    if (!stream) {
+        return 0;
+    }
+    CacheHeader header{};
+    stream.read((char*)&header, sizeof(header));
+    if (!stream || header.magic != MAGIC || header.version != VERSION || header.key != key) {
+        return 0;
+    }
+    std::vector<char> binary(header.binaryLength);
+    stream.read(binary.data(), (std::streamsize)binary.size());
+    if (!stream) {
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, (GLenum)header.binaryFormat, binary.data(), (GLsizei)binary.size());
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        // Stale for this driver in a way the key didn't catch, rebuilt and
+        // overwritten by the caller
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+void ProgramCache::prepare(GLuint program) {
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+bool ProgramCache::store(uint64_t key, GLuint program) {
+    GLint formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (formatCount <= 0 || length <= 0) {
+        return false;
+    }
+    std::vector<char> binary(length);
+    GLenum binaryFormat = 0;
+    glGetProgramBinary(program, length, &length, &binaryFormat, binary.data());
+    if (length <= 0) {
+        return false;
+    }
+
+    std::error_code error;
+    fs::create_directories(DIRECTORY, error);
+    const std::string path = cachePath(key);
+    // Written under a temporary name and renamed, like mesh caches, so a
+    // second instance starting at the same time never reads half a file
+    static std::atomic<uint64_t> saveCount = 0;
+    const std::string temporaryPath = path + ".tmp" + std::to_string(
+        std::hash<std::thread::id>()(std::this_thread::get_id()) ^ saveCount++);
+    {
+        std::ofstream stream(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!stream) {
+            return false;
+        }
+        const CacheHeader header{MAGIC, VERSION, key, (uint32_t)binaryFormat, (uint32_t)length};
+        stream.write((const char*)&header, sizeof(header));
+        stream.write(binary.data(), length);
+        if (!stream) {
+            stream.close();
+            fs::remove(temporaryPath, error);
+            return false;
+        }
+    }
+    fs::rename(temporaryPath, path, error);
+    if (error) {
+        fs::remove(temporaryPath, error);
+        return false;
+    }
+    return true;
+}
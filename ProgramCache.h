@@ -0,0 +1,46 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#ifndef PROGRAMCACHE_H
+#define PROGRAMCACHE_H
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <glad/glad.h>
+
+// Linked programs saved with glGetProgramBinary under DIRECTORY, one file
+// per program named after its key. The key hashes the shader sources, the
+// defines they are compiled with and the GL vendor, renderer and version,
+// so a driver update or a shader edit just misses and recompiles.
+//
+// Cold programs link in the background when the driver has
+// KHR/ARB_parallel_shader_compile: shaders start compiling when created and
+// are only waited for at their first use, so all of them build together.
+class ProgramCache {
+public:
+    // Bumped whenever the file layout changes
+    static constexpr uint32_t VERSION = 1;
+    static constexpr const char* DIRECTORY = "ShaderCache";
+
+    // Lets the driver use as many compiler threads as it likes. Call once
+    // the context is current.
+    static void enableParallelCompile();
+    [[nodiscard]] static bool parallelCompileSupported();
+
+    [[nodiscard]] static uint64_t key(std::initializer_list<std::string_view> sources, std::string_view defines);
+
+    // A linked program from the binary cached under key, or 0 when there is
+    // none or the driver rejects it. Never throws.
+    [[nodiscard]] static GLuint load(uint64_t key);
+    // Call before glLinkProgram on programs that will be stored
+    static void prepare(GLuint program);
+    // Returns false when the binary can't be read back or written, which
+    // isn't an error
+    static bool store(uint64_t key, GLuint program);
+
+    [[nodiscard]] static std::string cachePath(uint64_t key);
+};
+
+#endif //PROGRAMCACHE_H
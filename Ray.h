@@ -5,20 +5,25 @@
 #ifndef RAY_H
 #define RAY_H
 #include <float.h>
+#include <cstdint>
+#include <type_traits>
 #include <glm/glm.hpp>
-#include <memory>
 
 #include "Material.h"
 
+// Plain data so that the intersection code can copy hits around freely. The
+// material is an index into the scene's MaterialTable.
 struct HitInfo {
-    bool hit;
-    float hitDist;
-    glm::vec3 hitPosition;
-    glm::vec3 normal;
-    glm::vec2 texCoords;
-    std::shared_ptr<Material> material;
+    bool hit = false;
+    float hitDist = FLT_MAX;
+    glm::vec3 hitPosition = glm::vec3(0.0f);
+    glm::vec3 normal = glm::vec3(0.0f);
+    glm::vec2 texCoords = glm::vec2(0.0f);
+    uint32_t materialID = 0;
 };
 
+static_assert(std::is_trivially_copyable_v<HitInfo>);
+
 class Ray {
     public:
         Ray(glm::vec3 origin, glm::vec3 direction) : orig(origin), dir(direction) {};
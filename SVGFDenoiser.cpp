@@ -126,11 +126,9 @@ void SVGFDenoiser::initializeMoments(int writeIndex) {
     glDispatchCompute(ceil(width / 16.0), ceil(height / 16.0), 1);
 }
 
-void SVGFDenoiser::accumulationPass(int currentFrameIndex, int historyFrameIndex, int frameCnt) {
+void SVGFDenoiser::accumulationPass(int currentFrameIndex, int historyFrameIndex) {
     accumulationPassShader.use();
 
-    accumulationPassShader.setInt("FrameCount", frameCnt);
-
     // C_i
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, noisyColorTexture);
@@ -40,7 +40,7 @@ public:
     void copyNoisyToHistory(int writeIndex);
     void initializeMoments(int writeIndex);
 
-    void accumulationPass(int currentFrameIndex, int historyFrameIndex, int frameCnt);
+    void accumulationPass(int currentFrameIndex, int historyFrameIndex);
 
     void varianceEstimatePass(int currentFrameIndex);
     void atrousFilterPass(int& currentFrameIndex, int& historyFrameIndex);
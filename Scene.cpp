@@ -3,8 +3,11 @@
 //
 
 #include "Scene.h"
+#include <algorithm>
+#include <chrono>
 #include <random>
 #include <iostream>
+#include <thread>
 
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -84,74 +87,492 @@ glm::vec3 colorPixel(Ray ray) {
     return (1.0f - a) * glm::vec3(1.0f, 1.0f, 1.0f) + a * glm::vec3(0.5f, 0.7f, 1.0f);
 }
 
-glm::vec3 generateRandomOffset() {
-    glm::vec3 offset;
-    float x = (float) std::rand() / (float) (RAND_MAX + 1.0f);
-    float y = (float) std::rand() / (float) (RAND_MAX + 1.0f);
-    offset = glm::vec3(x - 0.5f, y - 0.5f, 0);
-    return offset;
+// Running mean and variance of a pixel's samples (Welford), per channel
+struct PixelEstimate {
+    glm::vec3 mean = glm::vec3(0.0f);
+    glm::vec3 m2 = glm::vec3(0.0f);
+    // Mean of the first halfSamples samples
+    glm::vec3 halfMean = glm::vec3(0.0f);
+    int samples = 0;
+
+    void add(const glm::vec3& color, int halfSamples) {
+        if (samples == halfSamples) {
+            halfMean = mean;
+        }
+        samples++;
+        glm::vec3 delta = color - mean;
+        mean += delta / (float)samples;
+        m2 += delta * (color - mean);
+    }
+
+    // Estimated error of the mean, worst channel. The sample variance gives
+    // a confidence interval for independent samples but overstates the error
+    // of a low discrepancy estimate, which converges faster. There the first
+    // half of the samples is compared with all of them instead.
+    [[nodiscard]] float errorBound(bool lowDiscrepancy) const {
+        if (samples < 2) {
+            return std::numeric_limits<float>::max();
+        }
+        glm::vec3 error;
+        if (lowDiscrepancy) {
+            error = glm::abs(mean - halfMean);
+        }
+        else {
+            // Half width of the 95% confidence interval
+            error = 1.96f * glm::vec3(std::sqrt(m2.x), std::sqrt(m2.y), std::sqrt(m2.z))
+                / std::sqrt((float)(samples - 1) * (float)samples);
+        }
+        return std::max(error.x, std::max(error.y, error.z));
+    }
+};
+
+// Inverse of the Morton interleave, keeps every other bit of v
+static uint32_t compactBits(uint32_t v) {
+    v &= 0x55555555;
+    v = (v | (v >> 1)) & 0x33333333;
+    v = (v | (v >> 2)) & 0x0F0F0F0F;
+    v = (v | (v >> 4)) & 0x00FF00FF;
+    v = (v | (v >> 8)) & 0x0000FFFF;
+    return v;
 }
 
+// Pixel offsets of a tileSize x tileSize tile, in Morton (Z-curve) order
+static std::vector<glm::ivec2> buildMortonOrder(int tileSize) {
+    int side = 1;
+    while (side < tileSize) {
+        side <<= 1;
+    }
 
-std::vector<glm::vec3> Scene::renderTest() {
-    std::vector<glm::vec3> result;
-    int width = 1920;//camera->get_image_width();
-    int height = 1080;//camera->get_image_height();
-    for (int y = 0; y < height; y++) {
-        std::cout << "Scanline: " << y << std::endl;
-        for (int x = 0; x < width; x++) {
-            glm::vec3 avgColor(0, 0, 0);
-            for (int rpp = 0; rpp < ray_per_pixel; rpp++) {
-                // Get ray orig and dir
-                // Use a random offset for antialiasing
-                glm::vec2 offset = glm::vec2(generateRandomOffset().x, generateRandomOffset().y);
+    std::vector<glm::ivec2> order;
+    order.reserve(tileSize * tileSize);
+    for (uint32_t code = 0; code < (uint32_t)(side * side); code++) {
+        int x = (int)compactBits(code);
+        int y = (int)compactBits(code >> 1);
+        if (x < tileSize && y < tileSize) {
+            order.emplace_back(x, y);
+        }
+    }
+    return order;
+}
 
-                glm::vec2 screenPos01 = (glm::vec2(x, y) + offset) / glm::vec2(width, height);
+void Scene::prepareForRender() {
+    // Transforms are lazily rebuilt by their getters, do it once here so the
+    // workers only ever read them
+    for (auto& sphere : spheres) {
+        (void)sphere.getTransform();
+    }
+    for (auto& mesh : meshes) {
+        (void)mesh.getTransform();
+    }
+    updateAccelerationStructure();
+    updateMaterialTable();
+}
 
-                glm::vec4 clipPos = glm::vec4(screenPos01 * 2.f - 1.f, 1.f, 1.f);
-                glm::vec4 viewPos = camera->getInverseProjection() * glm::vec4(clipPos.x, clipPos.y, -1, 1);
+void Scene::updateMaterialTable() {
+    materials.clear();
+    for (size_t i = 0; i < spheres.size() + meshes.size(); i++) {
+        SceneObject& object = getInstance(i);
+        object.setMaterialID(materials.getID(object.getMaterial()));
+    }
+}
 
-                viewPos.x /= viewPos.w;
-                viewPos.y /= viewPos.w;
-                viewPos.z /= viewPos.w;
+void Scene::updateAccelerationStructure() {
+    const size_t instanceCount = spheres.size() + meshes.size();
+    const bool resized = instanceBounds.size() != instanceCount;
+    if (resized) {
+        instanceBounds.resize(instanceCount);
+        instanceRevisions.assign(instanceCount, UINT64_MAX);
+    }
 
-                glm::vec3 viewDirWorld = glm::vec3(camera->getInverseView() * viewPos);
+    // Only the objects that moved since the last update get new bounds
+    bool moved = false;
+    for (size_t i = 0; i < instanceCount; i++) {
+        SceneObject& object = getInstance(i);
+        uint64_t revision = object.getTransformRevision();
+        if (revision != instanceRevisions[i]) {
+            instanceRevisions[i] = revision;
+            instanceBounds[i] = object.getWorldBounds();
+            moved = true;
+        }
+    }
 
-                glm::vec3 rayDir = glm::normalize(viewDirWorld - camera->getPos());
+    if (resized || moved) {
+        accelerationStructure.update(instanceBounds);
+    }
+}
 
-                // The ray's origin is the camera's world-space position
-                glm::vec3 rayOrig = camera->getPos();;
+void Scene::setBVHLayout(BVHLayout layout) {
+    for (auto& mesh : meshes) {
+        if (mesh.getMesh()) {
+            mesh.getMesh()->setBVHLayout(layout);
+        }
+    }
+}
 
-                rayDir = glm::normalize(rayDir);
-                Ray ray(rayOrig, rayDir);
+SceneObject& Scene::getInstance(size_t index) {
+    if (index < spheres.size()) {
+        return spheres[index];
+    }
+    return meshes[index - spheres.size()];
+}
 
-                avgColor += trace(ray);
+PacketScene Scene::buildPacketScene() {
+    const size_t instanceCount = spheres.size() + meshes.size();
+    packetInstances.resize(instanceCount);
+    for (size_t i = 0; i < instanceCount; i++) {
+        PacketInstance& instance = packetInstances[i];
+        const glm::mat4 inverse = getInstance(i).getInverseTransform();
+        for (int row = 0; row < 3; row++) {
+            for (int column = 0; column < 4; column++) {
+                instance.inverseTransform[row * 4 + column] = inverse[column][row];
             }
-            avgColor /= ray_per_pixel;
-            avgColor = glm::clamp(avgColor, 0.0f, 1.0f);
+        }
 
-            result.push_back(avgColor);
+        if (i < spheres.size()) {
+            instance.isMesh = false;
+            instance.radius = spheres[i].getRadius();
+            instance.nodes = nullptr;
+            instance.triangles = nullptr;
+            instance.triangleCount = 0;
+        }
+        else {
+            std::shared_ptr<Mesh> mesh = meshes[i - spheres.size()].getMesh();
+            const bool hasBVH = mesh && !mesh->getBVH().isEmpty();
+            instance.isMesh = true;
+            instance.nodes = hasBVH ? mesh->getBVH().getNodes().data() : nullptr;
+            instance.triangles = hasBVH ? mesh->getTriangleStore().getData() : nullptr;
+            instance.triangleCount = hasBVH ? (uint32_t)mesh->getTriangleStore().size() : 0;
         }
     }
+
+    PacketScene packetScene;
+    packetScene.tlasNodes = accelerationStructure.getBVH().getNodes().data();
+    packetScene.tlasInstances = accelerationStructure.getBVH().getPrimitiveIndices().data();
+    packetScene.instances = packetInstances.data();
+    return packetScene;
+}
+
+HitInfo Scene::getPacketHit(const RayPacket& packet, int lane, Ray& ray) {
+    HitInfo hit;
+    hit.hit = false;
+    hit.hitDist = std::numeric_limits<float>::max();
+    if (packet.instance[lane] < 0) {
+        return hit;
+    }
+
+    const size_t instance = packet.instance[lane];
+    if (instance < spheres.size()) {
+        // Intersecting the one sphere again is cheaper than carrying its
+        // normal out of the kernel
+        spheres[instance].intersectAs<SphereObject>(ray, hit);
+        return hit;
+    }
+    return meshes[instance - spheres.size()].getTriangleHit(packet.primitive[lane], packet.tMax[lane], packet.u[lane], packet.v[lane]);
+}
+
+std::vector<glm::vec3> Scene::render(const RenderSettings& settings) {
+    const int width = settings.width;
+    const int height = settings.height;
+    const int tileSize = std::max(settings.tileSize, 1);
+
+    std::vector<glm::vec3> result(width * height, glm::vec3(0.0f));
+
+    unsigned int threadCount = settings.threadCount == 0 ? ThreadPool::defaultThreadCount() : settings.threadCount;
+    if (!threadPool || threadPool->size() != threadCount) {
+        threadPool = std::make_unique<ThreadPool>(threadCount);
+    }
+
+    prepareForRender();
+
+    const int maxBounces = settings.maxBounces > 0 ? settings.maxBounces : max_ray_bounce;
+    const int samplesPerPixel = settings.samplesPerPixel > 0 ? settings.samplesPerPixel : ray_per_pixel;
+    const bool adaptive = settings.adaptiveMaxSamples > samplesPerPixel;
+
+    // The first pass takes samplesPerPixel samples for every pixel, every
+    // adaptive pass doubles the samples of the pixels still active
+    std::vector<PixelEstimate> estimates((size_t)width * height);
+    std::vector<uint8_t> active((size_t)width * height, 1);
+    int passSamples = samplesPerPixel;
+    int halfSamples = samplesPerPixel / 2;
+
+    // Packets need a non empty top level BVH, the scalar path handles the rest
+    SimdLevel simdLevel = resolveSimdLevel(settings.packetSimd);
+    if (accelerationStructure.getBVH().isEmpty() || maxBounces <= 0) {
+        simdLevel = SimdLevel::Scalar;
+    }
+    const int packetWidth = simdLevelWidth(simdLevel);
+    PacketScene packetScene;
+    if (simdLevel != SimdLevel::Scalar) {
+        packetScene = buildPacketScene();
+    }
+
+    // The camera also rebuilds its matrices lazily, take a copy for the workers
+    const glm::mat4 inverseProjection = camera->getInverseProjection();
+    const glm::mat4 cameraToWorld = camera->getInverseView();
+    const glm::vec3 cameraPos = camera->getPos();
+
+    const int tilesX = (width + tileSize - 1) / tileSize;
+    const int tilesY = (height + tileSize - 1) / tileSize;
+    const int tileCount = tilesX * tilesY;
+    const std::vector<glm::ivec2> mortonOrder = buildMortonOrder(tileSize);
+
+    // One counter per worker, padded so workers don't share cache lines
+    struct alignas(64) WorkerCounters {
+        uint64_t rays = 0;
+        uint64_t samples = 0;
+    };
+    std::vector<WorkerCounters> counters(threadCount);
+
+    std::atomic<int> tilesDone = 0;
+    int tilesRendered = 0;
+    std::mutex progressMutex;
+
+    auto cancelled = [&settings]() {
+        return settings.cancel && settings.cancel->load(std::memory_order_relaxed);
+    };
+
+    auto start = std::chrono::steady_clock::now();
+
+    auto renderPass = [&](size_t tileIndex, unsigned int workerIndex) {
+        if (cancelled()) {
+            return;
+        }
+
+        const int tileX = (int)(tileIndex % tilesX) * tileSize;
+        const int tileY = (int)(tileIndex / tilesX) * tileSize;
+        WorkerCounters& counter = counters[workerIndex];
+
+        SobolSampler sobolSampler(settings.seed);
+        IndependentSampler independentSampler(settings.seed);
+        Sampler& sampler = settings.sampler == SamplerType::Sobol ? (Sampler&)sobolSampler : independentSampler;
+
+        // Dimensions 0 and 1 of every pixel sample jitter the primary ray for antialiasing
+        auto primaryRay = [&](int x, int y, int sampleIndex) {
+            sampler.startPixelSample(glm::ivec2(x, y), sampleIndex);
+            glm::vec2 offset = sampler.next2D() - 0.5f;
+
+            glm::vec2 screenPos01 = (glm::vec2(x, y) + offset) / glm::vec2(width, height);
+
+            glm::vec4 clipPos = glm::vec4(screenPos01 * 2.f - 1.f, 1.f, 1.f);
+            glm::vec4 viewPos = inverseProjection * glm::vec4(clipPos.x, clipPos.y, -1, 1);
+
+            viewPos.x /= viewPos.w;
+            viewPos.y /= viewPos.w;
+            viewPos.z /= viewPos.w;
+            viewPos.w = 1.0f;
+
+            glm::vec3 viewDirWorld = glm::vec3(cameraToWorld * viewPos);
+
+            // The ray's origin is the camera's world-space position
+            return Ray(cameraPos, glm::normalize(viewDirWorld - cameraPos));
+        };
+
+        if (simdLevel == SimdLevel::Scalar) {
+            for (const glm::ivec2& local : mortonOrder) {
+                const int x = tileX + local.x;
+                const int y = tileY + local.y;
+                if (x >= width || y >= height || !active[y * width + x]) {
+                    continue;
+                }
+                if (cancelled()) {
+                    return;
+                }
+
+                PixelEstimate& estimate = estimates[y * width + x];
+                for (int i = 0; i < passSamples; i++) {
+                    Ray ray = primaryRay(x, y, estimate.samples);
+                    estimate.add(tracePath(ray, sampler, maxBounces, counter.rays), halfSamples);
+                }
+                counter.samples += passSamples;
+            }
+        }
+        else {
+            // Consecutive Morton pixels form 4x2 (8 wide) or 4x4 (16 wide)
+            // blocks, the most coherent packets a tile can give. Later
+            // adaptive passes skip the converged pixels and fill the packets
+            // with the next active ones.
+            size_t next = 0;
+            while (next < mortonOrder.size()) {
+                if (cancelled()) {
+                    return;
+                }
+
+                glm::ivec2 pixels[MAX_PACKET_WIDTH];
+                int pixelCount = 0;
+                for (; next < mortonOrder.size() && pixelCount < packetWidth; next++) {
+                    const int x = tileX + mortonOrder[next].x;
+                    const int y = tileY + mortonOrder[next].y;
+                    if (x < width && y < height && active[y * width + x]) {
+                        pixels[pixelCount++] = glm::ivec2(x, y);
+                    }
+                }
+                if (pixelCount == 0) {
+                    continue;
+                }
+
+                for (int i = 0; i < passSamples; i++) {
+                    RayPacket packet;
+                    for (int lane = 0; lane < packetWidth; lane++) {
+                        // Unused lanes repeat the first ray so they stay finite
+                        Ray ray = lane < pixelCount
+                            ? primaryRay(pixels[lane].x, pixels[lane].y, estimates[pixels[lane].y * width + pixels[lane].x].samples)
+                            : Ray(glm::vec3(packet.originX[0], packet.originY[0], packet.originZ[0]),
+                                glm::vec3(packet.directionX[0], packet.directionY[0], packet.directionZ[0]));
+                        packet.originX[lane] = ray.origin().x;
+                        packet.originY[lane] = ray.origin().y;
+                        packet.originZ[lane] = ray.origin().z;
+                        packet.directionX[lane] = ray.direction().x;
+                        packet.directionY[lane] = ray.direction().y;
+                        packet.directionZ[lane] = ray.direction().z;
+                        packet.tMax[lane] = std::numeric_limits<float>::max();
+                    }
+                    packet.activeMask = (1u << pixelCount) - 1;
+
+                    intersectPacket(simdLevel, packetScene, packet);
+                    counter.rays += pixelCount;
+
+                    for (int lane = 0; lane < pixelCount; lane++) {
+                        Ray ray(glm::vec3(packet.originX[lane], packet.originY[lane], packet.originZ[lane]),
+                            glm::vec3(packet.directionX[lane], packet.directionY[lane], packet.directionZ[lane]));
+                        HitInfo hit = getPacketHit(packet, lane, ray);
+                        PixelEstimate& estimate = estimates[pixels[lane].y * width + pixels[lane].x];
+                        // Same random numbers as the scalar path, the jitter used dimensions 0 and 1
+                        sampler.startPixelSample(pixels[lane], estimate.samples, 2);
+                        estimate.add(shadePath(ray, hit, sampler, maxBounces, counter.rays), halfSamples);
+                    }
+                }
+                counter.samples += (uint64_t)passSamples * pixelCount;
+            }
+        }
+
+        int done = ++tilesDone;
+        if (settings.onProgress) {
+            std::lock_guard<std::mutex> lock(progressMutex);
+            settings.onProgress(done, tileCount);
+        }
+    };
+
+    threadPool->parallelFor(tileCount, renderPass);
+    tilesRendered = tilesDone;
+
+    // A pixel keeps sampling while the error of any pixel in its 3x3
+    // neighbourhood is above the target. A pixel whose few samples all missed
+    // a small light looks converged on its own, its neighbours usually don't.
+    // Converged pixels stay converged, so the active ones always share a
+    // sample count. Every decision only depends on the samples, the image is
+    // the same for any thread count.
+    const bool lowDiscrepancy = settings.sampler == SamplerType::Sobol;
+    std::vector<float> errors((size_t)width * height);
+    int activeSamples = samplesPerPixel;
+    while (adaptive && !cancelled() && activeSamples * 2 <= settings.adaptiveMaxSamples) {
+        for (size_t i = 0; i < estimates.size(); i++) {
+            errors[i] = estimates[i].errorBound(lowDiscrepancy);
+        }
+        bool anyActive = false;
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                if (!active[y * width + x]) {
+                    continue;
+                }
+                float error = 0.0f;
+                for (int ny = std::max(y - 1, 0); ny <= std::min(y + 1, height - 1); ny++) {
+                    for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, width - 1); nx++) {
+                        error = std::max(error, errors[ny * width + nx]);
+                    }
+                }
+                active[y * width + x] = error > settings.adaptiveError;
+                anyActive |= error > settings.adaptiveError;
+            }
+        }
+        if (!anyActive) {
+            break;
+        }
+
+        passSamples = activeSamples;
+        halfSamples = activeSamples;
+        activeSamples *= 2;
+        tilesDone = 0;
+        threadPool->parallelFor(tileCount, renderPass);
+    }
+
+    sampleCounts.resize(estimates.size());
+    for (size_t i = 0; i < estimates.size(); i++) {
+        const PixelEstimate& estimate = estimates[i];
+        sampleCounts[i] = estimate.samples;
+        if (estimate.samples > 0) {
+            result[i] = glm::clamp(estimate.mean, 0.0f, 1.0f);
+        }
+    }
+
+
+    auto end = std::chrono::steady_clock::now();
+
+    lastRenderStats = RenderStats();
+    lastRenderStats.seconds = std::chrono::duration<double>(end - start).count();
+    lastRenderStats.tilesRendered = tilesRendered;
+    lastRenderStats.threadCount = threadCount;
+    lastRenderStats.simdLevel = simdLevel;
+    lastRenderStats.cancelled = cancelled();
+    for (const auto& counter : counters) {
+        lastRenderStats.rays += counter.rays;
+        lastRenderStats.samples += counter.samples;
+    }
+
     return result;
 }
 
+std::vector<glm::vec3> Scene::getSampleCountImage() const {
+    const int maxCount = sampleCounts.empty() ? 0 : *std::max_element(sampleCounts.begin(), sampleCounts.end());
+    std::vector<glm::vec3> image(sampleCounts.size(), glm::vec3(0.0f));
+    for (size_t i = 0; i < sampleCounts.size() && maxCount > 0; i++) {
+        image[i] = glm::vec3((float)sampleCounts[i] / (float)maxCount);
+    }
+    return image;
+}
+
 glm::vec3 Scene::trace(Ray& ray) {
+    uint64_t rayCount = 0;
+    return trace(ray, rayCount);
+}
+
+glm::vec3 Scene::trace(Ray& ray, uint64_t& rayCount) {
+    // Single rays from outside a render get a fresh sample each call
+    thread_local IndependentSampler sampler((uint32_t)std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    thread_local uint32_t sampleIndex = 0;
+    sampler.startPixelSample(glm::ivec2(0, 0), sampleIndex++);
+    return tracePath(ray, sampler, max_ray_bounce, rayCount);
+}
+
+glm::vec3 Scene::tracePath(Ray& ray, Sampler& sampler, int maxBounces, uint64_t& rayCount) {
+    if (maxBounces <= 0) {
+        return glm::vec3(0, 0, 0);
+    }
+    HitInfo hit = intersectScene(ray);
+    rayCount++;
+    return shadePath(ray, hit, sampler, maxBounces, rayCount);
+}
+
+glm::vec3 Scene::shadePath(Ray& ray, HitInfo hit, Sampler& sampler, int maxBounces, uint64_t& rayCount) {
     glm::vec3 finalColor = glm::vec3(0, 0, 0);
     glm::vec3 rayColor = glm::vec3(1.0f, 1.0f, 1.0f);
-    for (int mrb = 0 ; mrb < max_ray_bounce; mrb++) {
-        HitInfo hit = intersectScene(ray);
+    for (int mrb = 0 ; mrb < maxBounces; mrb++) {
+        // The first hit comes from the caller
+        if (mrb > 0) {
+            hit = intersectScene(ray);
+            rayCount++;
+        }
         if (!hit.hit) {
             //finalColor += colorPixel(ray) * rayColor;
             break;
         }
         glm::vec3 newPos = ray.at(hit.hitDist) + (float)0.000001 * hit.normal;
-        glm::vec3 newDir = glm::normalize(hit.normal + random_unit_vector());
+        glm::vec3 newDir = sampleCosineHemisphere(glm::normalize(hit.normal), sampler.next2D());
 
-        glm::vec3 emittedLight = hit.material->getEmissionColor() * hit.material->getEmissionStrength();
+        const Material& material = materials[hit.materialID];
+        glm::vec3 emittedLight = material.getEmissionColor() * material.getEmissionStrength();
         //float lightStrength = glm::dot(hit.normal, ray.direction());
         finalColor += emittedLight * rayColor;
-        rayColor *= hit.material->getColor();
+        rayColor *= material.getColor();
         ray.setDirection(newDir);
         ray.setOrigin(newPos);
     }
@@ -162,12 +583,23 @@ HitInfo Scene::intersectScene(Ray& ray) {
     HitInfo bestHit;
     bestHit.hit = false;
     bestHit.hitDist = std::numeric_limits<float>::max();
-    for (auto& sphere : spheres) {
-        sphere.intersect(ray, bestHit);
-    }
-    for (auto& mesh : meshes) {
-        mesh.intersect(ray, bestHit);
-    }
+
+    const size_t sphereCount = spheres.size();
+    std::span<const uint32_t> instances = accelerationStructure.getBVH().getPrimitiveIndices();
+
+    // The world space ray only goes into the local space of the objects whose
+    // world bounds it hits
+    accelerationStructure.getBVH().traverse(ray.origin(), ray.direction(), bestHit.hitDist, [&](uint32_t first, uint32_t count) {
+        for (uint32_t i = first; i < first + count; i++) {
+            uint32_t instance = instances[i];
+            if (instance < sphereCount) {
+                spheres[instance].intersectAs<SphereObject>(ray, bestHit);
+            }
+            else {
+                meshes[instance - sphereCount].intersectAs<MeshObject>(ray, bestHit);
+            }
+        }
+    });
     return bestHit;
 }
 
@@ -4,6 +4,9 @@
 
 #ifndef SCENE_H
 #define SCENE_H
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <vector>
 #include <memory>
 
@@ -12,18 +15,79 @@
 #include "ObjectClasses/SphereObject.h"
 #include "ObjectClasses/SceneObjects.h"
 #include "Utilities/RandomUtilities.cpp"
+#include "Utilities/ThreadPool.h"
+#include "Utilities/Sampler.h"
+#include "Acceleration/TopLevelBVH.h"
+#include "Acceleration/RayPacket.h"
 // #include "Light.h"
 
+struct RenderSettings {
+    int width = 1920;
+    int height = 1080;
+    int tileSize = 32;
+    // 0 uses every hardware thread
+    unsigned int threadCount = 0;
+    // Called after each finished tile, and again for every adaptive pass.
+    // Calls are serialized, but they come from the worker threads
+    std::function<void(int tilesDone, int tileCount)> onProgress;
+    // Polled for every pixel, set it from another thread to stop the render early
+    const std::atomic<bool>* cancel = nullptr;
+    // Traces the primary rays in packets of 8 (AVX2) or 16 (AVX-512) rays,
+    // lowered to what the CPU supports. Bounces are incoherent and always go
+    // through the scalar path.
+    SimdLevel packetSimd = SimdLevel::Scalar;
+    // 0 keeps the scene's max_ray_bounce, 1 only traces primary rays
+    int maxBounces = 0;
+    // 0 keeps the scene's ray_per_pixel
+    int samplesPerPixel = 0;
+    // The image only depends on the sampler and the seed, not on the thread
+    // count, the tile size or the SIMD level
+    SamplerType sampler = SamplerType::Sobol;
+    uint32_t seed = 0;
+    // Adaptive sampling, off when 0. After a first pass of samplesPerPixel
+    // samples, each further pass doubles the samples of the pixels with an
+    // estimated error above adaptiveError (display units) in their 3x3
+    // neighbourhood, up to adaptiveMaxSamples.
+    int adaptiveMaxSamples = 0;
+    float adaptiveError = 0.01f;
+};
+
+struct RenderStats {
+    double seconds = 0.0;
+    uint64_t rays = 0;
+    uint64_t samples = 0;
+    int tilesRendered = 0;
+    unsigned int threadCount = 0;
+    SimdLevel simdLevel = SimdLevel::Scalar;
+    bool cancelled = false;
+
+    [[nodiscard]] double raysPerSecond() const {
+        return seconds > 0.0 ? (double)rays / seconds : 0.0;
+    }
+};
+
 
 class Scene {
 public:
     Scene() {}
     Scene(int ray_per_pixel, int max_ray_bounce, Camera* camera);
     ~Scene() {}
-    std::vector<glm::vec3> render();
-    std::vector<glm::vec3> renderTest();
+    std::vector<glm::vec3> render(const RenderSettings& settings);
     glm::vec3 trace(Ray& ray);
+    glm::vec3 trace(Ray& ray, uint64_t& rayCount);
+    // Expects the acceleration structure (and the material table, for the
+    // hit's materialID) to be up to date with the objects. render() takes care
+    // of it, other callers use updateAccelerationStructure() and updateMaterialTable()
     HitInfo intersectScene(Ray& ray);
+    // Recomputes the world bounds of the objects whose transform changed since
+    // the last call and refits the top level BVH (or rebuilds it when objects
+    // were added or removed)
+    void updateAccelerationStructure();
+    // CPU traversal layout of every mesh in the scene, call it once the
+    // meshes are added. Meshes are shared, so this also affects other scenes.
+    void setBVHLayout(BVHLayout layout);
+    // Gives every object the ID of its material in getMaterials()
+    void updateMaterialTable();
 
     [[nodiscard]] std::vector<SphereObject>& getSpheres() {
         return spheres;
@@ -32,6 +96,11 @@ public:
         return meshes;
     }
 
+    // The camera render() looks through, not owned by the scene
+    void setCamera(Camera* camera) {
+        this->camera = camera;
+    }
+
     [[nodiscard]] int ray_per_pixel1() const {
         return ray_per_pixel;
     }
@@ -40,6 +109,22 @@ public:
         return max_ray_bounce;
     }
 
+    [[nodiscard]] const RenderStats& getLastRenderStats() const {
+        return lastRenderStats;
+    }
+    // Samples taken per pixel by the last render, row major like the image
+    [[nodiscard]] const std::vector<int>& getSampleCounts() const {
+        return sampleCounts;
+    }
+    // getSampleCounts() as a grey image, white is the largest count
+    [[nodiscard]] std::vector<glm::vec3> getSampleCountImage() const;
+    [[nodiscard]] const MaterialTable& getMaterials() const {
+        return materials;
+    }
+    [[nodiscard]] const TopLevelBVH& getAccelerationStructure() const {
+        return accelerationStructure;
+    }
+
     void buildDefaultScene();
 private:
     // std::vector<std::unique_ptr<Light>> lights;
@@ -50,6 +135,30 @@ private:
 
     std::vector<SphereObject> spheres;
     std::vector<MeshObject> meshes;
+
+    MaterialTable materials;
+
+    std::unique_ptr<ThreadPool> threadPool;
+    RenderStats lastRenderStats;
+    std::vector<int> sampleCounts;
+
+    // Instances are the spheres followed by the meshes
+    TopLevelBVH accelerationStructure;
+    std::vector<AABB> instanceBounds;
+    std::vector<uint64_t> instanceRevisions;
+
+    std::vector<PacketInstance> packetInstances;
+
+    void prepareForRender();
+    SceneObject& getInstance(size_t index);
+    // Flattens the instances for the packet kernels, the view stays valid
+    // until the objects or the acceleration structure change
+    PacketScene buildPacketScene();
+    HitInfo getPacketHit(const RayPacket& packet, int lane, Ray& ray);
+
+    glm::vec3 tracePath(Ray& ray, Sampler& sampler, int maxBounces, uint64_t& rayCount);
+    // Follows a path from its first hit, one ray at a time
+    glm::vec3 shadePath(Ray& ray, HitInfo hit, Sampler& sampler, int maxBounces, uint64_t& rayCount);
 };
 
 
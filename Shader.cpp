@@ -4,46 +4,85 @@
 
 #include "Shader.h"
 
+#include "ProgramCache.h"
+
+Shader::Shader(const char* vertSource, const char* fragSource) : name(std::string(vertSource) + " + " + fragSource) {
+    std::string vertShaderSource = ShaderSource::load(vertSource).code;
+    std::string fragShaderSource = ShaderSource::load(fragSource).code;
+    cacheKey = ProgramCache::key({vertShaderSource, fragShaderSource}, "");
+    program = ProgramCache::load(cacheKey);
+    if (program != 0) {
+        uniforms.reflect(program);
+        return;
+    }
+
+    pendingShaders[0] = compileShader(GL_VERTEX_SHADER, vertShaderSource);
+    pendingShaders[1] = compileShader(GL_FRAGMENT_SHADER, fragShaderSource);
+    program = glCreateProgram();
+    ProgramCache::prepare(program);
+    glAttachShader(program, pendingShaders[0]);
+    glAttachShader(program, pendingShaders[1]);
+    glLinkProgram(program);
+}
+
 void Shader::use() {
+    finishLinking();
     glUseProgram(program);
 }
 
-void Shader::deleteProgram() {
-    glDeleteProgram(program);
+void Shader::finishLinking() {
+    if (pendingShaders[0] == 0) {
+        return;
+    }
+    int linked;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        for (GLuint id : pendingShaders) {
+            int compiled;
+            glGetShaderiv(id, GL_COMPILE_STATUS, &compiled);
+            if (compiled == GL_FALSE) {
+                int length;
+                glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
+                std::vector<char> errorMessage(length + 1);
+                glGetShaderInfoLog(id, length, &length, &errorMessage[0]);
+                std::cout << errorMessage.data() << std::endl;
+            }
+        }
+        int length;
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> errorMessage(length + 1);
+        glGetProgramInfoLog(program, length, &length, &errorMessage[0]);
+        std::cout << errorMessage.data() << std::endl;
+    }
+    for (GLuint& id : pendingShaders) {
+        glDetachShader(program, id);
+        glDeleteShader(id);
+        id = 0;
+    }
+    if (!linked) {
+        glDeleteProgram(program);
+        program = 0;
+        throw std::runtime_error("Error: Couldn't compile shader: " + name);
+    }
+
+    uniforms.reflect(program);
+    std::cout << "Compiled " << name << (ProgramCache::store(cacheKey, program) ? ", binary cached" : "") << std::endl;
 }
 
-std::string Shader::readFile(const char* filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cout << "Failed to open file " << filename << std::endl;
-        return "";
-    }
-    std::stringstream contents;
-    contents << file.rdbuf();
-    return contents.str();
+void Shader::deleteProgram() {
+    glDeleteProgram(program);
 }
 
+// Doesn't wait for the result, finishLinking() reports errors
 GLuint Shader::compileShader(GLenum shaderType, std::string& source) {
     GLuint id = glCreateShader(shaderType);
     const char* sourceCString = source.c_str();
     glShaderSource(id, 1, &sourceCString, NULL);
     glCompileShader(id);
-
-    int success;
-    glGetShaderiv(id, GL_COMPILE_STATUS, &success);
-    if (success == GL_FALSE) {
-        int length;
-        glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
-        std::vector<char> errorMessage(length + 1);
-        glGetShaderInfoLog(id, length, &length, &errorMessage[0]);
-        std::cout << errorMessage.data() << std::endl;
-        glDeleteShader(id);
-        return 0;
-    }
     return id;
 }
 
-void Shader::setInt(std::string name, int value) {
-    glUniform1i(glGetUniformLocation(program, name.c_str()), value);
+void Shader::setInt(std::string_view name, int value) {
+    uniforms.setInt(name, value);
 }
 
@@ -12,39 +12,35 @@
 #include <sstream>
 #include <vector>
 
+#include "ShaderSource.h"
+#include "UniformTable.h"
+
 
 class Shader {
 public:
     Shader() {
         program = 0;
     }
-    Shader(const char* vertSource, const char* fragSource) {
-        std::string vertShaderSource = readFile(vertSource);
-        std::string fragShaderSource = readFile(fragSource);
-
-        GLuint vertShader = compileShader(GL_VERTEX_SHADER, vertShaderSource);
-        GLuint fragShader = compileShader(GL_FRAGMENT_SHADER, fragShaderSource);
-
-        if (vertShader == GL_NONE || fragShader == GL_NONE) {
-            throw std::runtime_error("Error: Couldn't compile shader: " + std::string(vertShaderSource));
-        }
-
-        program = glCreateProgram();
-        glAttachShader(program, vertShader);
-        glAttachShader(program, fragShader);
-        glLinkProgram(program);
-        glDeleteShader(vertShader);
-        glDeleteShader(fragShader);
-    }
+    // Like ComputeShader: cached or compiled in the background, waited for
+    // at the first use
+    Shader(const char* vertSource, const char* fragSource);
     void use();
     void deleteProgram();
-    GLuint getProgram() { return program; }
+    GLuint getProgram() {
+        finishLinking();
+        return program;
+    }
 
-    void setInt(std::string name, int value);
+    // On the current program, skipped when unchanged
+    void setInt(std::string_view name, int value);
 private:
-    std::string readFile(const char* fileName);
     GLuint compileShader(GLenum shaderType, std::string& shaderSource);
+    void finishLinking();
     GLuint program;
+    GLuint pendingShaders[2] = {0, 0};
+    uint64_t cacheKey = 0;
+    std::string name;
+    UniformTable uniforms;
 };
 
 
@@ -0,0 +1,86 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#include "ShaderSource.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string readFile(const fs::path& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open shader file " + path.string());
+    }
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+// The quoted file name of an #include line, empty for any other line
+std::string includedFile(const std::string& line) {
+    size_t start = line.find_first_not_of(" \t");
+    if (start == std::string::npos || line.compare(start, 8, "#include") != 0) {
+        return "";
+    }
+    size_t open = line.find('"', start + 8);
+    size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+    if (close == std::string::npos) {
+        throw std::runtime_error("Malformed shader include: " + line);
+    }
+    return line.substr(open + 1, close - open - 1);
+}
+
+void append(ShaderSource& source, const fs::path& path, const ShaderDefines& defines) {
+    const int fileIndex = (int)source.files.size();
+    source.files.push_back(path.generic_string());
+    std::istringstream lines(readFile(path));
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(lines, line)) {
+        lineNumber++;
+        std::string include = includedFile(line);
+        if (!include.empty()) {
+            fs::path includePath = (path.parent_path() / include).lexically_normal();
+            if (std::find(source.files.begin(), source.files.end(), includePath.generic_string()) == source.files.end()) {
+                source.code += "#line 1 " + std::to_string(source.files.size()) + "\n";
+                append(source, includePath, defines);
+            }
+            source.code += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(fileIndex) + "\n";
+            continue;
+        }
+
+        source.code += line;
+        source.code += '\n';
+        if (fileIndex == 0 && line.rfind("#version", 0) == 0) {
+            for (const auto& [name, value] : defines) {
+                source.code += "#define " + name + " " + value + "\n";
+            }
+            source.code += "#line " + std::to_string(lineNumber + 1) + " 0\n";
+        }
+    }
+}
+
+}
+
+ShaderSource ShaderSource::load(const std::string& path, const ShaderDefines& defines) {
+    ShaderSource source;
+    append(source, fs::path(path).lexically_normal(), defines);
+    return source;
+}
+
+std::string ShaderSource::fileList() const {
+    std::string list;
+    for (size_t i = 0; i < files.size(); i++) {
+        list += std::to_string(i) + ": " + files[i] + "\n";
+    }
+    return list;
+}
@@ -0,0 +1,31 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#ifndef SHADERSOURCE_H
+#define SHADERSOURCE_H
+#include <map>
+#include <string>
+#include <vector>
+
+// Name to value, each becomes "#define NAME VALUE" in the compiled source.
+// Ordered, so the same set always gives the same source and cache key.
+using ShaderDefines = std::map<std::string, std::string>;
+
+// GLSL source with the little preprocessing GLSL lacks: #include "file"
+// lines are replaced by the file, found relative to the including one and
+// pasted only once, and defines go right after #version. #line directives
+// keep compiler messages pointing at the original lines, with each file as
+// its own source string number, the index into files.
+struct ShaderSource {
+    std::string code;
+    std::vector<std::string> files;
+
+    // Throws std::runtime_error when a file can't be read
+    [[nodiscard]] static ShaderSource load(const std::string& path, const ShaderDefines& defines = {});
+
+    // "0: path" per line, to read compiler messages with
+    [[nodiscard]] std::string fileList() const;
+};
+
+#endif //SHADERSOURCE_H
@@ -17,8 +17,6 @@ layout(binding = 0, rgba32f) uniform image2D denoisedOutput;
 layout(binding = 1, rgba32f) uniform image2D firstMomentOutput;
 layout(binding = 2, rgba32f) uniform image2D secondMomentOutput;
 
-uniform int FrameCount;
-
 const float ALPHA_MAX = 0.95; // Max accumulation factor (to prevent infinite accumulation)
 const float DEPTH_THRESHOLD = 0.05; // Depth validation epsilon
 const float NORMAL_THRESHOLD = 0.90; // Normal validation threshold (dot product)
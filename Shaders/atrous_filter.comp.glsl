@@ -1,5 +1,7 @@
 #version 430
 
+#include "include/edge_stopping.glsl"
+
 layout(local_size_x = 16, local_size_y = 16, local_size_z = 1) in;
 
 // Color buffers
@@ -15,8 +17,6 @@ layout(binding = 5, r32f) uniform readonly image2D DepthTexture;
 uniform int stepSize;
 
 const float PHI_COLOR = 4.f;
-const float PHI_NORMAL = 128.f;
-const float PHI_DEPTH = 1.f;
 
 // 5x5 B-Spline kernel (approximated Gaussian Weights)
 const float kernel[25] = float[](
@@ -68,12 +68,8 @@ void main() {
             float sampleDepth = imageLoad(DepthTexture, samplePos).r;
             float sampleLuminance = luminance(sampleColor);
 
-            float weightDepth = abs(centerDepth - sampleDepth) / centerDepthGradient;
-            weightDepth = exp(-weightDepth * PHI_DEPTH);
-
-            float dotP = dot(centerNormal, sampleNormal);
-
-            float weightNormal = pow(max(0.f, dotP), PHI_NORMAL);
+            float weightDepth = depthWeight(centerDepth, sampleDepth, centerDepthGradient);
+            float weightNormal = normalWeight(centerNormal, sampleNormal);
 
             float weightLuminance = abs(centerLum - sampleLuminance) / (PHI_COLOR * sqrt(max(0.f, centerVariance)) + 1e-6);
             weightLuminance = exp(-weightLuminance);
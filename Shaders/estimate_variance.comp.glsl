@@ -1,5 +1,7 @@
 #version 430
 
+#include "include/edge_stopping.glsl"
+
 layout(local_size_x = 16, local_size_y = 16, local_size_z = 1) in;
 
 // Current frame Color (C_i) : firstMoment = firstMoment.rgb (or .xyz);
@@ -16,8 +18,6 @@ layout(binding = 4, r32f) uniform writeonly image2D varianceTexture;
 
 // Constants:
 const int FILTER_KERNEL_SIZE = 3; // Gives a 7x7 filter
-const float PHI_NORMAL = 128.f;
-const float PHI_DEPTH = 1.f;
 
 void main() {
     ivec2 pixelPos = ivec2(gl_GlobalInvocationID.xy);
@@ -48,10 +48,8 @@ void main() {
             vec3 sampleNormal = imageLoad(normalTexture, samplePos).xyz;
             float sampleDepth = imageLoad(depthTexture, samplePos).x;
 
-            float weightNormal = pow(max(0.f, dot(centerNormal, sampleNormal)), PHI_NORMAL);
-
-            float weightDepth = (abs(centerDepth - sampleDepth) / centerDepthGradient);
-            weightDepth = exp(-weightDepth * PHI_DEPTH);
+            float weightNormal = normalWeight(centerNormal, sampleNormal);
+            float weightDepth = depthWeight(centerDepth, sampleDepth, centerDepthGradient);
 
             float w = weightNormal * weightDepth;
 
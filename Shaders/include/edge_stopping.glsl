@@ -0,0 +1,14 @@
+// Edge-stopping weights of the SVGF passes, shared so the variance estimate
+// and the a-trous filter stop at the same edges
+
+const float PHI_NORMAL = 128.f;
+const float PHI_DEPTH = 1.f;
+
+float normalWeight(vec3 centerNormal, vec3 sampleNormal) {
+    return pow(max(0.f, dot(centerNormal, sampleNormal)), PHI_NORMAL);
+}
+
+float depthWeight(float centerDepth, float sampleDepth, float depthGradient) {
+    float weight = abs(centerDepth - sampleDepth) / depthGradient;
+    return exp(-weight * PHI_DEPTH);
+}
@@ -0,0 +1,14 @@
+// Written by the engine into its frame ring once per frame, matches FrameData
+layout(std140, binding = 0) uniform FrameData {
+    mat4 InverseProjection;
+    mat4 CameraToWorld;
+    mat4 PrevVP;
+    mat4 CurrentVP;
+    vec3 ViewCenter;
+    int frameCnt;
+    int RayPerPixel;
+    int MaxRayBounce;
+    // Kernels are compiled per denoiser setting (DENOISER), kept so the
+    // layout matches
+    bool denoiserActive;
+};
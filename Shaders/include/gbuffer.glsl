@@ -0,0 +1,41 @@
+// Primary hit data the SVGF denoiser filters with, written by kernels built
+// with DENOISER. Needs frame_data.glsl and traversal.glsl.
+
+layout(r32f, binding = 1) uniform image2D depthImage;
+layout(rgba32f, binding = 2) uniform image2D normalImage;
+layout(r32ui, binding = 3) uniform uimage2D meshIDImage;
+layout(rg16f, binding = 4) uniform image2D motionVectorImage;
+
+const uint BACKGROUND_ID = 4000000000u;
+
+void writeGBuffer(ivec2 pixelCoords, Ray ray, HitInfo primaryHit) {
+    if(primaryHit.hasHit) {
+        imageStore(depthImage, pixelCoords, vec4(primaryHit.distance, 0, 0, 1));
+        imageStore(normalImage, pixelCoords, vec4(primaryHit.normal, 1.f));
+        imageStore(meshIDImage, pixelCoords, uvec4(primaryHit.objectID, 0, 0, 0));
+
+        vec3 hitPosition = ray.origin + ray.direction * primaryHit.distance;
+
+        vec3 hitInLocal = vec3(primaryHit.inverseModelMatrix * vec4(hitPosition, 1.f));
+
+        vec3 previousPositionOfHit = vec3(primaryHit.previousModel * vec4(hitInLocal, 1.f));
+
+        vec4 prevClip = PrevVP * vec4(previousPositionOfHit, 1.f);
+
+        vec2 prevUV = (prevClip.xy / prevClip.w) * 0.5 + 0.5;
+
+        vec4 currClip = CurrentVP * vec4(hitPosition, 1.f);
+        vec2 currUV = (currClip.xy / currClip.w) * 0.5 + 0.5;
+
+        vec2 motionVector;
+        motionVector = currUV - prevUV;
+
+        imageStore(motionVectorImage, pixelCoords, vec4(motionVector, 0, 1));
+    }
+    else {
+        imageStore(depthImage, pixelCoords, vec4(100000.f, 0, 0, 1));
+        imageStore(normalImage, pixelCoords, vec4(0, 0, 0, 1));
+        imageStore(meshIDImage, pixelCoords, uvec4(BACKGROUND_ID, 0, 0, 0));
+        imageStore(motionVectorImage, pixelCoords, vec4(0, 0, 0, 1));
+    }
+}
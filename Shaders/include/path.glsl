@@ -0,0 +1,40 @@
+// Steps of a path shared by the megakernel and the wavefront kernels. Needs
+// frame_data.glsl, random.glsl and traversal.glsl.
+
+// Sky light of rays that miss
+vec3 colorPixel(Ray ray) {
+    vec3 unitDir = normalize(ray.direction);
+    float a = 0.5 * (unitDir.y + 1);
+    return (1.0 - a) * vec3(1.0, 1.0, 1.0) + a * vec3(0.5f, 0.7f, 1.0f);
+}
+
+// The jittered camera ray through the pixel, rngState is seeded from the
+// pixel and frame and left after the jitter
+Ray cameraRay(ivec2 pixelCoords, ivec2 imageSize, out uint rngState) {
+    rngState = uint(uint(pixelCoords.x) * uint(1973) + uint(pixelCoords.y) * uint(9277)) | uint(1);
+    rngState += uint(frameCnt);
+
+    float randomX = RandomFloat01(rngState);
+    float randomY = RandomFloat01(rngState);
+
+    vec2 screenPos01 = (vec2(pixelCoords) + vec2(randomX, randomY)) / vec2(imageSize);
+
+    vec4 clipPos = vec4(screenPos01 * 2 - 1, 1, 1);
+
+    vec4 viewPos = InverseProjection * vec4(clipPos.xy, -1, 1);
+    viewPos.xyz /= viewPos.w;
+
+    vec3 rayDir = normalize(vec3(CameraToWorld * vec4(viewPos.xyz, 0.f)));
+
+    return createRay(rayDir, ViewCenter);
+}
+
+// The ray leaving a hit: a diffuse direction drawn with seed, blended
+// towards the mirror direction by the material's specular
+Ray bounceRay(Ray ray, float distance, vec3 normal, float specular, inout uint seed) {
+    vec3 newPos = (ray.origin + ray.direction * distance) + normal * 0.000001f;
+    vec3 diffuseDir = normalize(normal + RandomUnitVector(seed));
+    vec3 specularDir = normalize(reflect(ray.direction, normal));
+    vec3 newDir = normalize(mix(diffuseDir, specularDir, specular));
+    return createRay(newDir, newPos);
+}
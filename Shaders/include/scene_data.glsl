@@ -0,0 +1,120 @@
+// Scene records and the SSBOs the engine uploads them to, see
+// Engine::initializeSSBO for the packing
+
+// Set on TLAS instance references that point at a mesh instead of a sphere
+const uint MESH_INSTANCE_BIT = 0x80000000u;
+
+struct Material {
+    vec4 color;
+    vec4 emissionColor;
+    float emissionStrength;
+    float specular;
+};
+
+// --- SPHERE Structure (SSBO binding 1) ---
+struct SphereStruct {
+    mat4 transform; // Model matrix (Local to World)
+    mat4 invTransform; // Inverse Model matrix (World to Local)
+    mat4 prevTransform;
+    mat4 prevInverseTransform;
+    Material mat;
+    uvec4 objectID;
+};
+
+// Children of interior nodes are at leftFirst and leftFirst + 1 (relative to
+// the mesh's first node), leaves hold primitiveCount triangles starting at
+// leftFirst (relative to the mesh's first triangle)
+struct BVHNode {
+    vec3 boundsMin;
+    uint leftFirst;
+    vec3 boundsMax;
+    uint primitiveCount;
+};
+
+struct MeshInfo {
+    mat4 transform;
+    mat4 invTransform;
+    mat4 prevTransform;
+    mat4 prevInverseTransform;
+    vec4 boundsMin;
+    vec4 boundsMax;
+    uvec4 info;
+    uvec4 vertexInfo;
+    vec4 quantizationStep;
+    Material mat;
+    uvec4 objectID;
+};
+
+// SSBO 1: Spheres
+layout(std430, binding = 1) buffer sphereBuffer {
+    int numSpheres;
+    SphereStruct spheres[];
+};
+
+// Packed mesh vertices (VertexPacking), vertexInfo.y words each: x, y, z
+// as float bits and the normal, or x | y << 16, z and the normal when the
+// positions are quantized
+layout(std430, binding = 2) buffer vertexBuffer {
+    int numVertexWords;
+    uint vertexWords[];
+};
+
+layout(std430, binding = 3) buffer meshBuffer {
+    int numMeshes;
+    MeshInfo meshes[];
+};
+
+layout(std430, binding = 4) buffer bvhBuffer {
+    int numBVHNodes;
+    BVHNode bvhNodes[];
+};
+
+// Three vertices per triangle, relative to the mesh's first vertex
+layout(std430, binding = 7) buffer indexBuffer {
+    int numTriangleIndices;
+    uint triangleIndices[];
+};
+
+// Top level BVH over the world bounds of every sphere and mesh, its leaves
+// cover ranges of tlasInstances
+layout(std430, binding = 5) buffer tlasNodeBuffer {
+    int numTLASNodes;
+    BVHNode tlasNodes[];
+};
+
+layout(std430, binding = 6) buffer tlasInstanceBuffer {
+    int numTLASInstances;
+    uint tlasInstances[];
+};
+
+// Words per vertex of meshes with quantized positions, VertexPacking::stride
+const uint QUANTIZED_VERTEX_STRIDE = 3u;
+
+vec3 fetchPosition(MeshInfo mesh, uint vertex) {
+    uint word = mesh.vertexInfo.x + vertex * mesh.vertexInfo.y;
+    if(mesh.vertexInfo.y == QUANTIZED_VERTEX_STRIDE) {
+        uint xy = vertexWords[word];
+        vec3 quantized = vec3(float(xy & 0xFFFFu), float(xy >> 16), float(vertexWords[word + 1u]));
+        return mesh.boundsMin.xyz + quantized * mesh.quantizationStep.xyz;
+    }
+    return uintBitsToFloat(uvec3(vertexWords[word], vertexWords[word + 1u], vertexWords[word + 2u]));
+}
+
+// Octahedral normal in two snorm16s, the lower hemisphere folded over the diagonals
+vec3 decodeNormal(uint encoded) {
+    vec2 folded = unpackSnorm2x16(encoded);
+    vec3 normal = vec3(folded, 1.0 - abs(folded.x) - abs(folded.y));
+    float fold = max(-normal.z, 0.0);
+    normal.x += normal.x >= 0.0 ? -fold : fold;
+    normal.y += normal.y >= 0.0 ? -fold : fold;
+    return normalize(normal);
+}
+
+vec3 fetchNormal(MeshInfo mesh, uint vertex) {
+    return decodeNormal(vertexWords[mesh.vertexInfo.x + (vertex + 1u) * mesh.vertexInfo.y - 1u]);
+}
+
+uvec3 fetchCorners(uint triangle) {
+    uint first = 3u * triangle;
+    return uvec3(triangleIndices[first], triangleIndices[first + 1u], triangleIndices[first + 2u]);
+}
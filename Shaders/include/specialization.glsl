@@ -0,0 +1,24 @@
+// Specializations, the engine compiles one kernel per combination it needs
+// (ComputeShader defines). Defaults build the generic kernel. MAX_BOUNCE
+// needs frame_data.glsl where it is used.
+// DENOISER: write the G-buffer and trace one sample, else RayPerPixel samples
+#ifndef DENOISER
+#define DENOISER 1
+#endif
+// DARK_MODE: rays that miss get no sky light
+#ifndef DARK_MODE
+#define DARK_MODE 0
+#endif
+// HAS_SPHERES, HAS_MESHES: which instance types the TLAS can reference
+#ifndef HAS_SPHERES
+#define HAS_SPHERES 1
+#endif
+#ifndef HAS_MESHES
+#define HAS_MESHES 1
+#endif
+// FIXED_MAX_BOUNCE: a compile-time MaxRayBounce, so bounce loops can unroll
+#ifdef FIXED_MAX_BOUNCE
+#define MAX_BOUNCE FIXED_MAX_BOUNCE
+#else
+#define MAX_BOUNCE MaxRayBounce
+#endif
@@ -0,0 +1,433 @@
+// Closest hit queries against the scene: the TLAS, then spheres and mesh
+// BVHs in their local space. Needs scene_data.glsl and specialization.glsl.
+
+// Increased EPSILON slightly for more robust surface offset
+const float EPSILON = 0.001;
+const float NO_HIT = 1e30;
+// Far children kept per BVH walk. The walk restarts from the root when
+// they run out, so this only trades restarts against private memory.
+const int SHORT_STACK_SIZE = 8;
+
+// Corners of a mesh triangle, decoded from the vertex buffer
+struct Triangle {
+    vec3 positionA, positionB, positionC;
+};
+
+struct Ray {
+    vec3 direction;
+    vec3 origin;
+};
+
+struct HitInfo {
+    bool hasHit;
+    float distance;
+    vec4 color;
+    vec3 normal;
+    vec2 barycentrics; // u and v of triangle hits
+    Material mat;
+    uint objectID;
+    // Sphere index, or mesh index | MESH_INSTANCE_BIT
+    uint instance;
+    mat4 inverseModelMatrix;
+    mat4 previousModel;
+};
+
+Ray createRay(vec3 direction, vec3 origin) {
+    Ray ray;
+    ray.direction = direction;
+    ray.origin = origin;
+    return ray;
+}
+
+HitInfo createHitInfo() {
+    HitInfo info;
+    info.hasHit = false;
+    info.distance = 100000;
+    info.color = vec4(0, 0, 0, 1);
+    info.objectID = -1;
+    return info;
+}
+
+void intersectSphereLocal(Ray ray, inout HitInfo hit, Material mat, uint objectID) {
+    vec3 oc = ray.origin; // Sphere center is (0,0,0) in Local Space
+    float a = dot(ray.direction, ray.direction);
+    float b = 2.0 * dot(ray.direction, oc);
+    float c = dot(oc, oc) - 1.0; // Radius is 1.0
+
+    float disc = b * b - 4.0 * a * c;
+
+    if (disc >= 0.0) {
+        float t = (-b - sqrt(disc)) / (2.0 * a);
+
+        vec3 pos = ray.origin + ray.direction * t;
+        vec3 normal = normalize(pos);
+
+        if(t > 0) {
+            hit.distance = t;
+            hit.hasHit = true;
+            hit.normal = normal;
+            hit.mat = mat;
+            hit.objectID = objectID;
+        }
+    }
+}
+
+bool intersectAABB(Ray ray, vec3 minBound, vec3 maxBound) {
+    vec3 invDir = vec3(1.f / ray.direction.x, 1.f / ray.direction.y, 1.f / ray.direction.z);
+
+    vec3 tMin = (minBound - ray.origin) * invDir;
+    vec3 tMax = (maxBound - ray.origin) * invDir;
+    vec3 t1 = min(tMin, tMax);
+    vec3 t2 = max(tMin, tMax);
+    float tNear = max(max(t1.x, t1.y), t1.z);
+    float tFar = min(min(t2.x, t2.y), t2.z);
+    return tNear <= tFar;
+}
+
+// Entry distance into the box, or NO_HIT when it is missed or starts past tMax
+float intersectAABBDistance(vec3 origin, vec3 invDir, vec3 minBound, vec3 maxBound, float tMax) {
+    vec3 t0 = (minBound - origin) * invDir;
+    vec3 t1 = (maxBound - origin) * invDir;
+    vec3 tSmall = min(t0, t1);
+    vec3 tBig = max(t0, t1);
+    float tNear = max(max(tSmall.x, tSmall.y), max(tSmall.z, 0.0));
+    float tFar = min(min(tBig.x, tBig.y), min(tBig.z, tMax));
+    return tNear <= tFar ? tNear : NO_HIT;
+}
+
+// Only finds the hit, the normal is decoded for the closest one
+void intersectTriangleLocal(Ray ray, inout HitInfo localHit, Triangle triangle, Material mat, uint objectID) {
+    vec3 A = triangle.positionA;
+    vec3 B = triangle.positionB;
+    vec3 C = triangle.positionC;
+
+    // 1. Calculate edges
+    vec3 E1 = B - A; // Edge 1
+    vec3 E2 = C - A; // Edge 2
+
+    // 2. Begin calculating determinant - D x E2
+    vec3 P = cross(ray.direction, E2);
+    float det = dot(E1, P);
+
+    // 3. Check for parallel ray (determinant close to zero)
+    if (abs(det) < 0.000001) return;
+
+    float invDet = 1.0 / det;
+
+    // 4. Calculate T vector (distance from A to ray origin)
+    vec3 T = ray.origin - A;
+
+    // 5. Calculate U parameter and check bounds
+    float u = dot(T, P) * invDet;
+    if (u < 0.0 || u > 1.0) return;
+
+    // 6. Calculate Q vector
+    vec3 Q = cross(T, E1);
+
+    // 7. Calculate V parameter and check bounds
+    float v = dot(ray.direction, Q) * invDet;
+    if (v < 0.0 || u + v > 1.0) return; // Standard Moller-Trumbore second check
+
+    // 8. Calculate T parameter (distance along the ray)
+    float dst = dot(E2, Q) * invDet;
+
+    // 9. Check if triangle is behind the ray origin or too close
+    if (dst < EPSILON) return; // Use the global EPSILON
+
+    // Success: Found a valid hit
+    localHit.hasHit = true;
+    localHit.distance = dst;
+    localHit.mat = mat;
+    localHit.objectID = objectID;
+    localHit.barycentrics = vec2(u, v);
+}
+
+// State of a BVH walk with a short stack (restart trail, Laine 2010). The
+// far children of the last SHORT_STACK_SIZE levels are kept in a ring, older
+// ones are dropped. Bit d - 1 of trail is set once the walk took the last
+// child it will take at depth d, so whatever the ring lost is found again by
+// walking back down from the root along the trail. 64 bits for the 64 levels
+// of BVH::MAX_DEPTH.
+struct ShortStack {
+    uint nodes[SHORT_STACK_SIZE];
+    int top;
+    int count;
+    uvec2 trail;
+    int depth;
+};
+
+ShortStack createShortStack() {
+    ShortStack stack;
+    stack.top = 0;
+    stack.count = 0;
+    stack.trail = uvec2(0u);
+    stack.depth = 0;
+    return stack;
+}
+
+bool trailBit(uvec2 trail, int depth) {
+    int bit = depth - 1;
+    return ((bit < 32 ? trail.x >> bit : trail.y >> (bit - 32)) & 1u) != 0u;
+}
+
+// Goes down from the inner node at stack.depth to one of its children,
+// sorted nearest first, of which at least one is hit
+uint descend(inout ShortStack stack, uint nearChild, uint farChild, bool nearHit, bool farHit) {
+    stack.depth++;
+    if (trailBit(stack.trail, stack.depth)) {
+        // Back from a restart, past the near child
+        return farHit ? farChild : nearChild;
+    }
+    if (nearHit && farHit) {
+        stack.nodes[stack.top] = farChild;
+        stack.top = (stack.top + 1) % SHORT_STACK_SIZE;
+        stack.count = min(stack.count + 1, SHORT_STACK_SIZE);
+        return nearChild;
+    }
+    int bit = stack.depth - 1;
+    if (bit < 32) {
+        stack.trail.x |= 1u << bit;
+    }
+    else {
+        stack.trail.y |= 1u << (bit - 32);
+    }
+    return nearHit ? nearChild : farChild;
+}
+
+// Leaves the subtree at stack.depth for the deepest level above it that
+// still has a far child to visit, false once there is none. That child is
+// then popShortStack(), or found by restarting from the root when the ring
+// is empty.
+bool ascend(inout ShortStack stack) {
+    // Deepest clear trail bit among the levels 1..depth
+    int depth = stack.depth;
+    uint highMask = depth >= 64 ? 0xFFFFFFFFu : (depth > 32 ? (1u << (depth - 32)) - 1u : 0u);
+    uint lowMask = depth >= 32 ? 0xFFFFFFFFu : (1u << depth) - 1u;
+    int bit = findMSB(~stack.trail.y & highMask);
+    bit = bit >= 0 ? bit + 32 : findMSB(~stack.trail.x & lowMask);
+    if (bit < 0) {
+        return false;
+    }
+    // Set it, and forget the levels below
+    if (bit < 32) {
+        stack.trail = uvec2((stack.trail.x & ((1u << bit) - 1u)) | (1u << bit), 0u);
+    }
+    else {
+        stack.trail.y = (stack.trail.y & ((1u << (bit - 32)) - 1u)) | (1u << (bit - 32));
+    }
+    stack.depth = bit + 1;
+    return true;
+}
+
+uint popShortStack(inout ShortStack stack) {
+    stack.top = (stack.top + SHORT_STACK_SIZE - 1) % SHORT_STACK_SIZE;
+    stack.count--;
+    return stack.nodes[stack.top];
+}
+
+// Walks the mesh's BVH nearest child first. bestHit.distance is the
+// traversal's tMax (t is the same in local and world space), so nodes behind
+// the closest hit so far are never visited.
+void intersectMeshBVH(Ray localRay, MeshInfo mesh, inout HitInfo bestHit) {
+    uint firstTriangle = mesh.info.x;
+    uint rootNode = mesh.info.z;
+    if(mesh.info.w == 0u) {
+        return;
+    }
+    vec3 invDir = 1.0 / localRay.direction;
+
+    if(intersectAABBDistance(localRay.origin, invDir, bvhNodes[rootNode].boundsMin, bvhNodes[rootNode].boundsMax, bestHit.distance) == NO_HIT) {
+        return;
+    }
+
+    ShortStack stack = createShortStack();
+    uint current = rootNode;
+
+    while(true) {
+        BVHNode node = bvhNodes[current];
+
+        if(node.primitiveCount > 0) {
+            for(uint j = 0; j < node.primitiveCount; j++) {
+                uvec3 corners = fetchCorners(firstTriangle + node.leftFirst + j);
+                Triangle triangle;
+                triangle.positionA = fetchPosition(mesh, corners.x);
+                triangle.positionB = fetchPosition(mesh, corners.y);
+                triangle.positionC = fetchPosition(mesh, corners.z);
+
+                HitInfo localTriangleHit = createHitInfo();
+                intersectTriangleLocal(localRay, localTriangleHit, triangle, mesh.mat, mesh.objectID.x);
+                if(localTriangleHit.hasHit && localTriangleHit.distance < bestHit.distance) {
+                    bestHit.distance = localTriangleHit.distance;
+                    bestHit.mat = localTriangleHit.mat;
+                    // Interpolate the normal
+                    float u = localTriangleHit.barycentrics.x;
+                    float v = localTriangleHit.barycentrics.y;
+                    float w = 1.0 - u - v;
+                    vec3 localNormal = normalize(w * fetchNormal(mesh, corners.x) + u * fetchNormal(mesh, corners.y) + v * fetchNormal(mesh, corners.z));
+                    mat3 normalTransform = transpose(mat3(mesh.invTransform));
+                    bestHit.normal = normalize(normalTransform * localNormal);
+                    bestHit.hasHit = localTriangleHit.hasHit;
+                    bestHit.objectID = localTriangleHit.objectID;
+                    bestHit.previousModel = mesh.prevTransform;
+                    bestHit.inverseModelMatrix = mesh.invTransform;
+                }
+            }
+        }
+        else {
+            uint nearChild = rootNode + node.leftFirst;
+            uint farChild = nearChild + 1;
+            float nearDist = intersectAABBDistance(localRay.origin, invDir, bvhNodes[nearChild].boundsMin, bvhNodes[nearChild].boundsMax, bestHit.distance);
+            float farDist = intersectAABBDistance(localRay.origin, invDir, bvhNodes[farChild].boundsMin, bvhNodes[farChild].boundsMax, bestHit.distance);
+            if(farDist < nearDist) {
+                uint tmpChild = nearChild;
+                nearChild = farChild;
+                farChild = tmpChild;
+                float tmpDist = nearDist;
+                nearDist = farDist;
+                farDist = tmpDist;
+            }
+            if(nearDist != NO_HIT) {
+                current = descend(stack, nearChild, farChild, true, farDist != NO_HIT);
+                continue;
+            }
+        }
+
+        // Next node that can still beat the closest hit, popped nodes are
+        // tested again as the hit may have come closer since the push
+        bool found = false;
+        while(ascend(stack)) {
+            if(stack.count == 0) {
+                current = rootNode;
+                stack.depth = 0;
+                found = true;
+                break;
+            }
+            current = popShortStack(stack);
+            if(intersectAABBDistance(localRay.origin, invDir, bvhNodes[current].boundsMin, bvhNodes[current].boundsMax, bestHit.distance) != NO_HIT) {
+                found = true;
+                break;
+            }
+        }
+        if(!found) {
+            break;
+        }
+    }
+}
+
+void intersectSphereInstance(Ray ray, uint sphereIndex, inout HitInfo bestHit) {
+    SphereStruct sphere = spheres[sphereIndex];
+
+    // Transform ray from World Space to Sphere Local Space
+    vec3 localOrigin = vec3(sphere.invTransform * vec4(ray.origin, 1));
+    vec3 localDirection = vec3(sphere.invTransform * vec4(ray.direction, 0));
+    Ray localRay = createRay(localDirection, localOrigin);
+
+    // Perform intersection against the canonical unit sphere
+    HitInfo localSphereHit = createHitInfo();
+    intersectSphereLocal(localRay, localSphereHit, sphere.mat, sphere.objectID.x);
+
+    if (localSphereHit.hasHit && localSphereHit.distance < bestHit.distance) {
+        bestHit.distance = localSphereHit.distance;
+        bestHit.mat = localSphereHit.mat;
+        mat3 normalTransform = transpose(mat3(sphere.invTransform));
+        bestHit.normal = normalize(normalTransform * localSphereHit.normal);
+        bestHit.hasHit = localSphereHit.hasHit;
+        bestHit.objectID = localSphereHit.objectID;
+        bestHit.inverseModelMatrix = sphere.invTransform;
+        bestHit.previousModel = sphere.prevTransform;
+        bestHit.instance = sphereIndex;
+    }
+}
+
+void intersectMeshInstance(Ray ray, uint meshIndex, inout HitInfo bestHit) {
+    MeshInfo mesh = meshes[meshIndex];
+
+    vec3 localOrigin = vec3(mesh.invTransform * vec4(ray.origin, 1));
+    vec3 localDirection = vec3(mesh.invTransform * vec4(ray.direction, 0));
+    Ray localRay = createRay(localDirection, localOrigin);
+
+    float closest = bestHit.distance;
+    intersectMeshBVH(localRay, mesh, bestHit);
+    if(bestHit.distance < closest) {
+        bestHit.instance = meshIndex | MESH_INSTANCE_BIT;
+    }
+}
+
+// Walks the TLAS in world space, rays only go into the local space of the
+// instances whose world bounds they actually hit
+HitInfo intersect(Ray ray) {
+    HitInfo bestHit = createHitInfo();
+    if(numTLASNodes == 0) {
+        return bestHit;
+    }
+
+    vec3 invDir = 1.0 / ray.direction;
+    if(intersectAABBDistance(ray.origin, invDir, tlasNodes[0].boundsMin, tlasNodes[0].boundsMax, bestHit.distance) == NO_HIT) {
+        return bestHit;
+    }
+
+    ShortStack stack = createShortStack();
+    uint current = 0;
+
+    while(true) {
+        BVHNode node = tlasNodes[current];
+
+        if(node.primitiveCount > 0) {
+            for(uint j = 0; j < node.primitiveCount; j++) {
+                uint instance = tlasInstances[node.leftFirst + j];
+#if HAS_SPHERES && HAS_MESHES
+                if((instance & MESH_INSTANCE_BIT) != 0u) {
+                    intersectMeshInstance(ray, instance & ~MESH_INSTANCE_BIT, bestHit);
+                }
+                else {
+                    intersectSphereInstance(ray, instance, bestHit);
+                }
+#elif HAS_MESHES
+                intersectMeshInstance(ray, instance & ~MESH_INSTANCE_BIT, bestHit);
+#elif HAS_SPHERES
+                intersectSphereInstance(ray, instance, bestHit);
+#endif
+            }
+        }
+        else {
+            uint nearChild = node.leftFirst;
+            uint farChild = nearChild + 1;
+            float nearDist = intersectAABBDistance(ray.origin, invDir, tlasNodes[nearChild].boundsMin, tlasNodes[nearChild].boundsMax, bestHit.distance);
+            float farDist = intersectAABBDistance(ray.origin, invDir, tlasNodes[farChild].boundsMin, tlasNodes[farChild].boundsMax, bestHit.distance);
+            if(farDist < nearDist) {
+                uint tmpChild = nearChild;
+                nearChild = farChild;
+                farChild = tmpChild;
+                float tmpDist = nearDist;
+                nearDist = farDist;
+                farDist = tmpDist;
+            }
+            if(nearDist != NO_HIT) {
+                current = descend(stack, nearChild, farChild, true, farDist != NO_HIT);
+                continue;
+            }
+        }
+
+        // Next node that can still beat the closest hit, popped nodes are
+        // tested again as the hit may have come closer since the push
+        bool found = false;
+        while(ascend(stack)) {
+            if(stack.count == 0) {
+                current = 0u;
+                stack.depth = 0;
+                found = true;
+                break;
+            }
+            current = popShortStack(stack);
+            if(intersectAABBDistance(ray.origin, invDir, tlasNodes[current].boundsMin, tlasNodes[current].boundsMax, bestHit.distance) != NO_HIT) {
+                found = true;
+                break;
+            }
+        }
+        if(!found) {
+            break;
+        }
+    }
+
+    return bestHit;
+}
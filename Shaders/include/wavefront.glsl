@@ -0,0 +1,63 @@
+// Path state of the wavefront kernels. Every path of a batch has a slot in
+// paths and pathHits. The live ones are listed in one of two queues: the
+// kernels of a bounce read queue CurrentQueue and shade appends the paths
+// that go on to the other one.
+
+const uint WAVEFRONT_GROUP_SIZE = 64u;
+// pathHits instance of rays that hit nothing
+const uint NO_INSTANCE = 0xFFFFFFFFu;
+
+struct PathState {
+    vec3 origin;
+    uint rng;
+    vec3 direction;
+    uint bounce;
+    vec3 throughput;
+    uint pixel;
+    vec3 radiance;
+    uint padding;
+};
+
+// Written by extend for shade, instance is the sphere index or mesh index
+// | MESH_INSTANCE_BIT like the TLAS instance references
+struct PathHit {
+    vec3 normal;
+    float distance;
+    uint instance;
+    uint padding[3];
+};
+
+layout(std430, binding = 8) buffer pathBuffer {
+    PathState paths[];
+};
+
+layout(std430, binding = 9) buffer pathHitBuffer {
+    PathHit pathHits[];
+};
+
+// Queue q holds queueCounts[q] slots from queuedPaths[q * PathCount]
+layout(std430, binding = 10) buffer pathQueueBuffer {
+    uint queueCounts[4];
+    uint queuedPaths[];
+};
+
+// glDispatchComputeIndirect groups for extend and shade
+layout(std430, binding = 11) buffer dispatchBuffer {
+    uint dispatchGroups[3];
+};
+
+// Paths in the batch, slot = sample of the batch * pixel count + pixel
+uniform int PathCount;
+uniform int CurrentQueue;
+
+// Intersections per path: the primary ray and MAX_BOUNCE bounces with the
+// denoiser, MAX_BOUNCE in all without, like the megakernel
+#if DENOISER
+#define PATH_LENGTH (MAX_BOUNCE + 1)
+#else
+#define PATH_LENGTH MAX_BOUNCE
+#endif
+
+uint queueStart(int queue) {
+    return uint(queue) * uint(PathCount);
+}
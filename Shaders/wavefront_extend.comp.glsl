@@ -0,0 +1,39 @@
+#version 430 core
+
+// Finds the closest hit of every queued path, and writes the G-buffer at
+// the primary hit when denoising
+
+#include "include/specialization.glsl"
+#include "include/frame_data.glsl"
+#include "include/scene_data.glsl"
+#include "include/random.glsl"
+#include "include/traversal.glsl"
+#include "include/wavefront.glsl"
+#include "include/gbuffer.glsl"
+
+layout(local_size_x = 64, local_size_y = 1, local_size_z = 1) in;
+
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+    if(index >= queueCounts[CurrentQueue]) {
+        return;
+    }
+    uint slot = queuedPaths[queueStart(CurrentQueue) + index];
+    PathState path = paths[slot];
+
+    Ray ray = createRay(path.direction, path.origin);
+    HitInfo hit = intersect(ray);
+
+#if DENOISER
+    if(path.bounce == 0u) {
+        uint width = uint(imageSize(depthImage).x);
+        writeGBuffer(ivec2(path.pixel % width, path.pixel / width), ray, hit);
+    }
+#endif
+
+    PathHit record;
+    record.normal = hit.normal;
+    record.distance = hit.distance;
+    record.instance = hit.hasHit ? hit.instance : NO_INSTANCE;
+    pathHits[slot] = record;
+}
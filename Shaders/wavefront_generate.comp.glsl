@@ -0,0 +1,53 @@
+#version 430 core
+
+// Starts every path of the batch at its camera ray and queues it for the
+// first extend
+
+#include "include/specialization.glsl"
+#include "include/frame_data.glsl"
+#include "include/scene_data.glsl"
+#include "include/random.glsl"
+#include "include/traversal.glsl"
+#include "include/path.glsl"
+#include "include/wavefront.glsl"
+
+layout(local_size_x = 64, local_size_y = 1, local_size_z = 1) in;
+
+layout(rgba32f, binding = 0) uniform image2D noisyImage;
+
+// Sample index of the batch's first slots
+uniform int FirstSample;
+
+void main() {
+    uint slot = gl_GlobalInvocationID.x;
+    if(slot == 0u) {
+        queueCounts[0] = uint(PathCount);
+        queueCounts[1] = 0u;
+    }
+    if(slot >= uint(PathCount)) {
+        return;
+    }
+
+    ivec2 size = imageSize(noisyImage);
+    uint pixelCount = uint(size.x * size.y);
+    uint pixel = slot % pixelCount;
+    uint sampleIndex = uint(FirstSample) + slot / pixelCount;
+    ivec2 pixelCoords = ivec2(pixel % uint(size.x), pixel / uint(size.x));
+
+    uint rngState;
+    Ray ray = cameraRay(pixelCoords, size, rngState);
+
+    PathState path;
+    path.origin = ray.origin;
+    path.direction = ray.direction;
+    // Samples run in parallel instead of continuing one another's random
+    // sequence, so each gets its own. Sample 0 matches the megakernel.
+    path.rng = rngState + sampleIndex * 0x9E3779B9u;
+    path.bounce = 0u;
+    path.throughput = vec3(1.f);
+    path.pixel = pixel;
+    path.radiance = vec3(0.f);
+    path.padding = 0u;
+    paths[slot] = path;
+    queuedPaths[slot] = slot;
+}
@@ -0,0 +1,16 @@
+#version 430 core
+
+// Sizes the extend and shade dispatches of a bounce from the number of
+// queued paths, and empties the queue shade appends to
+
+#include "include/specialization.glsl"
+#include "include/wavefront.glsl"
+
+layout(local_size_x = 1, local_size_y = 1, local_size_z = 1) in;
+
+void main() {
+    dispatchGroups[0] = (queueCounts[CurrentQueue] + WAVEFRONT_GROUP_SIZE - 1u) / WAVEFRONT_GROUP_SIZE;
+    dispatchGroups[1] = 1u;
+    dispatchGroups[2] = 1u;
+    queueCounts[1 - CurrentQueue] = 0u;
+}
@@ -0,0 +1,37 @@
+#version 430 core
+
+// Sums the radiance of the batch's samples of each pixel into noisyImage,
+// which holds the sum of the previous batches, and averages after the last
+
+#include "include/specialization.glsl"
+#include "include/frame_data.glsl"
+#include "include/wavefront.glsl"
+
+layout(local_size_x = 16, local_size_y = 16, local_size_z = 1) in;
+
+layout(rgba32f, binding = 0) uniform image2D noisyImage;
+
+uniform int FirstSample;
+uniform int SamplesPerBatch;
+
+void main() {
+    ivec2 pixelCoords = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = imageSize(noisyImage);
+    if(pixelCoords.x >= size.x || pixelCoords.y >= size.y) {
+        return;
+    }
+    uint pixelCount = uint(size.x * size.y);
+    uint pixel = uint(pixelCoords.y * size.x + pixelCoords.x);
+
+    vec3 sum = FirstSample == 0 ? vec3(0.f) : imageLoad(noisyImage, pixelCoords).rgb;
+    for(int i = 0; i < SamplesPerBatch; i++) {
+        sum += paths[uint(i) * pixelCount + pixel].radiance;
+    }
+
+#if DENOISER
+    imageStore(noisyImage, pixelCoords, vec4(sum, 1.f));
+#else
+    bool lastBatch = FirstSample + SamplesPerBatch >= RayPerPixel;
+    imageStore(noisyImage, pixelCoords, vec4(lastBatch ? sum / float(RayPerPixel) : sum, 1.f));
+#endif
+}
@@ -0,0 +1,78 @@
+#version 430 core
+
+// Adds the light of every queued path's hit and bounces it. Paths that go
+// on are compacted into the next queue: each group counts its own, then
+// reserves their places with a single atomic.
+
+#include "include/specialization.glsl"
+#include "include/frame_data.glsl"
+#include "include/scene_data.glsl"
+#include "include/random.glsl"
+#include "include/traversal.glsl"
+#include "include/path.glsl"
+#include "include/wavefront.glsl"
+
+layout(local_size_x = 64, local_size_y = 1, local_size_z = 1) in;
+
+shared uint groupQueued;
+shared uint groupStart;
+
+Material instanceMaterial(uint instance) {
+    if((instance & MESH_INSTANCE_BIT) != 0u) {
+        return meshes[instance & ~MESH_INSTANCE_BIT].mat;
+    }
+    return spheres[instance].mat;
+}
+
+void main() {
+    if(gl_LocalInvocationIndex == 0u) {
+        groupQueued = 0u;
+    }
+    barrier();
+
+    // No early return, every invocation has to reach the barriers
+    uint index = gl_GlobalInvocationID.x;
+    uint slot = 0u;
+    bool keep = false;
+    if(index < queueCounts[CurrentQueue]) {
+        slot = queuedPaths[queueStart(CurrentQueue) + index];
+        PathState path = paths[slot];
+        PathHit hit = pathHits[slot];
+        Ray ray = createRay(path.direction, path.origin);
+
+        if(hit.instance == NO_INSTANCE) {
+#if !DARK_MODE
+            path.radiance += colorPixel(ray) * path.throughput;
+#endif
+        }
+        else {
+            Material mat = instanceMaterial(hit.instance);
+            vec3 emittedLight = mat.emissionColor.xyz * mat.emissionStrength;
+            path.radiance += emittedLight * path.throughput;
+            path.throughput *= mat.color.xyz;
+
+#if DENOISER
+            uint seed = path.rng + frameCnt;
+            ray = bounceRay(ray, hit.distance, hit.normal, mat.specular, seed);
+#else
+            path.rng += frameCnt;
+            ray = bounceRay(ray, hit.distance, hit.normal, mat.specular, path.rng);
+#endif
+            path.origin = ray.origin;
+            path.direction = ray.direction;
+            path.bounce++;
+            keep = path.bounce < uint(PATH_LENGTH);
+        }
+        paths[slot] = path;
+    }
+
+    uint position = keep ? atomicAdd(groupQueued, 1u) : 0u;
+    barrier();
+    if(gl_LocalInvocationIndex == 0u) {
+        groupStart = atomicAdd(queueCounts[1 - CurrentQueue], groupQueued);
+    }
+    barrier();
+    if(keep) {
+        queuedPaths[queueStart(1 - CurrentQueue) + groupStart + position] = slot;
+    }
+}
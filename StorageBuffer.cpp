@@ -0,0 +1,75 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#include "StorageBuffer.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+bool StorageBuffer::persistentMappingSupported() {
+    return GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage;
+}
+
+void* StorageBuffer::allocate(GLuint binding, uint32_t count, size_t elementSize) {
+    // Immutable storage can't be resized, a new size is a new buffer
+    release();
+    bindingPoint = binding;
+    elementCount = count;
+    bufferSize = HEADER_SIZE + (size_t)count * elementSize;
+    persistent = persistentMappingSupported();
+
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+    if (persistent) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        // Dynamic storage for write()'s glBufferSubData
+        glBufferStorage(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)bufferSize, nullptr, flags | GL_DYNAMIC_STORAGE_BIT);
+        mapped = (char*)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, (GLsizeiptr)bufferSize, flags);
+    }
+    else {
+        glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)bufferSize, nullptr, GL_STATIC_DRAW);
+        mapped = (char*)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, (GLsizeiptr)bufferSize,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    if (mapped == nullptr) {
+        release();
+        throw std::runtime_error("Failed to map a shader storage buffer of " + std::to_string(bufferSize) + " bytes");
+    }
+
+    const int header[4] = {(int)count, 0, 0, 0};
+    std::memcpy(mapped, header, HEADER_SIZE);
+    return mapped + HEADER_SIZE;
+}
+
+void StorageBuffer::finish() {
+    if (!persistent && mapped != nullptr) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+        glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        mapped = nullptr;
+    }
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, bindingPoint, buffer);
+}
+
+void StorageBuffer::write(size_t offset, const void* data, size_t size) {
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, (GLintptr)(HEADER_SIZE + offset), (GLsizeiptr)size, data);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void StorageBuffer::release() {
+    if (buffer == 0) {
+        return;
+    }
+    if (mapped != nullptr) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+        glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        mapped = nullptr;
+    }
+    glDeleteBuffers(1, &buffer);
+    buffer = 0;
+}
@@ -0,0 +1,65 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#ifndef STORAGEBUFFER_H
+#define STORAGEBUFFER_H
+#include <cstddef>
+#include <cstdint>
+#include <glad/glad.h>
+
+// Shader storage buffer laid out like all of ours: a 16 byte header holding
+// the element count, then the elements. It is filled in place: allocate()
+// maps it and hands out the element memory, which any thread may write,
+// then finish() makes it visible to the GPU and binds it.
+//
+// With GL 4.4 or ARB_buffer_storage the storage is immutable and stays
+// mapped (persistent and coherent), so packing writes straight into memory
+// the driver hands to the GPU. Otherwise it is mapped for the one fill and
+// unmapped by finish().
+class StorageBuffer {
+public:
+    static constexpr size_t HEADER_SIZE = 16;
+
+    [[nodiscard]] static bool persistentMappingSupported();
+
+    // (Re)creates the buffer for count elements of elementSize bytes and
+    // returns their memory, valid until finish(). Main thread only.
+    void* allocate(GLuint binding, uint32_t count, size_t elementSize);
+    template<typename T>
+    T* allocate(GLuint binding, uint32_t count) {
+        return static_cast<T*>(allocate(binding, count, sizeof(T)));
+    }
+    void finish();
+
+    // Overwrites part of the elements after finish(). Goes through
+    // glBufferSubData even when mapped, which the driver orders after the
+    // dispatches still reading the old data.
+    void write(size_t offset, const void* data, size_t size);
+
+    // Deletes the buffer, call it while the GL context is still current
+    void release();
+
+    [[nodiscard]] GLuint id() const {
+        return buffer;
+    }
+    [[nodiscard]] uint32_t count() const {
+        return elementCount;
+    }
+    [[nodiscard]] size_t sizeBytes() const {
+        return bufferSize;
+    }
+    [[nodiscard]] bool isPersistent() const {
+        return persistent;
+    }
+
+private:
+    GLuint buffer = 0;
+    GLuint bindingPoint = 0;
+    uint32_t elementCount = 0;
+    size_t bufferSize = 0;
+    bool persistent = false;
+    char* mapped = nullptr;
+};
+
+#endif //STORAGEBUFFER_H
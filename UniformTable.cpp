@@ -0,0 +1,73 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#include "UniformTable.h"
+
+#include <vector>
+
+namespace {
+
+std::string resourceName(GLuint program, GLenum interface, GLuint index, GLint length) {
+    std::vector<GLchar> name(length > 0 ? length : 1);
+    glGetProgramResourceName(program, interface, index, (GLsizei)name.size(), nullptr, name.data());
+    return std::string(name.data());
+}
+
+}
+
+void UniformTable::reflect(GLuint program) {
+    uniforms.clear();
+    blocks.clear();
+    if (program == 0) {
+        return;
+    }
+
+    GLint uniformCount = 0;
+    glGetProgramInterfaceiv(program, GL_UNIFORM, GL_ACTIVE_RESOURCES, &uniformCount);
+    const GLenum uniformProperties[] = {GL_NAME_LENGTH, GL_LOCATION, GL_TYPE, GL_BLOCK_INDEX};
+    for (GLint i = 0; i < uniformCount; i++) {
+        GLint values[4];
+        glGetProgramResourceiv(program, GL_UNIFORM, (GLuint)i, 4, uniformProperties, 4, nullptr, values);
+        // Block members have no location, they are set through their buffer
+        if (values[3] != -1) {
+            continue;
+        }
+        std::string name = resourceName(program, GL_UNIFORM, (GLuint)i, values[0]);
+        Uniform uniform{values[1], (GLenum)values[2]};
+        // Arrays are reported as "name[0]", callers use the plain name
+        if (name.size() > 3 && name.ends_with("[0]")) {
+            uniforms.emplace(name.substr(0, name.size() - 3), uniform);
+        }
+        uniforms.emplace(std::move(name), uniform);
+    }
+
+    GLint blockCount = 0;
+    glGetProgramInterfaceiv(program, GL_UNIFORM_BLOCK, GL_ACTIVE_RESOURCES, &blockCount);
+    const GLenum blockProperties[] = {GL_NAME_LENGTH, GL_BUFFER_BINDING, GL_BUFFER_DATA_SIZE};
+    for (GLint i = 0; i < blockCount; i++) {
+        GLint values[3];
+        glGetProgramResourceiv(program, GL_UNIFORM_BLOCK, (GLuint)i, 3, blockProperties, 3, nullptr, values);
+        blocks.emplace(resourceName(program, GL_UNIFORM_BLOCK, (GLuint)i, values[0]), Block{values[1], values[2]});
+    }
+}
+
+UniformTable::Uniform* UniformTable::find(std::string_view name) {
+    auto found = uniforms.find(name);
+    return found != uniforms.end() ? &found->second : nullptr;
+}
+
+const UniformTable::Block* UniformTable::findBlock(std::string_view name) const {
+    auto found = blocks.find(name);
+    return found != blocks.end() ? &found->second : nullptr;
+}
+
+void UniformTable::setInt(std::string_view name, GLint value) {
+    Uniform* uniform = find(name);
+    if (uniform == nullptr || (uniform->hasValue && uniform->value == value)) {
+        return;
+    }
+    glUniform1i(uniform->location, value);
+    uniform->hasValue = true;
+    uniform->value = value;
+}
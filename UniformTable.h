@@ -0,0 +1,53 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#ifndef UNIFORMTABLE_H
+#define UNIFORMTABLE_H
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <glad/glad.h>
+
+// A linked program's active uniforms and uniform blocks, read once through
+// the program interface query API. Lookups hash the name without building
+// a std::string, and integer uniforms (mostly sampler units, set again
+// every frame) remember their value so repeated sets make no GL call.
+class UniformTable {
+public:
+    struct Uniform {
+        GLint location = -1;
+        GLenum type = 0;
+        bool hasValue = false;
+        GLint value = 0;
+    };
+    struct Block {
+        GLint binding = 0;
+        GLint dataSize = 0;
+    };
+
+    void reflect(GLuint program);
+
+    // nullptr for names the program doesn't use, e.g. optimized away
+    [[nodiscard]] Uniform* find(std::string_view name);
+    [[nodiscard]] const Block* findBlock(std::string_view name) const;
+
+    // glUniform1i on the current program, skipped when the value is unchanged
+    void setInt(std::string_view name, GLint value);
+
+    [[nodiscard]] size_t size() const {
+        return uniforms.size();
+    }
+
+private:
+    struct NameHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view name) const {
+            return std::hash<std::string_view>{}(name);
+        }
+    };
+    std::unordered_map<std::string, Uniform, NameHash, std::equal_to<>> uniforms;
+    std::unordered_map<std::string, Block, NameHash, std::equal_to<>> blocks;
+};
+
+#endif //UNIFORMTABLE_H
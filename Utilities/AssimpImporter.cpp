@@ -0,0 +1,217 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#include "AssimpImporter.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <map>
+#include <stdexcept>
+
+#include <assimp/Importer.hpp>
+#include <assimp/config.h>
+#include <assimp/material.h>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+
+#include "MeshBuilder.h"
+
+namespace {
+
+using clock = std::chrono::steady_clock;
+
+double millisecondsSince(clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+}
+
+// Assimp welds vertices, so one index per corner serves every attribute
+struct Geometry {
+    std::vector<glm::vec3> vertices;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> texCoords;
+    std::vector<unsigned int> indices;
+};
+
+void appendMesh(const aiMesh& mesh, bool withTexCoords, Geometry& geometry) {
+    const unsigned int base = (unsigned int)geometry.vertices.size();
+    for (unsigned int i = 0; i < mesh.mNumVertices; i++) {
+        const aiVector3D& position = mesh.mVertices[i];
+        geometry.vertices.emplace_back(position.x, position.y, position.z);
+        if (mesh.HasNormals()) {
+            const aiVector3D& normal = mesh.mNormals[i];
+            geometry.normals.emplace_back(normal.x, normal.y, normal.z);
+        }
+        else {
+            // GenSmoothNormals only leaves out meshes without triangles
+            geometry.normals.emplace_back(0.0f, 1.0f, 0.0f);
+        }
+        if (withTexCoords) {
+            const aiVector3D* texCoord = mesh.HasTextureCoords(0) ? &mesh.mTextureCoords[0][i] : nullptr;
+            geometry.texCoords.emplace_back(texCoord ? texCoord->x : 0.0f, texCoord ? texCoord->y : 0.0f);
+        }
+    }
+    for (unsigned int i = 0; i < mesh.mNumFaces; i++) {
+        const aiFace& face = mesh.mFaces[i];
+        if (face.mNumIndices != 3) {
+            continue;
+        }
+        for (int corner = 0; corner < 3; corner++) {
+            geometry.indices.push_back(base + face.mIndices[corner]);
+        }
+    }
+}
+
+std::string materialName(const aiMaterial& material, unsigned int index) {
+    aiString name;
+    if (material.Get(AI_MATKEY_NAME, name) == AI_SUCCESS && name.C_Str()[0] != '\0') {
+        return name.C_Str();
+    }
+    return "material " + std::to_string(index);
+}
+
+// Our Material is a color, an emission color times a strength, and a
+// specular blend between diffuse and mirror reflection
+std::shared_ptr<Material> convertMaterial(const aiMaterial& material) {
+    aiColor3D color(1.0f, 1.0f, 1.0f);
+    bool hasBaseColor = false;
+#ifdef AI_MATKEY_BASE_COLOR
+    // glTF's PBR base color, older Assimp versions only have the diffuse one
+    hasBaseColor = material.Get(AI_MATKEY_BASE_COLOR, color) == AI_SUCCESS;
+#endif
+    if (!hasBaseColor) {
+        material.Get(AI_MATKEY_COLOR_DIFFUSE, color);
+    }
+
+    aiColor3D emissive(0.0f, 0.0f, 0.0f);
+    material.Get(AI_MATKEY_COLOR_EMISSIVE, emissive);
+    float emissiveIntensity = 1.0f;
+#ifdef AI_MATKEY_EMISSIVE_INTENSITY
+    material.Get(AI_MATKEY_EMISSIVE_INTENSITY, emissiveIntensity);
+#endif
+    // The brightest channel of the emission color is 1, the rest is strength
+    glm::vec3 emission = glm::vec3(emissive.r, emissive.g, emissive.b) * emissiveIntensity;
+    float emissionStrength = std::max(emission.x, std::max(emission.y, emission.z));
+    glm::vec3 emissionColor = emissionStrength > 0.0f ? emission / emissionStrength : glm::vec3(0.0f);
+
+    // Smooth surfaces are specular: 1 - roughness for PBR materials, and the
+    // usual roughness of a Phong exponent, sqrt(2 / (n + 2)), otherwise
+    float specular = 0.0f;
+    float roughness = 1.0f;
+    float shininess = 0.0f;
+    bool hasRoughness = false;
+#ifdef AI_MATKEY_ROUGHNESS_FACTOR
+    hasRoughness = material.Get(AI_MATKEY_ROUGHNESS_FACTOR, roughness) == AI_SUCCESS;
+#endif
+    if (hasRoughness) {
+        specular = 1.0f - roughness;
+    }
+    else if (material.Get(AI_MATKEY_SHININESS, shininess) == AI_SUCCESS && shininess > 0.0f) {
+        specular = 1.0f - std::sqrt(2.0f / (shininess + 2.0f));
+    }
+    specular = std::clamp(specular, 0.0f, 1.0f);
+
+    return std::make_shared<Material>(glm::vec3(color.r, color.g, color.b), emissionColor, emissionStrength, specular);
+}
+
+}
+
+void ImportReport::print(std::ostream& out, const std::string& name) const {
+    out << "Import [" << name << "]: " << fileBytes / 1024 << " KiB file, "
+        << vertexCount << " vertices, " << triangleCount << " triangles, "
+        << materialCount << " materials, " << memoryBytes / 1024 << " KiB in memory, "
+        << "imported in " << importMs << " ms, converted in " << convertMs << " ms" << std::endl;
+}
+
+bool AssimpImporter::canImport(const std::string& path) {
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) {
+        return (char)std::tolower(c);
+    });
+    if (extension.empty() || extension == ".obj") {
+        return false;
+    }
+    if (extension == ".gltf" || extension == ".glb" || extension == ".fbx" || extension == ".ply") {
+        return true;
+    }
+    return Assimp::Importer().IsExtensionSupported(extension.c_str());
+}
+
+bool AssimpImporter::isSelfContained(const std::string& path) {
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) {
+        return (char)std::tolower(c);
+    });
+    return extension == ".glb" || extension == ".fbx" || extension == ".ply";
+}
+
+ImportedModel AssimpImporter::import(const std::string& path, bool merge) {
+    ImportedModel model;
+    ImportReport& report = model.report;
+    std::error_code error;
+    report.fileBytes = std::filesystem::file_size(path, error);
+
+    auto start = clock::now();
+    Assimp::Importer importer;
+    importer.SetPropertyInteger(AI_CONFIG_PP_SBP_REMOVE, aiPrimitiveType_POINT | aiPrimitiveType_LINE);
+    const unsigned int flags = aiProcess_JoinIdenticalVertices
+        | aiProcess_Triangulate
+        | aiProcess_ImproveCacheLocality
+        | aiProcess_GenSmoothNormals
+        | aiProcess_PreTransformVertices
+        | aiProcess_SortByPType;
+    const aiScene* scene = importer.ReadFile(path, flags);
+    if (scene == nullptr || (scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) || scene->mRootNode == nullptr) {
+        throw std::runtime_error("Failed to import " + path + ": " + importer.GetErrorString());
+    }
+    report.importMs = millisecondsSince(start);
+
+    start = clock::now();
+    // PreTransformVertices already joins the meshes of a material, grouping
+    // again is for the merged model
+    std::map<unsigned int, std::vector<const aiMesh*>> groups;
+    for (unsigned int i = 0; i < scene->mNumMeshes; i++) {
+        const aiMesh* mesh = scene->mMeshes[i];
+        if (mesh->mNumFaces > 0) {
+            groups[merge ? 0 : mesh->mMaterialIndex].push_back(mesh);
+        }
+    }
+    if (groups.empty()) {
+        throw std::runtime_error("Failed to import " + path + ": no triangles");
+    }
+
+    for (const auto& [materialIndex, meshes] : groups) {
+        const bool withTexCoords = std::any_of(meshes.begin(), meshes.end(), [](const aiMesh* mesh) {
+            return mesh->HasTextureCoords(0);
+        });
+        Geometry geometry;
+        for (const aiMesh* mesh : meshes) {
+            appendMesh(*mesh, withTexCoords, geometry);
+        }
+        report.vertexCount += geometry.vertices.size();
+        report.triangleCount += geometry.indices.size() / 3;
+
+        ImportedPart part;
+        if (!merge && materialIndex < scene->mNumMaterials) {
+            const aiMaterial& material = *scene->mMaterials[materialIndex];
+            part.name = materialName(material, materialIndex);
+            part.material = convertMaterial(material);
+        }
+        std::vector<unsigned int> texIndices;
+        if (withTexCoords) {
+            texIndices = geometry.indices;
+        }
+        std::vector<unsigned int> normalIndices = geometry.indices;
+        part.mesh = MeshBuilder::createMesh(part.name.empty() ? path : path + " [" + part.name + "]",
+            std::move(geometry.vertices), std::move(geometry.normals), std::move(geometry.texCoords),
+            std::move(geometry.indices), std::move(normalIndices), std::move(texIndices));
+        report.memoryBytes += part.mesh->getMemoryBytes();
+        model.parts.push_back(std::move(part));
+    }
+    report.materialCount = merge ? 0 : model.parts.size();
+    report.convertMs = millisecondsSince(start);
+    return model;
+}
@@ -0,0 +1,61 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#ifndef ASSIMPIMPORTER_H
+#define ASSIMPIMPORTER_H
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "../Material.h"
+#include "../ObjectClasses/Mesh.h"
+
+// One material's worth of geometry of an imported file
+struct ImportedPart {
+    std::string name;
+    std::shared_ptr<Mesh> mesh;
+    std::shared_ptr<Material> material;
+};
+
+struct ImportReport {
+    // Assimp's read and post-processing, then building our meshes and BVHs
+    double importMs = 0.0;
+    double convertMs = 0.0;
+    size_t fileBytes = 0;
+    size_t vertexCount = 0;
+    size_t triangleCount = 0;
+    size_t materialCount = 0;
+    // Every array of the resulting meshes
+    size_t memoryBytes = 0;
+
+    void print(std::ostream& out, const std::string& name) const;
+};
+
+struct ImportedModel {
+    std::vector<ImportedPart> parts;
+    ImportReport report;
+};
+
+// Loads the formats Assimp reads (glTF, FBX, PLY and the rest). Node
+// transforms are baked into the vertices, and vertices are welded,
+// triangulated, reordered for the post-transform cache and given smooth
+// normals where the file has none. Points and lines are dropped.
+class AssimpImporter {
+public:
+    // glTF, GLB, FBX and PLY, plus whatever else the linked Assimp supports,
+    // except OBJ which has its own parser
+    [[nodiscard]] static bool canImport(const std::string& path);
+    // Whether the geometry is all in the file itself (GLB, FBX, PLY). A
+    // .gltf and most other formats can load buffers from other files, which
+    // MeshCache's check of the source file wouldn't see change.
+    [[nodiscard]] static bool isSelfContained(const std::string& path);
+
+    // One part per material, or a single part with everything and no
+    // material when merge is set. Throws std::runtime_error with Assimp's
+    // message when the file can't be imported.
+    static ImportedModel import(const std::string& path, bool merge = false);
+};
+
+#endif //ASSIMPIMPORTER_H
@@ -0,0 +1,521 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#include "Benchmark.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+
+#include "MeshBuilder.h"
+#include "MeshCache.h"
+#include "ObjParser.h"
+#include "ThreadPool.h"
+
+void benchmarkCPURender(Scene& scene, const RenderSettings& settings, std::vector<unsigned int> threadCounts) {
+    if (threadCounts.empty()) {
+        unsigned int maxThreads = ThreadPool::defaultThreadCount();
+        for (unsigned int count = 1; count < maxThreads; count *= 2) {
+            threadCounts.push_back(count);
+        }
+        threadCounts.push_back(maxThreads);
+    }
+
+    printf("CPU render benchmark: %dx%d, %d spp, %d bounces\n",
+        settings.width, settings.height, scene.ray_per_pixel1(), scene.max_ray_bounce1());
+    printf("%8s %12s %14s %10s %12s\n", "threads", "time (s)", "Mrays/s", "speedup", "efficiency");
+
+    double baseRate = 0.0;
+    unsigned int baseThreads = 0;
+    for (unsigned int threads : threadCounts) {
+        RenderSettings runSettings = settings;
+        runSettings.threadCount = threads;
+        runSettings.onProgress = nullptr;
+        scene.render(runSettings);
+
+        const RenderStats& stats = scene.getLastRenderStats();
+        double rate = stats.raysPerSecond();
+        if (baseThreads == 0) {
+            baseRate = rate;
+            baseThreads = threads;
+        }
+        double speedup = baseRate > 0.0 ? rate / baseRate : 0.0;
+        double efficiency = speedup * baseThreads / threads;
+        printf("%8u %12.3f %14.3f %9.2fx %11.1f%%\n",
+            threads, stats.seconds, rate / 1e6, speedup, efficiency * 100.0);
+    }
+}
+
+void benchmarkObjectScaling(const std::vector<size_t>& objectCounts, int rayCount) {
+    using clock = std::chrono::steady_clock;
+
+    printf("Object scaling benchmark: %d rays per scene\n", rayCount);
+    printf("%10s %12s %14s %10s %10s %14s\n", "objects", "build (ms)", "refit 1% (ms)", "ns/ray", "hit rate", "ns/ray/log2(N)");
+
+    auto material = std::make_shared<Material>(glm::vec3(0.8f), glm::vec3(0.0f), 0.0f, 0.0f);
+
+    for (size_t objectCount : objectCounts) {
+        std::mt19937 generator(1234);
+
+        // Constant density: the box grows with the object count so a ray
+        // crosses about the same number of objects before it hits something
+        float halfSize = 2.0f * std::cbrt((float)objectCount);
+        std::uniform_real_distribution<float> position(-halfSize, halfSize);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+        Scene scene(1, 1, nullptr);
+        scene.getSpheres().reserve(objectCount);
+        for (size_t i = 0; i < objectCount; i++) {
+            scene.getSpheres().emplace_back(
+                0.5f,
+                glm::vec3(position(generator), position(generator), position(generator)),
+                glm::vec3(0.0f),
+                glm::vec3(1.0f),
+                material
+            );
+        }
+
+        auto buildStart = clock::now();
+        scene.updateAccelerationStructure();
+        auto buildEnd = clock::now();
+
+        // Nudge 1% of the objects, only their bounds get recomputed before the refit
+        size_t movedCount = std::max<size_t>(1, objectCount / 100);
+        for (size_t i = 0; i < movedCount; i++) {
+            SphereObject& sphere = scene.getSpheres()[(i * 7919) % objectCount];
+            sphere.setPosition(sphere.getPosition() + glm::vec3(0.1f, 0.0f, 0.0f));
+        }
+        auto refitStart = clock::now();
+        scene.updateAccelerationStructure();
+        auto refitEnd = clock::now();
+
+        int hits = 0;
+        auto traceStart = clock::now();
+        for (int i = 0; i < rayCount; i++) {
+            glm::vec3 origin(position(generator), position(generator), position(generator));
+            glm::vec3 direction(unit(generator), unit(generator), unit(generator));
+            Ray ray(origin, glm::normalize(direction));
+            if (scene.intersectScene(ray).hit) {
+                hits++;
+            }
+        }
+        auto traceEnd = clock::now();
+
+        double buildMs = std::chrono::duration<double, std::milli>(buildEnd - buildStart).count();
+        double refitMs = std::chrono::duration<double, std::milli>(refitEnd - refitStart).count();
+        double nsPerRay = std::chrono::duration<double, std::nano>(traceEnd - traceStart).count() / rayCount;
+        double logN = std::max(1.0, std::log2((double)objectCount));
+        printf("%10zu %12.3f %14.3f %10.1f %9.1f%% %14.2f\n",
+            objectCount, buildMs, refitMs, nsPerRay, 100.0 * hits / rayCount, nsPerRay / logN);
+    }
+}
+
+void benchmarkPacketTracing(Scene& scene, const RenderSettings& settings) {
+    std::vector<SimdLevel> levels = {SimdLevel::Scalar};
+    for (SimdLevel level : {SimdLevel::AVX2, SimdLevel::AVX512}) {
+        if (resolveSimdLevel(level) == level) {
+            levels.push_back(level);
+        }
+    }
+
+    printf("Packet tracing benchmark: %dx%d, %d spp, best supported: %s\n",
+        settings.width, settings.height, scene.ray_per_pixel1(), simdLevelName(detectSimdLevel()));
+    printf("%10s %8s %8s %12s %14s %10s\n", "mode", "width", "bounces", "time (s)", "Mrays/s", "speedup");
+
+    for (int bounces : {1, scene.max_ray_bounce1()}) {
+        double scalarRate = 0.0;
+        for (SimdLevel level : levels) {
+            RenderSettings runSettings = settings;
+            runSettings.packetSimd = level;
+            runSettings.maxBounces = bounces;
+            runSettings.onProgress = nullptr;
+            scene.render(runSettings);
+
+            const RenderStats& stats = scene.getLastRenderStats();
+            double rate = stats.raysPerSecond();
+            if (level == SimdLevel::Scalar) {
+                scalarRate = rate;
+            }
+            printf("%10s %8d %8d %12.3f %14.3f %9.2fx\n",
+                simdLevelName(stats.simdLevel), simdLevelWidth(stats.simdLevel), bounces,
+                stats.seconds, rate / 1e6, scalarRate > 0.0 ? rate / scalarRate : 0.0);
+        }
+    }
+}
+
+static double imageRMSE(const std::vector<glm::vec3>& image, const std::vector<glm::vec3>& reference) {
+    double sum = 0.0;
+    for (size_t i = 0; i < image.size(); i++) {
+        glm::vec3 difference = image[i] - reference[i];
+        sum += glm::dot(difference, difference) / 3.0;
+    }
+    return image.empty() ? 0.0 : std::sqrt(sum / (double)image.size());
+}
+
+void benchmarkSamplers(Scene& scene, const RenderSettings& settings, int referenceSamples) {
+    RenderSettings referenceSettings = settings;
+    referenceSettings.onProgress = nullptr;
+    referenceSettings.sampler = SamplerType::Sobol;
+    referenceSettings.samplesPerPixel = referenceSamples;
+    // A different seed keeps the reference independent of the tested renders
+    referenceSettings.seed = settings.seed + 1;
+    const std::vector<glm::vec3> reference = scene.render(referenceSettings);
+
+    printf("Sampler benchmark: %dx%d, %d bounces, reference %d spp (%.2f s)\n",
+        settings.width, settings.height, scene.max_ray_bounce1(), referenceSamples, scene.getLastRenderStats().seconds);
+    printf("%6s %14s %14s %10s\n", "spp", "independent", "Sobol", "ratio");
+
+    for (int samples = 1; samples <= referenceSamples / 4; samples *= 2) {
+        double errors[2];
+        int i = 0;
+        for (SamplerType type : {SamplerType::Independent, SamplerType::Sobol}) {
+            RenderSettings runSettings = settings;
+            runSettings.onProgress = nullptr;
+            runSettings.sampler = type;
+            runSettings.samplesPerPixel = samples;
+            errors[i++] = imageRMSE(scene.render(runSettings), reference);
+        }
+        printf("%6d %14.5f %14.5f %9.2fx\n", samples, errors[0], errors[1], errors[1] > 0.0 ? errors[0] / errors[1] : 0.0);
+    }
+
+    // Every random number depends on the pixel and the sample, so the thread
+    // count must not change a single pixel
+    RenderSettings determinismSettings = settings;
+    determinismSettings.onProgress = nullptr;
+    determinismSettings.samplesPerPixel = 4;
+    determinismSettings.threadCount = 1;
+    const std::vector<glm::vec3> singleThreaded = scene.render(determinismSettings);
+    determinismSettings.threadCount = std::max(2u, ThreadPool::defaultThreadCount());
+    const std::vector<glm::vec3> multiThreaded = scene.render(determinismSettings);
+    bool identical = singleThreaded == multiThreaded;
+    printf("Deterministic across 1 and %u threads: %s\n", determinismSettings.threadCount, identical ? "yes" : "NO");
+}
+
+void benchmarkAdaptiveSampling(Scene& scene, const RenderSettings& settings, int referenceSamples) {
+    RenderSettings referenceSettings = settings;
+    referenceSettings.onProgress = nullptr;
+    referenceSettings.samplesPerPixel = referenceSamples;
+    referenceSettings.adaptiveMaxSamples = 0;
+    referenceSettings.seed = settings.seed + 1;
+    const std::vector<glm::vec3> reference = scene.render(referenceSettings);
+
+    printf("Adaptive sampling benchmark: %dx%d, %d bounces, reference %d spp (%.2f s)\n",
+        settings.width, settings.height, scene.max_ray_bounce1(), referenceSamples, scene.getLastRenderStats().seconds);
+    printf("%18s %10s %12s %10s %16s\n", "mode", "avg spp", "time (s)", "RMSE", "equal quality");
+
+    struct Run {
+        double seconds;
+        double error;
+    };
+    std::vector<Run> fixedRuns;
+    const double pixelCount = (double)settings.width * settings.height;
+    for (int samples = 8; samples <= referenceSamples / 4; samples *= 2) {
+        RenderSettings runSettings = settings;
+        runSettings.onProgress = nullptr;
+        runSettings.samplesPerPixel = samples;
+        runSettings.adaptiveMaxSamples = 0;
+        double error = imageRMSE(scene.render(runSettings), reference);
+        const RenderStats& stats = scene.getLastRenderStats();
+        fixedRuns.push_back({stats.seconds, error});
+        printf("%12s %5d %10.1f %12.3f %10.5f\n", "fixed", samples, (double)stats.samples / pixelCount, stats.seconds, error);
+    }
+
+    for (float targetError : {0.08f, 0.04f, 0.02f}) {
+        RenderSettings runSettings = settings;
+        runSettings.onProgress = nullptr;
+        runSettings.samplesPerPixel = 8;
+        runSettings.adaptiveMaxSamples = referenceSamples / 4;
+        runSettings.adaptiveError = targetError;
+        double error = imageRMSE(scene.render(runSettings), reference);
+        const RenderStats& stats = scene.getLastRenderStats();
+
+        // Cheapest fixed render at least as good, if there is one
+        double fixedSeconds = 0.0;
+        for (const Run& run : fixedRuns) {
+            if (run.error <= error) {
+                fixedSeconds = run.seconds;
+                break;
+            }
+        }
+        printf("%12s %5.3f %10.1f %12.3f %10.5f", "adaptive", targetError, (double)stats.samples / pixelCount, stats.seconds, error);
+        if (fixedSeconds > 0.0) {
+            printf(" %9.3f s (%.2fx)\n", fixedSeconds, fixedSeconds / stats.seconds);
+        }
+        else {
+            printf(" %16s\n", "-");
+        }
+    }
+}
+
+// Sphere with a bumpy radius, (stacks x slices x 2) triangles. Big enough to
+// need a deep BVH and not as regular as a flat grid.
+static std::shared_ptr<Mesh> buildBumpySphere(size_t triangleCount) {
+    const int stacks = std::max(2, (int)std::sqrt((double)triangleCount / 4.0));
+    const int slices = std::max(3, (int)(triangleCount / (2 * stacks)));
+    constexpr float PI = 3.14159265358979f;
+
+    std::vector<glm::vec3> vertices;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> texCoords;
+    for (int stack = 0; stack <= stacks; stack++) {
+        float theta = PI * (float)stack / (float)stacks;
+        for (int slice = 0; slice <= slices; slice++) {
+            float phi = 2.0f * PI * (float)slice / (float)slices;
+            glm::vec3 direction(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+            float radius = 1.0f + 0.1f * std::sin(13.0f * theta) * std::sin(17.0f * phi);
+            vertices.push_back(direction * radius);
+            normals.push_back(direction);
+            texCoords.emplace_back((float)slice / (float)slices, (float)stack / (float)stacks);
+        }
+    }
+
+    std::vector<unsigned int> indices;
+    indices.reserve((size_t)stacks * slices * 6);
+    const unsigned int rowSize = slices + 1;
+    for (int stack = 0; stack < stacks; stack++) {
+        for (int slice = 0; slice < slices; slice++) {
+            unsigned int a = stack * rowSize + slice;
+            unsigned int b = a + rowSize;
+            indices.insert(indices.end(), {a, b, a + 1, a + 1, b, b + 1});
+        }
+    }
+
+    std::vector<unsigned int> normalIndices = indices;
+    std::vector<unsigned int> texIndices = indices;
+    return MeshBuilder::createMesh("bumpy sphere", std::move(vertices), std::move(normals), std::move(texCoords),
+        std::move(indices), std::move(normalIndices), std::move(texIndices));
+}
+
+void benchmarkBVHLayouts(const std::string& meshFile, size_t syntheticTriangles, int rayCount) {
+    using clock = std::chrono::steady_clock;
+
+    std::vector<std::pair<std::string, std::shared_ptr<Mesh>>> meshes = {
+        {meshFile, MeshBuilder::getMesh(meshFile)},
+        {std::to_string(syntheticTriangles / 1000) + "k synthetic", buildBumpySphere(syntheticTriangles)},
+    };
+
+    printf("BVH layout benchmark: %d rays per mesh\n", rayCount);
+    printf("%-28s %8s %10s %12s %14s %10s %10s %10s\n",
+        "mesh", "layout", "nodes", "memory (KiB)", "collapse (ms)", "ns/ray", "hit rate", "speedup");
+
+    auto material = std::make_shared<Material>(glm::vec3(0.8f), glm::vec3(0.0f), 0.0f, 0.0f);
+
+    for (auto& [name, mesh] : meshes) {
+        MeshObject object(glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(1.0f), material);
+        object.setMesh(mesh);
+
+        // Rays from a sphere around the mesh towards random points of its
+        // bounds, the same ones for every layout
+        std::mt19937 generator(4321);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        std::uniform_real_distribution<float> inside(0.0f, 1.0f);
+        const glm::vec3 center = (mesh->getMin() + mesh->getMax()) * 0.5f;
+        const glm::vec3 extent = mesh->getMax() - mesh->getMin();
+        const float distance = glm::length(extent) * 1.5f;
+        std::vector<std::pair<glm::vec3, glm::vec3>> rays(rayCount);
+        for (auto& [origin, direction] : rays) {
+            glm::vec3 offset(unit(generator), unit(generator), unit(generator));
+            origin = center + glm::normalize(offset) * distance;
+            glm::vec3 target = mesh->getMin() + extent * glm::vec3(inside(generator), inside(generator), inside(generator));
+            direction = glm::normalize(target - origin);
+        }
+
+        double binaryNsPerRay = 0.0;
+        for (BVHLayout layout : {BVHLayout::Binary, BVHLayout::Wide4, BVHLayout::Wide8}) {
+            mesh->setBVHLayout(layout);
+
+            size_t nodeCount = mesh->getBVH().getStats().nodeCount;
+            size_t memoryBytes = nodeCount * sizeof(BVHNode);
+            double collapseMs = 0.0;
+            if (layout == BVHLayout::Wide4) {
+                const WideBVHStats& stats = mesh->getBVH4().getStats();
+                nodeCount = stats.nodeCount;
+                memoryBytes = stats.memoryBytes;
+                collapseMs = stats.buildTimeMs;
+            }
+            else if (layout == BVHLayout::Wide8) {
+                const WideBVHStats& stats = mesh->getBVH8().getStats();
+                nodeCount = stats.nodeCount;
+                memoryBytes = stats.memoryBytes;
+                collapseMs = stats.buildTimeMs;
+            }
+
+            int hits = 0;
+            auto traceStart = clock::now();
+            for (const auto& [origin, direction] : rays) {
+                Ray ray(origin, direction);
+                HitInfo hit;
+                hit.hit = false;
+                hit.hitDist = std::numeric_limits<float>::max();
+                object.intersectAs<MeshObject>(ray, hit);
+                if (hit.hit) {
+                    hits++;
+                }
+            }
+            auto traceEnd = clock::now();
+
+            double nsPerRay = std::chrono::duration<double, std::nano>(traceEnd - traceStart).count() / rayCount;
+            if (layout == BVHLayout::Binary) {
+                binaryNsPerRay = nsPerRay;
+            }
+            printf("%-28s %8s %10zu %12zu %14.3f %10.1f %9.1f%% %9.2fx\n",
+                name.c_str(), bvhLayoutName(layout), nodeCount, memoryBytes / 1024, collapseMs,
+                nsPerRay, 100.0 * hits / rayCount, binaryNsPerRay / nsPerRay);
+        }
+        mesh->setBVHLayout(BVHLayout::Binary);
+    }
+}
+
+// OBJ with v/vt/vn faces, the format MeshBuilder reads. Written from the
+// packed vertices, each one a position and normal with the same index.
+static void writeOBJ(const std::string& path, const Mesh& mesh) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == NULL) {
+        throw std::runtime_error("Failed to create " + path);
+    }
+    for (uint32_t vertex = 0; vertex < mesh.getPackedVertexCount(); vertex++) {
+        glm::vec3 v = mesh.getPackedPosition(vertex);
+        fprintf(file, "v %f %f %f\n", v.x, v.y, v.z);
+    }
+    for (const glm::vec2& uv : mesh.getUvs()) {
+        fprintf(file, "vt %f %f\n", uv.x, uv.y);
+    }
+    for (uint32_t vertex = 0; vertex < mesh.getPackedVertexCount(); vertex++) {
+        glm::vec3 n = mesh.getPackedNormal(vertex);
+        fprintf(file, "vn %f %f %f\n", n.x, n.y, n.z);
+    }
+    std::span<const uint32_t> indices = mesh.getPackedIndices();
+    std::span<const unsigned int> texIndices = mesh.getTexIndices();
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        fprintf(file, "f");
+        for (size_t corner = i; corner < i + 3; corner++) {
+            if (texIndices.empty()) {
+                fprintf(file, " %u//%u", indices[corner] + 1, indices[corner] + 1);
+            }
+            else {
+                fprintf(file, " %u/%u/%u", indices[corner] + 1, texIndices[corner] + 1, indices[corner] + 1);
+            }
+        }
+        fprintf(file, "\n");
+    }
+    fclose(file);
+}
+
+// Time of rayCount random rays towards the mesh, the first ones through a
+// freshly mapped cache also pay for reading its pages
+static double traceRandomRays(const std::shared_ptr<Mesh>& mesh, int rayCount) {
+    auto material = std::make_shared<Material>(glm::vec3(0.8f), glm::vec3(0.0f), 0.0f, 0.0f);
+    MeshObject object(glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(1.0f), material);
+    object.setMesh(mesh);
+
+    std::mt19937 generator(1234);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    const glm::vec3 center = (mesh->getMin() + mesh->getMax()) * 0.5f;
+    const float distance = glm::length(mesh->getMax() - mesh->getMin()) * 1.5f;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rayCount; i++) {
+        glm::vec3 origin = center + glm::normalize(glm::vec3(unit(generator), unit(generator), unit(generator))) * distance;
+        glm::vec3 target = center + glm::vec3(unit(generator), unit(generator), unit(generator)) * 0.5f;
+        Ray ray(origin, glm::normalize(target - origin));
+        HitInfo hit;
+        hit.hit = false;
+        hit.hitDist = std::numeric_limits<float>::max();
+        object.intersectAs<MeshObject>(ray, hit);
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void benchmarkMeshCache(size_t triangleCount, int rayCount) {
+    using clock = std::chrono::steady_clock;
+    auto millisecondsSince = [](clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    };
+
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "pt_mesh_cache_benchmark";
+    std::filesystem::create_directories(directory);
+    const std::string parsedFile = (directory / "parsed.obj").string();
+    const std::string cachedFile = (directory / "cached.obj").string();
+    std::filesystem::remove(MeshCache::cachePath(cachedFile));
+
+    std::shared_ptr<Mesh> generated = buildBumpySphere(triangleCount);
+    writeOBJ(parsedFile, *generated);
+    std::filesystem::copy_file(parsedFile, cachedFile, std::filesystem::copy_options::overwrite_existing);
+    const double sourceMB = (double)std::filesystem::file_size(parsedFile) / (1024.0 * 1024.0);
+
+    const bool wasEnabled = MeshCache::isEnabled();
+    MeshCache::setEnabled(false);
+    auto start = clock::now();
+    std::shared_ptr<Mesh> parsed = MeshBuilder::getMesh(parsedFile);
+    const double parseMs = millisecondsSince(start);
+
+    MeshCache::setEnabled(true);
+    start = clock::now();
+    MeshBuilder::getMesh(cachedFile);
+    const double writeMs = millisecondsSince(start);
+    const double cacheMB = (double)std::filesystem::file_size(MeshCache::cachePath(cachedFile)) / (1024.0 * 1024.0);
+
+    start = clock::now();
+    std::shared_ptr<Mesh> mapped = MeshCache::load(cachedFile, MeshBuilder::getVertexFormat());
+    const double mapMs = millisecondsSince(start);
+    if (!mapped) {
+        throw std::runtime_error("The mesh cache of " + cachedFile + " wasn't used");
+    }
+
+    // A new modification time with the same content takes the hash check
+    std::filesystem::last_write_time(cachedFile, std::filesystem::file_time_type::clock::now());
+    start = clock::now();
+    const bool rehashed = MeshCache::load(cachedFile, MeshBuilder::getVertexFormat()) != nullptr;
+    const double hashMs = millisecondsSince(start);
+    MeshCache::setEnabled(wasEnabled);
+
+    const double parsedTraceMs = traceRandomRays(parsed, rayCount);
+    const double mappedTraceMs = traceRandomRays(mapped, rayCount);
+    const double mappedWarmTraceMs = traceRandomRays(mapped, rayCount);
+
+    printf("Mesh cache benchmark: %zu triangles, %.1f MiB OBJ, %.1f MiB cache\n",
+        parsed->getTriangleCount(), sourceMB, cacheMB);
+    printf("  parse OBJ + build BVH:   %10.2f ms\n", parseMs);
+    printf("  same, then write cache:  %10.2f ms\n", writeMs);
+    printf("  map cache:               %10.3f ms (%.0fx faster than parsing)\n", mapMs, parseMs / mapMs);
+    printf("  map after touch (hash):  %10.3f ms (%s)\n", hashMs, rehashed ? "reused" : "rebuilt");
+    printf("  %d rays, parsed mesh:  %10.2f ms\n", rayCount, parsedTraceMs);
+    printf("  %d rays, mapped cold:  %10.2f ms\n", rayCount, mappedTraceMs);
+    printf("  %d rays, mapped warm:  %10.2f ms\n", rayCount, mappedWarmTraceMs);
+
+    std::filesystem::remove_all(directory);
+}
+
+void benchmarkObjParser(size_t triangleCount, std::vector<unsigned int> threadCounts) {
+    if (threadCounts.empty()) {
+        for (unsigned int threads = 1; threads <= ThreadPool::defaultThreadCount(); threads *= 2) {
+            threadCounts.push_back(threads);
+        }
+    }
+
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "pt_obj_benchmark";
+    std::filesystem::create_directories(directory);
+    const std::string file = (directory / "bumpy.obj").string();
+    writeOBJ(file, *buildBumpySphere(triangleCount));
+
+    // Read once so every run finds the file in the page cache
+    ObjParser::parse(file);
+
+    printf("OBJ parser benchmark: %.1f MB\n", (double)std::filesystem::file_size(file) / 1e6);
+    printf("%8s %8s %12s %10s %10s\n", "threads", "chunks", "time (ms)", "MB/s", "speedup");
+    double firstMs = 0.0;
+    for (unsigned int threads : threadCounts) {
+        ObjParseStats stats;
+        ObjParser::parse(file, threads, &stats);
+        if (firstMs == 0.0) {
+            firstMs = stats.parseMs;
+        }
+        printf("%8u %8zu %12.1f %10.0f %9.2fx\n",
+            stats.threadCount, stats.chunkCount, stats.parseMs, stats.megabytesPerSecond(), firstMs / stats.parseMs);
+    }
+
+    std::filesystem::remove_all(directory);
+}
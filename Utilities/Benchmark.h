@@ -0,0 +1,60 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+#include <string>
+#include <vector>
+
+#include "../Scene.h"
+
+// Renders the scene once per thread count and prints rays/sec, speedup over
+// the first entry and parallel efficiency. An empty list benchmarks every
+// power of two up to the hardware thread count.
+void benchmarkCPURender(Scene& scene, const RenderSettings& settings, std::vector<unsigned int> threadCounts = {});
+
+// Scatters N spheres at constant density for every N in objectCounts and
+// times Scene::intersectScene on random rays, plus the top level BVH build and
+// the refit after moving 1% of the objects. With the TLAS the cost per ray
+// should follow log2(N) rather than N.
+void benchmarkObjectScaling(const std::vector<size_t>& objectCounts = {10, 100, 1000, 10000, 100000}, int rayCount = 200000);
+
+// Renders the scene with scalar rays and with every packet width the CPU
+// supports, first primary rays only (where packets help) then full paths
+// (where only the first hit is traced in packets). Prints rays/sec and the
+// speedup over scalar for both.
+void benchmarkPacketTracing(Scene& scene, const RenderSettings& settings);
+
+// Traces the same random rays through meshFile and a generated mesh of about
+// syntheticTriangles triangles with each BVH layout. Prints node count,
+// memory, collapse time, ns/ray and the speedup over the binary BVH.
+void benchmarkBVHLayouts(const std::string& meshFile = "Assets/Meshes/ghorn.obj", size_t syntheticTriangles = 1000000, int rayCount = 200000);
+
+// Renders a referenceSamples spp image with the Sobol sampler, then compares
+// renders at increasing sample counts with each sampler against it. Prints
+// the RMSE per sample count and checks that the image is the same for every
+// thread count.
+void benchmarkSamplers(Scene& scene, const RenderSettings& settings, int referenceSamples = 256);
+
+// Renders with fixed sample counts and with adaptive sampling at decreasing
+// error targets, both against a referenceSamples spp render. Prints average
+// spp, time and RMSE, and for each adaptive render the time of the cheapest
+// fixed render of equal or better quality. Leaves the sample counts of the
+// last adaptive render in scene.getSampleCounts().
+void benchmarkAdaptiveSampling(Scene& scene, const RenderSettings& settings, int referenceSamples = 1024);
+
+// Writes a generated OBJ of about triangleCount triangles and times loading
+// it by parsing, by parsing and writing its MeshCache file, by mapping the
+// cache, and by mapping it after the source's time changed (the content hash
+// check). Then traces rayCount rays through the parsed mesh and, twice,
+// through the mapped one, the first time paying for the page faults.
+void benchmarkMeshCache(size_t triangleCount = 1000000, int rayCount = 100000);
+
+// Writes a generated OBJ of about triangleCount triangles (3M is around
+// 300 MB) and parses it once per thread count, printing MB/s and the speedup
+// over the first entry. An empty list benchmarks every power of two up to the
+// hardware thread count.
+void benchmarkObjParser(size_t triangleCount = 3000000, std::vector<unsigned int> threadCounts = {});
+
+#endif //BENCHMARK_H
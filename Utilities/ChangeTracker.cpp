@@ -0,0 +1,42 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#include "ChangeTracker.h"
+
+#include <algorithm>
+
+void ChangeTracker::reset(size_t count) {
+    marked.assign(count, 0);
+    indices.clear();
+}
+
+void ChangeTracker::mark(uint32_t index) {
+    if (index < marked.size() && !marked[index]) {
+        marked[index] = 1;
+        indices.push_back(index);
+    }
+}
+
+std::vector<uint32_t> ChangeTracker::take() {
+    std::vector<uint32_t> taken;
+    taken.swap(indices);
+    for (uint32_t index : taken) {
+        marked[index] = 0;
+    }
+    std::sort(taken.begin(), taken.end());
+    return taken;
+}
+
+std::vector<ChangeTracker::Range> ChangeTracker::coalesce(std::span<const uint32_t> sorted, uint32_t maxGap) {
+    std::vector<Range> ranges;
+    for (uint32_t index : sorted) {
+        if (!ranges.empty() && index - ranges.back().last <= maxGap + 1) {
+            ranges.back().last = index;
+        }
+        else {
+            ranges.push_back({index, index});
+        }
+    }
+    return ranges;
+}
@@ -0,0 +1,43 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#ifndef CHANGETRACKER_H
+#define CHANGETRACKER_H
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Indices of the records changed since the last take(), each listed once.
+// Whoever mirrors a set of objects (the engine's SSBOs) hands them a tracker
+// and their index, their setters mark themselves, and a frame's update work
+// is then proportional to what changed instead of to the scene size.
+class ChangeTracker {
+public:
+    // Inclusive run of indices
+    struct Range {
+        uint32_t first, last;
+    };
+
+    // Sets the number of records and forgets every mark
+    void reset(size_t count);
+    void mark(uint32_t index);
+
+    [[nodiscard]] bool empty() const {
+        return indices.empty();
+    }
+    // The marked indices in ascending order, clears the marks
+    [[nodiscard]] std::vector<uint32_t> take();
+
+    // Merges ascending indices into runs. Runs separated by at most maxGap
+    // unmarked indices become one, since rewriting a few clean records is
+    // cheaper than another upload call.
+    [[nodiscard]] static std::vector<Range> coalesce(std::span<const uint32_t> sorted, uint32_t maxGap);
+
+private:
+    std::vector<uint8_t> marked;
+    std::vector<uint32_t> indices;
+};
+
+#endif //CHANGETRACKER_H
@@ -0,0 +1,54 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "ImageWriter.h"
+
+#include <cstdio>
+#include <filesystem>
+
+#include <glm/glm.hpp>
+
+#include "stb_image_write.h"
+
+bool writeImage(const std::string& path, int width, int height, const std::vector<glm::vec3>& pixels) {
+    if (pixels.size() != (size_t)width * height) {
+        printf("Can't write %s: %zu pixels for a %dx%d image\n", path.c_str(), pixels.size(), width, height);
+        return false;
+    }
+
+    // Both formats store the top row first
+    std::vector<unsigned char> image;
+    image.reserve(pixels.size() * 3);
+    for (int y = height - 1; y >= 0; y--) {
+        for (int x = 0; x < width; x++) {
+            glm::vec3 color = glm::clamp(pixels[y * width + x], glm::vec3(0, 0, 0), glm::vec3(1, 1, 1));
+            image.push_back(static_cast<unsigned char>(color.x * 255.999));
+            image.push_back(static_cast<unsigned char>(color.y * 255.999));
+            image.push_back(static_cast<unsigned char>(color.z * 255.999));
+        }
+    }
+
+    if (std::filesystem::path(path).extension() == ".png") {
+        if (!stbi_write_png(path.c_str(), width, height, 3, image.data(), width * 3)) {
+            printf("Failed to write %s\n", path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        perror("Failed to open file");
+        return false;
+    }
+    // P6 is the binary PPM, 255 the maximum color value
+    fprintf(file, "P6\n%d %d\n255\n", width, height);
+    bool written = fwrite(image.data(), 1, image.size(), file) == image.size();
+    fclose(file);
+    if (!written) {
+        printf("Failed to write %s\n", path.c_str());
+    }
+    return written;
+}
@@ -0,0 +1,18 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#ifndef IMAGEWRITER_H
+#define IMAGEWRITER_H
+#include <string>
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+// Writes an RGB image with values in [0, 1] (clamped), row 0 at the bottom
+// like Scene::render() and the GL textures. Paths ending in .png go through
+// stb_image_write, anything else is written as a binary PPM. Returns false
+// and prints the reason when the file can't be written.
+bool writeImage(const std::string& path, int width, int height, const std::vector<glm::vec3>& pixels);
+
+#endif //IMAGEWRITER_H
@@ -0,0 +1,98 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#include "MappedFile.h"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path) {
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Failed to open file " + path);
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        throw std::runtime_error("Failed to get the size of " + path);
+    }
+    fileHandle = file;
+    length = (size_t)fileSize.QuadPart;
+    // Empty files can't be mapped, they are just empty
+    if (length == 0) {
+        return;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        CloseHandle(file);
+        throw std::runtime_error("Failed to map " + path);
+    }
+    mappingHandle = mapping;
+    bytes = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (bytes == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        throw std::runtime_error("Failed to map " + path);
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (bytes) {
+        UnmapViewOfFile(bytes);
+    }
+    if (mappingHandle) {
+        CloseHandle((HANDLE)mappingHandle);
+    }
+    if (fileHandle) {
+        CloseHandle((HANDLE)fileHandle);
+    }
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) {
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        throw std::runtime_error("Failed to open file " + path);
+    }
+    struct stat status{};
+    if (fstat(file, &status) != 0) {
+        close(file);
+        throw std::runtime_error("Failed to get the size of " + path);
+    }
+    length = (size_t)status.st_size;
+    // Empty files can't be mapped, they are just empty
+    if (length > 0) {
+        void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file, 0);
+        if (address == MAP_FAILED) {
+            close(file);
+            throw std::runtime_error("Failed to map " + path);
+        }
+        bytes = (const unsigned char*)address;
+    }
+    // The mapping keeps its own reference to the file
+    close(file);
+}
+
+MappedFile::~MappedFile() {
+    if (bytes) {
+        munmap((void*)bytes, length);
+    }
+}
+
+#endif
@@ -0,0 +1,94 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+
+// Whole file mapped read only. Pages are only read from disk when touched.
+class MappedFile {
+public:
+    // Throws std::runtime_error when the file can't be opened or mapped
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    [[nodiscard]] const unsigned char* data() const {
+        return bytes;
+    }
+    [[nodiscard]] size_t size() const {
+        return length;
+    }
+
+private:
+    const unsigned char* bytes = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
+
+// Array that owns its elements, or views elements owned by someone else (a
+// mapped cache file) who has to keep them alive. Copies of a view are views.
+template<typename T>
+class MappedArray {
+public:
+    MappedArray() = default;
+    MappedArray(std::vector<T> elements) : owned(std::move(elements)) {}
+
+    [[nodiscard]] static MappedArray view(const T* elements, size_t count) {
+        MappedArray array;
+        array.external = elements;
+        array.externalCount = count;
+        return array;
+    }
+
+    [[nodiscard]] const T* data() const {
+        return external ? external : owned.data();
+    }
+    [[nodiscard]] size_t size() const {
+        return external ? externalCount : owned.size();
+    }
+    [[nodiscard]] bool empty() const {
+        return size() == 0;
+    }
+    [[nodiscard]] bool isView() const {
+        return external != nullptr;
+    }
+    const T& operator[](size_t index) const {
+        return data()[index];
+    }
+    [[nodiscard]] const T* begin() const {
+        return data();
+    }
+    [[nodiscard]] const T* end() const {
+        return data() + size();
+    }
+    [[nodiscard]] std::span<const T> span() const {
+        return {data(), size()};
+    }
+
+    // Elements to modify, copied out of the viewed memory first
+    std::vector<T>& edit() {
+        if (external) {
+            owned.assign(external, external + externalCount);
+            external = nullptr;
+            externalCount = 0;
+        }
+        return owned;
+    }
+
+private:
+    std::vector<T> owned;
+    const T* external = nullptr;
+    size_t externalCount = 0;
+};
+
+#endif //MAPPEDFILE_H
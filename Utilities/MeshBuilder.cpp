@@ -3,77 +3,136 @@
 //
 
 #include "MeshBuilder.h"
+#include "MeshCache.h"
+#include "ObjParser.h"
 #define GLM_ENABLE_EXPERIMENTAL
+#include <cstdio>
+#include <cstring>
 #include <set>
-#include <assimp/Importer.hpp>
-#include <assimp/scene.h>
-#include <assimp/postprocess.h>
+#include <sstream>
 #include <glm/gtx/hash.hpp>
 
-std::map<std::string, std::shared_ptr<Mesh>> MeshBuilder::meshCache;
+std::atomic<VertexFormat> MeshBuilder::vertexFormat = VertexFormat::Float;
+std::mutex MeshBuilder::cacheMutex;
+std::map<std::pair<std::string, VertexFormat>, std::shared_future<std::shared_ptr<Mesh>>> MeshBuilder::meshCache;
 
-std::shared_ptr<Mesh> MeshBuilder::buildMesh(const std::string &meshFile) {
-    std::vector<unsigned int> vertexIndices, uvIndices, normalIndices;
+std::shared_ptr<Mesh> MeshBuilder::getMesh(const std::string& filename, unsigned int threadCount) {
+    std::promise<std::shared_ptr<Mesh>> promise;
+    std::shared_future<std::shared_ptr<Mesh>> pending;
+    bool loading = false;
+    const std::pair<std::string, VertexFormat> key(filename, vertexFormat);
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto it = meshCache.find(key);
+        if (it != meshCache.end()) {
+            pending = it->second;
+        }
+        else {
+            pending = promise.get_future().share();
+            meshCache.emplace(key, pending);
+            loading = true;
+        }
+    }
+    if (!loading) {
+        // Loaded, or being loaded by another thread
+        return pending.get();
+    }
 
-    std::vector<glm::vec3> tempVertices;
-    std::vector<glm::vec2> tempUvs;
-    std::vector<glm::vec3> tempNormals;
+    try {
+        std::shared_ptr<Mesh> mesh = loadMesh(filename, threadCount);
+        promise.set_value(mesh);
+        return mesh;
+    }
+    catch (...) {
+        {
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            meshCache.erase(key);
+        }
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+}
 
-    FILE* file = fopen(meshFile.c_str(), "r");
-    if (file == NULL) {
-        throw std::runtime_error("Failed to open file " + meshFile);
+std::shared_ptr<Mesh> MeshBuilder::loadMesh(const std::string& meshFile, unsigned int threadCount) {
+    // The cache only checks the file itself, not the buffers a .gltf points to
+    const bool cacheable = !AssimpImporter::canImport(meshFile) || AssimpImporter::isSelfContained(meshFile);
+    if (!cacheable) {
+        return buildMesh(meshFile, threadCount);
+    }
+    if (std::shared_ptr<Mesh> cached = MeshCache::load(meshFile, vertexFormat)) {
+        printStats(*cached, meshFile + " (cached)");
+        return cached;
     }
 
-    while (1) {
-        char lineHeader[128];
-        int res = fscanf(file, "%s", lineHeader);
-        if (res == EOF) {
-            break;
-        }
-        if (strcmp(lineHeader, "v") == 0) {
-            glm::vec3 vertex;
-            fscanf(file, "%f %f %f", &vertex.x, &vertex.y, &vertex.z);
-            tempVertices.push_back(vertex);
-        }
-        else if (strcmp(lineHeader, "vt") == 0) {
-            glm::vec2 uv;
-            fscanf(file, "%f %f", &uv.x, &uv.y);
-            tempUvs.push_back(uv);
-        }
-        else if (strcmp(lineHeader, "vn") == 0) {
-            glm::vec3 normal;
-            fscanf(file, "%f %f %f", &normal.x, &normal.y, &normal.z);
-            tempNormals.push_back(normal);
-        }
-        else if (strcmp(lineHeader, "f") == 0) {
-            std::string vertex1, vertex2, vertex3;
-            unsigned int vertexIndex[3], uvIndex[3], normalIndex[3];
-            int matches = fscanf(file, "%d/%d/%d %d/%d/%d %d/%d/%d",
-                &vertexIndex[0],
-                &uvIndex[0],
-                &normalIndex[0],
-                &vertexIndex[1],
-                &uvIndex[1],
-                &normalIndex[1],
-                &vertexIndex[2],
-                &uvIndex[2],
-                &normalIndex[2]);
-            if (matches != 9) {
-                throw std::runtime_error("Failed to parse mesh file: <Incorrect face format> " + meshFile);
-            }
-            vertexIndices.emplace_back(vertexIndex[0] - 1);
-            vertexIndices.emplace_back(vertexIndex[1] - 1);
-            vertexIndices.emplace_back(vertexIndex[2] - 1);
-            uvIndices.emplace_back(uvIndex[0] - 1);
-            uvIndices.emplace_back(uvIndex[1] - 1);
-            uvIndices.emplace_back(uvIndex[2] - 1);
-            normalIndices.emplace_back(normalIndex[0] - 1);
-            normalIndices.emplace_back(normalIndex[1] - 1);
-            normalIndices.emplace_back(normalIndex[2] - 1);
-        }
+    std::shared_ptr<Mesh> mesh = buildMesh(meshFile, threadCount);
+    if (MeshCache::isEnabled() && !MeshCache::save(*mesh, meshFile)) {
+        printf("Can't write the mesh cache %s\n", MeshCache::cachePath(meshFile).c_str());
+    }
+    return mesh;
+}
+
+ImportedModel MeshBuilder::getModel(const std::string& filename, unsigned int threadCount) {
+    if (!AssimpImporter::canImport(filename)) {
+        ImportedModel model;
+        model.parts.push_back({"", getMesh(filename, threadCount), nullptr});
+        model.report.vertexCount = model.parts[0].mesh->getPackedVertexCount();
+        model.report.triangleCount = model.parts[0].mesh->getTriangleCount();
+        model.report.memoryBytes = model.parts[0].mesh->getMemoryBytes();
+        return model;
+    }
+
+    ImportedModel model = AssimpImporter::import(filename);
+    std::ostringstream report;
+    model.report.print(report, filename);
+    std::cout << report.str();
+    return model;
+}
+
+std::shared_ptr<Mesh> MeshBuilder::buildMesh(const std::string &meshFile, unsigned int threadCount) {
+    if (AssimpImporter::canImport(meshFile)) {
+        ImportedModel model = AssimpImporter::import(meshFile, true);
+        std::ostringstream report;
+        model.report.print(report, meshFile);
+        std::cout << report.str();
+        return model.parts[0].mesh;
     }
 
-    return std::make_shared<Mesh>(std::move(tempVertices), std::move(tempNormals), std::move(tempUvs),
-        std::move(vertexIndices), std::move(normalIndices), std::move(uvIndices));
+    ObjParseStats stats;
+    ObjData obj = ObjParser::parse(meshFile, threadCount, &stats);
+    printf("OBJ [%s]: %.1f MB in %.1f ms (%.0f MB/s) on %u threads, %zu faces, %zu triangles, %zu normals generated\n",
+        meshFile.c_str(), stats.bytes / 1e6, stats.parseMs, stats.megabytesPerSecond(), stats.threadCount,
+        stats.faceCount, stats.triangleCount, stats.generatedNormalCount);
+
+    return createMesh(meshFile, std::move(obj.vertices), std::move(obj.normals), std::move(obj.texCoords),
+        std::move(obj.vertexIndices), std::move(obj.normalIndices), std::move(obj.texIndices));
+}
+
+std::shared_ptr<Mesh> MeshBuilder::createMesh(const std::string& name,
+    std::vector<glm::vec3> vertices,
+    std::vector<glm::vec3> normals,
+    std::vector<glm::vec2> texCoords,
+    std::vector<unsigned int> vertexIndices,
+    std::vector<unsigned int> normalIndices,
+    std::vector<unsigned int> texIndices) {
+    auto mesh = std::make_shared<Mesh>(std::move(vertices), std::move(normals), std::move(texCoords),
+        std::move(vertexIndices), std::move(normalIndices), std::move(texIndices), vertexFormat);
+
+    mesh->buildBVH();
+    printStats(*mesh, name);
+    return mesh;
+}
+
+void MeshBuilder::setVertexFormat(VertexFormat format) {
+    vertexFormat = format;
+}
+
+VertexFormat MeshBuilder::getVertexFormat() {
+    return vertexFormat;
+}
 
-}
\ No newline at end of file
+void MeshBuilder::printStats(const Mesh& mesh, const std::string& name) {
+    // Meshes load in parallel, keep the lines whole
+    static std::mutex printMutex;
+    std::lock_guard<std::mutex> lock(printMutex);
+    mesh.getBVH().getStats().print(std::cout, name);
+}
@@ -5,31 +5,60 @@
 #ifndef MESHBUILDER_H
 #define MESHBUILDER_H
 
+#include <atomic>
+#include <future>
 #include <map>
+#include <mutex>
 
 #include "../ObjectClasses/Mesh.h"
+#include "AssimpImporter.h"
 
 #include <memory>
-#include <assimp/mesh.h>
-#include <assimp/scene.h>
 
 
 class MeshBuilder {
 public:
-    static std::shared_ptr<Mesh> getMesh(const std::string& filename) {
-        if (meshCache.count(filename)) {
-            return meshCache.at(filename);
-        }
+    // Loads each file once per vertex format, from its MeshCache file when
+    // that is up to date and otherwise from the source, writing the cache for
+    // the next run.
+    // Thread safe: concurrent calls for the same file wait for the first one
+    // instead of loading it again. Throws std::runtime_error when the file
+    // can't be loaded (and a later call tries again).
+    // OBJ files go through ObjParser, everything else through AssimpImporter
+    // with all of its parts merged. Files that can load buffers from other
+    // files (.gltf) are never given a MeshCache file. OBJ files are parsed on
+    // threadCount threads (0 for every hardware thread).
+    static std::shared_ptr<Mesh> getMesh(const std::string& filename, unsigned int threadCount = 0);
 
-        std::shared_ptr<Mesh> newMesh = buildMesh(filename);
-        meshCache[filename] = newMesh;
+    // The parts of an AssimpImporter file with their materials. Other files
+    // give a single part without a material, holding getMesh(filename).
+    // Imported models are neither cached in memory nor in MeshCache files.
+    static ImportedModel getModel(const std::string& filename, unsigned int threadCount = 0);
 
-        return newMesh;
-    }
+    // Mesh from in-memory geometry (generated meshes, benchmarks), with its
+    // BVH built like a loaded one. Not cached.
+    static std::shared_ptr<Mesh> createMesh(const std::string& name,
+        std::vector<glm::vec3> vertices,
+        std::vector<glm::vec3> normals,
+        std::vector<glm::vec2> texCoords,
+        std::vector<unsigned int> vertexIndices,
+        std::vector<unsigned int> normalIndices,
+        std::vector<unsigned int> texIndices);
+
+    // Vertex layout of the meshes built from now on, Float by default.
+    // Quantized positions are a quarter smaller on the GPU and off by at
+    // most half a 65535th of the mesh's extent.
+    static void setVertexFormat(VertexFormat format);
+    [[nodiscard]] static VertexFormat getVertexFormat();
 
 private:
-    static std::map<std::string, std::shared_ptr<Mesh>> meshCache;
-    static std::shared_ptr<Mesh> buildMesh(const std::string& meshFile);
+    static std::atomic<VertexFormat> vertexFormat;
+    static std::mutex cacheMutex;
+    // By file and vertex format, so setVertexFormat applies to loaded files
+    static std::map<std::pair<std::string, VertexFormat>, std::shared_future<std::shared_ptr<Mesh>>> meshCache;
+    static std::shared_ptr<Mesh> loadMesh(const std::string& meshFile, unsigned int threadCount);
+    static std::shared_ptr<Mesh> buildMesh(const std::string& meshFile, unsigned int threadCount);
+    static void printStats(const Mesh& mesh, const std::string& name);
 };
 
 #endif //MESHBUILDER_H
@@ -0,0 +1,306 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#include "MeshCache.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <type_traits>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+enum Section {
+    TEX_COORDS,
+    TEX_INDICES,
+    PACKED_VERTICES,
+    PACKED_INDICES,
+    TRIANGLE_PLANES,
+    BVH_NODES,
+    BVH_PRIMITIVES,
+    SECTION_COUNT
+};
+
+struct SectionEntry {
+    uint64_t offset;
+    uint64_t count;
+    // sizeof the element when written, catches struct changes without a
+    // version bump
+    uint32_t elementSize;
+    uint32_t padding;
+};
+
+constexpr char MAGIC[8] = {'P', 'T', 'M', 'E', 'S', 'H', '\0', '\0'};
+// Sections start on cache lines, so every array is aligned like in memory
+constexpr uint64_t SECTION_ALIGNMENT = 64;
+
+struct CacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+
+    uint64_t sourceSize;
+    int64_t sourceModified;
+    uint64_t sourceHash;
+
+    float boundsMin[3];
+    float boundsMax[3];
+    uint32_t vertexFormat;
+    float quantizationStep[3];
+
+    uint64_t bvhPrimitiveCount;
+    uint64_t bvhNodeCount;
+    uint64_t bvhLeafCount;
+    int32_t bvhMaxDepth;
+    float bvhSAHCost;
+    double bvhBuildTimeMs;
+
+    SectionEntry sections[SECTION_COUNT];
+};
+static_assert(std::is_trivially_copyable_v<CacheHeader>);
+
+std::atomic<bool> cacheEnabled = true;
+
+int64_t modifiedTime(const fs::path& path, std::error_code& error) {
+    return (int64_t)fs::last_write_time(path, error).time_since_epoch().count();
+}
+
+template<typename T>
+MappedArray<T> viewSection(const MappedFile& file, const CacheHeader& header, Section section) {
+    const SectionEntry& entry = header.sections[section];
+    return MappedArray<T>::view((const T*)(file.data() + entry.offset), entry.count);
+}
+
+// Everything load relies on, so a truncated or foreign file is never used
+bool isValid(const MappedFile& file, const CacheHeader& header) {
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != MeshCache::VERSION
+        || header.headerSize != sizeof(CacheHeader)) {
+        return false;
+    }
+    const uint32_t elementSizes[SECTION_COUNT] = {
+        sizeof(glm::vec2), sizeof(unsigned int),
+        sizeof(uint32_t), sizeof(uint32_t), sizeof(float),
+        sizeof(BVHNode), sizeof(uint32_t),
+    };
+    for (int section = 0; section < SECTION_COUNT; section++) {
+        const SectionEntry& entry = header.sections[section];
+        if (entry.elementSize != elementSizes[section] || entry.offset % SECTION_ALIGNMENT != 0
+            || entry.offset > file.size() || entry.count > (file.size() - entry.offset) / entry.elementSize) {
+            return false;
+        }
+    }
+
+    if (header.vertexFormat != (uint32_t)VertexFormat::Float && header.vertexFormat != (uint32_t)VertexFormat::Quantized) {
+        return false;
+    }
+    const uint64_t triangleCount = header.sections[PACKED_INDICES].count / 3;
+    return header.sections[PACKED_INDICES].count == 3 * triangleCount
+        && (header.sections[TEX_INDICES].count == 0 || header.sections[TEX_INDICES].count == 3 * triangleCount)
+        && header.sections[PACKED_VERTICES].count % VertexPacking::stride((VertexFormat)header.vertexFormat) == 0
+        && header.sections[TRIANGLE_PLANES].count == TriangleStore::PLANE_COUNT * triangleCount
+        && header.sections[BVH_NODES].count == header.bvhNodeCount;
+}
+
+}
+
+std::string MeshCache::cachePath(const std::string& sourceFile) {
+    return sourceFile + ".ptmesh";
+}
+
+void MeshCache::setEnabled(bool enabled) {
+    cacheEnabled = enabled;
+}
+
+bool MeshCache::isEnabled() {
+    return cacheEnabled;
+}
+
+uint64_t MeshCache::hashFile(const std::string& path) {
+    MappedFile file(path);
+    const unsigned char* bytes = file.data();
+    const size_t size = file.size();
+
+    // FNV-1a over 8 byte words with an extra shift to mix the high bits down,
+    // a few GB/s which is plenty to tell two versions of a mesh apart
+    uint64_t hash = 0xcbf29ce484222325ull ^ size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, sizeof(word));
+        hash = (hash ^ word) * 0x100000001b3ull;
+        hash ^= hash >> 29;
+    }
+    for (; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+std::shared_ptr<Mesh> MeshCache::load(const std::string& sourceFile, VertexFormat vertexFormat) {
+    if (!cacheEnabled) {
+        return nullptr;
+    }
+    const std::string path = cachePath(sourceFile);
+
+    std::error_code error;
+    const uintmax_t sourceSize = fs::file_size(sourceFile, error);
+    const int64_t sourceModified = error ? 0 : modifiedTime(sourceFile, error);
+    if (error || !fs::exists(path, error)) {
+        return nullptr;
+    }
+
+    try {
+        auto file = std::make_shared<MappedFile>(path);
+        if (file->size() < sizeof(CacheHeader)) {
+            return nullptr;
+        }
+        CacheHeader header;
+        std::memcpy(&header, file->data(), sizeof(header));
+        if (!isValid(*file, header) || header.sourceSize != sourceSize
+            || header.vertexFormat != (uint32_t)vertexFormat) {
+            return nullptr;
+        }
+
+        if (header.sourceModified != sourceModified) {
+            if (header.sourceHash != hashFile(sourceFile)) {
+                return nullptr;
+            }
+            // Same content, remember the new time so the next load skips the hash
+            std::fstream stream(path, std::ios::binary | std::ios::in | std::ios::out);
+            stream.seekp(offsetof(CacheHeader, sourceModified));
+            stream.write((const char*)&sourceModified, sizeof(sourceModified));
+        }
+
+        std::shared_ptr<Mesh> mesh(new Mesh());
+        mesh->mapping = file;
+        mesh->texCoords = viewSection<glm::vec2>(*file, header, TEX_COORDS);
+        mesh->texIndices = viewSection<unsigned int>(*file, header, TEX_INDICES);
+        mesh->vertexFormat = vertexFormat;
+        mesh->packedVertices = viewSection<uint32_t>(*file, header, PACKED_VERTICES);
+        mesh->packedIndices = viewSection<uint32_t>(*file, header, PACKED_INDICES);
+        mesh->triangleStore.assign(viewSection<float>(*file, header, TRIANGLE_PLANES),
+            header.sections[PACKED_INDICES].count / 3);
+        mesh->minBound = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+        mesh->maxBound = glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+        mesh->quantizationStep = glm::vec3(header.quantizationStep[0], header.quantizationStep[1],
+            header.quantizationStep[2]);
+
+        BVHStats stats;
+        stats.primitiveCount = header.bvhPrimitiveCount;
+        stats.nodeCount = header.bvhNodeCount;
+        stats.leafCount = header.bvhLeafCount;
+        stats.maxDepth = header.bvhMaxDepth;
+        stats.sahCost = header.bvhSAHCost;
+        stats.buildTimeMs = header.bvhBuildTimeMs;
+        mesh->bvh.assign(viewSection<BVHNode>(*file, header, BVH_NODES),
+            viewSection<uint32_t>(*file, header, BVH_PRIMITIVES), stats);
+        return mesh;
+    }
+    catch (const std::exception&) {
+        return nullptr;
+    }
+}
+
+bool MeshCache::save(const Mesh& mesh, const std::string& sourceFile) {
+    if (!cacheEnabled) {
+        return false;
+    }
+    const std::string path = cachePath(sourceFile);
+
+    CacheHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.headerSize = sizeof(CacheHeader);
+
+    std::error_code error;
+    header.sourceSize = fs::file_size(sourceFile, error);
+    header.sourceModified = error ? 0 : modifiedTime(sourceFile, error);
+    if (error) {
+        return false;
+    }
+    try {
+        header.sourceHash = hashFile(sourceFile);
+    }
+    catch (const std::exception&) {
+        return false;
+    }
+
+    for (int axis = 0; axis < 3; axis++) {
+        header.boundsMin[axis] = mesh.minBound[axis];
+        header.boundsMax[axis] = mesh.maxBound[axis];
+        header.quantizationStep[axis] = mesh.quantizationStep[axis];
+    }
+    header.vertexFormat = (uint32_t)mesh.vertexFormat;
+    const BVHStats& stats = mesh.bvh.getStats();
+    header.bvhPrimitiveCount = stats.primitiveCount;
+    header.bvhNodeCount = stats.nodeCount;
+    header.bvhLeafCount = stats.leafCount;
+    header.bvhMaxDepth = stats.maxDepth;
+    header.bvhSAHCost = stats.sahCost;
+    header.bvhBuildTimeMs = stats.buildTimeMs;
+
+    struct SectionData {
+        const void* data;
+        uint64_t count;
+        uint32_t elementSize;
+    };
+    auto sectionOf = [](auto elements) {
+        return SectionData{elements.data(), elements.size(), (uint32_t)sizeof(elements[0])};
+    };
+    const SectionData sections[SECTION_COUNT] = {
+        sectionOf(mesh.getUvs()),
+        sectionOf(mesh.getTexIndices()),
+        sectionOf(mesh.getPackedVertices()),
+        sectionOf(mesh.getPackedIndices()),
+        SectionData{mesh.triangleStore.getData(), TriangleStore::PLANE_COUNT * mesh.triangleStore.size(), sizeof(float)},
+        sectionOf(mesh.bvh.getNodes()),
+        sectionOf(mesh.bvh.getPrimitiveIndices()),
+    };
+
+    uint64_t offset = sizeof(CacheHeader);
+    for (int section = 0; section < SECTION_COUNT; section++) {
+        offset = (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+        header.sections[section] = {offset, sections[section].count, sections[section].elementSize, 0};
+        offset += sections[section].count * sections[section].elementSize;
+    }
+
+    // Written under a temporary name and renamed, so other loaders (threads
+    // or processes) only ever see a complete file
+    static std::atomic<uint64_t> saveCount = 0;
+    const std::string temporaryPath = path + ".tmp" + std::to_string(
+        std::hash<std::thread::id>()(std::this_thread::get_id()) ^ saveCount++);
+    {
+        std::ofstream stream(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!stream) {
+            return false;
+        }
+        stream.write((const char*)&header, sizeof(header));
+        const char zeros[SECTION_ALIGNMENT] = {};
+        for (int section = 0; section < SECTION_COUNT; section++) {
+            const uint64_t position = (uint64_t)stream.tellp();
+            stream.write(zeros, (std::streamsize)(header.sections[section].offset - position));
+            stream.write((const char*)sections[section].data,
+                (std::streamsize)(sections[section].count * sections[section].elementSize));
+        }
+        if (!stream) {
+            stream.close();
+            fs::remove(temporaryPath, error);
+            return false;
+        }
+    }
+
+    fs::rename(temporaryPath, path, error);
+    if (error) {
+        fs::remove(temporaryPath, error);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,47 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#ifndef MESHCACHE_H
+#define MESHCACHE_H
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "../ObjectClasses/Mesh.h"
+
+// Binary cache of a loaded mesh, written next to its source file as
+// <source>.ptmesh. It holds every array Mesh keeps after processing (the UVs
+// and their reordered indices, packed vertices and indices, CPU triangle
+// planes, the BVH and the bounds), so loading it is a map of the file: the arrays are
+// views into the mapping and only the pages that get used are read.
+//
+// A cache is used when its source has the size and modification time it was
+// written from. When only the time changed (a copy or a checkout), the
+// source's content hash decides, and a matching cache gets the new time.
+class MeshCache {
+public:
+    // Bumped whenever the layout of the file or of a cached struct changes,
+    // or loaders produce different geometry from the same source
+    static constexpr uint32_t VERSION = 4;
+
+    [[nodiscard]] static std::string cachePath(const std::string& sourceFile);
+
+    // The cached mesh of sourceFile, or nullptr when there is no up to date
+    // cache with vertices in vertexFormat. Never throws, a bad cache file is
+    // just not used.
+    static std::shared_ptr<Mesh> load(const std::string& sourceFile, VertexFormat vertexFormat);
+    // Writes the cache of mesh, loaded from sourceFile. Returns false when the
+    // file can't be written (a read only folder), which isn't an error.
+    static bool save(const Mesh& mesh, const std::string& sourceFile);
+
+    // Hash of the content of a file, what decides whether a cache is stale
+    // once the modification time changed
+    static uint64_t hashFile(const std::string& path);
+
+    // Caching is on by default
+    static void setEnabled(bool enabled);
+    [[nodiscard]] static bool isEnabled();
+};
+
+#endif //MESHCACHE_H
@@ -0,0 +1,382 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#include "ObjParser.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+
+#include "MappedFile.h"
+#include "ThreadPool.h"
+
+namespace {
+
+// Face corner without this attribute
+constexpr int32_t MISSING = INT32_MIN;
+
+struct ParseError {
+    const char* position;
+    std::string message;
+};
+
+// Everything read from one chunk of whole lines. Indices are zero based and
+// final, except that relative (negative) ones are relative to the chunk: the
+// positions listed in relative* still need the element count of the chunks
+// before this one.
+struct Chunk {
+    const char* begin = nullptr;
+    const char* end = nullptr;
+
+    std::vector<glm::vec3> vertices;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> texCoords;
+    // Three corners per triangle
+    std::vector<int32_t> vertexIndices;
+    std::vector<int32_t> texIndices;
+    std::vector<int32_t> normalIndices;
+    std::vector<size_t> relativeVertices;
+    std::vector<size_t> relativeTexCoords;
+    std::vector<size_t> relativeNormals;
+    size_t faceCount = 0;
+    bool hasTexCoords = false;
+    bool missingNormals = false;
+
+    // Element counts of the chunks before this one
+    size_t vertexBase = 0, texCoordBase = 0, normalBase = 0, triangleBase = 0;
+};
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+const char* skipSpaces(const char* p, const char* end) {
+    while (p < end && isSpace(*p)) {
+        p++;
+    }
+    return p;
+}
+
+float parseFloat(const char*& p, const char* end) {
+    p = skipSpaces(p, end);
+    // from_chars doesn't take a leading plus
+    if (p < end && *p == '+') {
+        p++;
+    }
+    float value = 0.0f;
+    auto [next, error] = std::from_chars(p, end, value);
+    if (error != std::errc()) {
+        throw ParseError{p, "expected a number"};
+    }
+    p = next;
+    return value;
+}
+
+// OBJ index: 1 based from the start, or negative from the last element so far
+int64_t parseIndex(const char*& p, const char* end) {
+    const char* start = p;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+    int64_t value = 0;
+    const char* digits = p;
+    while (p < end && *p >= '0' && *p <= '9') {
+        value = value * 10 + (*p - '0');
+        p++;
+        // Resolved indices are int32_t, keeping them clear of MISSING
+        if (value > INT32_MAX) {
+            throw ParseError{start, "index out of range"};
+        }
+    }
+    if (p == digits || value == 0) {
+        throw ParseError{start, "expected an index"};
+    }
+    return negative ? -value : value;
+}
+
+// Zero based index, relative to the chunk for negative OBJ indices
+int32_t resolveIndex(int64_t index, size_t chunkCount, size_t position, std::vector<size_t>& relative) {
+    if (index > 0) {
+        return (int32_t)(index - 1);
+    }
+    relative.push_back(position);
+    return (int32_t)((int64_t)chunkCount + index);
+}
+
+void parseChunk(Chunk& chunk) {
+    struct Corner {
+        int64_t vertex, texCoord, normal;
+    };
+    std::vector<Corner> corners;
+
+    const char* p = chunk.begin;
+    while (p < chunk.end) {
+        const char* lineEnd = (const char*)std::memchr(p, '\n', chunk.end - p);
+        if (lineEnd == nullptr) {
+            lineEnd = chunk.end;
+        }
+        const char* line = skipSpaces(p, lineEnd);
+        p = lineEnd + 1;
+
+        // Only v, vt, vn and f lines matter
+        if (lineEnd - line < 2 || (!isSpace(line[1]) && !(line[0] == 'v' && (line[1] == 't' || line[1] == 'n')))) {
+            continue;
+        }
+
+        if (line[0] == 'v' && isSpace(line[1])) {
+            const char* q = line + 1;
+            glm::vec3 vertex;
+            vertex.x = parseFloat(q, lineEnd);
+            vertex.y = parseFloat(q, lineEnd);
+            vertex.z = parseFloat(q, lineEnd);
+            chunk.vertices.push_back(vertex);
+        }
+        else if (line[0] == 'v' && line[1] == 't' && lineEnd - line > 2 && isSpace(line[2])) {
+            const char* q = line + 2;
+            glm::vec2 texCoord;
+            texCoord.x = parseFloat(q, lineEnd);
+            // v is optional
+            q = skipSpaces(q, lineEnd);
+            texCoord.y = q < lineEnd ? parseFloat(q, lineEnd) : 0.0f;
+            chunk.texCoords.push_back(texCoord);
+        }
+        else if (line[0] == 'v' && line[1] == 'n' && lineEnd - line > 2 && isSpace(line[2])) {
+            const char* q = line + 2;
+            glm::vec3 normal;
+            normal.x = parseFloat(q, lineEnd);
+            normal.y = parseFloat(q, lineEnd);
+            normal.z = parseFloat(q, lineEnd);
+            chunk.normals.push_back(normal);
+        }
+        else if (line[0] == 'f') {
+            corners.clear();
+            const char* q = skipSpaces(line + 1, lineEnd);
+            while (q < lineEnd) {
+                Corner corner{parseIndex(q, lineEnd), 0, 0};
+                if (q < lineEnd && *q == '/') {
+                    q++;
+                    if (q < lineEnd && *q != '/') {
+                        corner.texCoord = parseIndex(q, lineEnd);
+                    }
+                    if (q < lineEnd && *q == '/') {
+                        q++;
+                        corner.normal = parseIndex(q, lineEnd);
+                    }
+                }
+                if (q < lineEnd && !isSpace(*q)) {
+                    throw ParseError{q, "unexpected character in face"};
+                }
+                corners.push_back(corner);
+                q = skipSpaces(q, lineEnd);
+            }
+            if (corners.size() < 3) {
+                throw ParseError{line, "face with less than 3 corners"};
+            }
+
+            // Fan triangulation, fine for the convex polygons exporters write
+            chunk.faceCount++;
+            for (size_t i = 1; i + 1 < corners.size(); i++) {
+                for (const Corner& corner : {corners[0], corners[i], corners[i + 1]}) {
+                    const size_t position = chunk.vertexIndices.size();
+                    chunk.vertexIndices.push_back(resolveIndex(corner.vertex, chunk.vertices.size(),
+                        position, chunk.relativeVertices));
+                    if (corner.texCoord != 0) {
+                        chunk.hasTexCoords = true;
+                        chunk.texIndices.push_back(resolveIndex(corner.texCoord, chunk.texCoords.size(),
+                            position, chunk.relativeTexCoords));
+                    }
+                    else {
+                        chunk.texIndices.push_back(MISSING);
+                    }
+                    if (corner.normal != 0) {
+                        chunk.normalIndices.push_back(resolveIndex(corner.normal, chunk.normals.size(),
+                            position, chunk.relativeNormals));
+                    }
+                    else {
+                        chunk.missingNormals = true;
+                        chunk.normalIndices.push_back(MISSING);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Copies the indices of a chunk to their place in the mesh, adding base to
+// the relative ones, and checks them against elementCount. Corners without
+// the attribute are left for the caller to fill in.
+void copyIndices(const std::vector<int32_t>& source, const std::vector<size_t>& relative, size_t base,
+    size_t elementCount, unsigned int* destination, const char* attribute) {
+    for (size_t i = 0; i < source.size(); i++) {
+        destination[i] = (unsigned int)source[i];
+    }
+    for (size_t position : relative) {
+        destination[position] = (unsigned int)((int64_t)source[position] + (int64_t)base);
+    }
+    for (size_t i = 0; i < source.size(); i++) {
+        if (source[i] != MISSING && (size_t)destination[i] >= elementCount) {
+            throw std::runtime_error(std::string(attribute) + " index " + std::to_string((int64_t)destination[i] + 1)
+                + " out of range, there are " + std::to_string(elementCount));
+        }
+    }
+}
+
+}
+
+ObjData ObjParser::parse(const std::string& path, unsigned int threadCount, ObjParseStats* stats) {
+    auto start = std::chrono::steady_clock::now();
+    MappedFile file(path);
+    const char* text = (const char*)file.data();
+    const size_t size = file.size();
+
+    if (threadCount == 0) {
+        threadCount = ThreadPool::defaultThreadCount();
+    }
+    // A few chunks per thread so that one slow chunk doesn't hold up the rest
+    const size_t chunkCount = std::clamp<size_t>(size / MIN_CHUNK_SIZE, 1, (size_t)threadCount * 4);
+    std::vector<Chunk> chunks(chunkCount);
+    const char* chunkStart = text;
+    for (size_t i = 0; i < chunkCount; i++) {
+        const char* chunkEnd = text + size * (i + 1) / chunkCount;
+        if (i + 1 < chunkCount) {
+            const char* newline = (const char*)std::memchr(chunkEnd, '\n', text + size - chunkEnd);
+            chunkEnd = newline ? newline + 1 : text + size;
+        }
+        chunks[i].begin = chunkStart;
+        chunks[i].end = std::max(chunkStart, chunkEnd);
+        chunkStart = chunks[i].end;
+    }
+
+    const unsigned int workerCount = (unsigned int)std::min<size_t>(threadCount, chunkCount);
+    std::unique_ptr<ThreadPool> pool;
+    if (workerCount > 1) {
+        pool = std::make_unique<ThreadPool>(workerCount);
+    }
+    auto forEachChunk = [&](const std::function<void(size_t)>& body) {
+        if (pool) {
+            pool->parallelFor(chunkCount, [&](size_t chunk, unsigned int) {
+                body(chunk);
+            });
+        }
+        else {
+            for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+                body(chunk);
+            }
+        }
+    };
+
+    ObjData data;
+    try {
+        forEachChunk([&](size_t chunk) {
+            try {
+                parseChunk(chunks[chunk]);
+            }
+            catch (const ParseError& error) {
+                const size_t line = 1 + std::count(text, error.position, '\n');
+                throw std::runtime_error("line " + std::to_string(line) + ": " + error.message);
+            }
+        });
+
+        size_t vertexCount = 0, texCoordCount = 0, normalCount = 0, cornerCount = 0, faceCount = 0;
+        bool hasTexCoords = false, missingNormals = false;
+        for (Chunk& chunk : chunks) {
+            chunk.vertexBase = vertexCount;
+            chunk.texCoordBase = texCoordCount;
+            chunk.normalBase = normalCount;
+            chunk.triangleBase = cornerCount / 3;
+            vertexCount += chunk.vertices.size();
+            texCoordCount += chunk.texCoords.size();
+            normalCount += chunk.normals.size();
+            cornerCount += chunk.vertexIndices.size();
+            faceCount += chunk.faceCount;
+            hasTexCoords |= chunk.hasTexCoords;
+            missingNormals |= chunk.missingNormals;
+        }
+
+        // Corners without texture coordinates (when others have them) share
+        // an extra (0, 0), corners without a normal use their vertex's
+        // generated normal, stored after the ones from the file
+        data.vertices.resize(vertexCount);
+        data.texCoords.resize(texCoordCount + (hasTexCoords ? 1 : 0));
+        data.normals.resize(normalCount + (missingNormals ? vertexCount : 0));
+        data.vertexIndices.resize(cornerCount);
+        data.normalIndices.resize(cornerCount);
+        if (hasTexCoords) {
+            data.texIndices.resize(cornerCount);
+        }
+
+        forEachChunk([&](size_t index) {
+            const Chunk& chunk = chunks[index];
+            std::copy(chunk.vertices.begin(), chunk.vertices.end(), data.vertices.begin() + chunk.vertexBase);
+            std::copy(chunk.texCoords.begin(), chunk.texCoords.end(), data.texCoords.begin() + chunk.texCoordBase);
+            std::copy(chunk.normals.begin(), chunk.normals.end(), data.normals.begin() + chunk.normalBase);
+
+            const size_t corner = chunk.triangleBase * 3;
+            copyIndices(chunk.vertexIndices, chunk.relativeVertices, chunk.vertexBase, vertexCount,
+                data.vertexIndices.data() + corner, "vertex");
+            copyIndices(chunk.normalIndices, chunk.relativeNormals, chunk.normalBase, normalCount,
+                data.normalIndices.data() + corner, "normal");
+            for (size_t i = 0; i < chunk.normalIndices.size(); i++) {
+                if (chunk.normalIndices[i] == MISSING) {
+                    data.normalIndices[corner + i] = (unsigned int)normalCount + data.vertexIndices[corner + i];
+                }
+            }
+            if (hasTexCoords) {
+                copyIndices(chunk.texIndices, chunk.relativeTexCoords, chunk.texCoordBase, texCoordCount,
+                    data.texIndices.data() + corner, "texture coordinate");
+                for (size_t i = 0; i < chunk.texIndices.size(); i++) {
+                    if (chunk.texIndices[i] == MISSING) {
+                        data.texIndices[corner + i] = (unsigned int)texCoordCount;
+                    }
+                }
+            }
+        });
+
+        size_t generatedNormalCount = 0;
+        if (missingNormals) {
+            // Area weighted: the cross product's length is twice the area
+            glm::vec3* vertexNormals = data.normals.data() + normalCount;
+            std::fill(vertexNormals, vertexNormals + vertexCount, glm::vec3(0.0f));
+            for (size_t i = 0; i < cornerCount; i += 3) {
+                const glm::vec3& a = data.vertices[data.vertexIndices[i]];
+                const glm::vec3& b = data.vertices[data.vertexIndices[i + 1]];
+                const glm::vec3& c = data.vertices[data.vertexIndices[i + 2]];
+                const glm::vec3 faceNormal = glm::cross(b - a, c - a);
+                for (int k = 0; k < 3; k++) {
+                    vertexNormals[data.vertexIndices[i + k]] += faceNormal;
+                }
+            }
+            for (size_t i = 0; i < vertexCount; i++) {
+                const float length = glm::length(vertexNormals[i]);
+                vertexNormals[i] = length > 0.0f ? vertexNormals[i] / length : glm::vec3(0.0f, 1.0f, 0.0f);
+            }
+            for (const Chunk& chunk : chunks) {
+                generatedNormalCount += std::count(chunk.normalIndices.begin(), chunk.normalIndices.end(), MISSING);
+            }
+        }
+
+        if (stats) {
+            stats->bytes = size;
+            stats->faceCount = faceCount;
+            stats->triangleCount = cornerCount / 3;
+            stats->generatedNormalCount = generatedNormalCount;
+            stats->threadCount = workerCount;
+            stats->chunkCount = chunkCount;
+        }
+    }
+    catch (const std::exception& error) {
+        throw std::runtime_error("Failed to parse mesh file " + path + ", " + error.what());
+    }
+
+    if (stats) {
+        stats->parseMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    return data;
+}
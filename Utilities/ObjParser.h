@@ -0,0 +1,56 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#ifndef OBJPARSER_H
+#define OBJPARSER_H
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Geometry of an OBJ file as Mesh takes it: three indices per triangle into
+// each attribute array, all zero based
+struct ObjData {
+    std::vector<glm::vec3> vertices;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> texCoords;
+    std::vector<unsigned int> vertexIndices;
+    std::vector<unsigned int> normalIndices;
+    // Empty when no face has texture coordinates
+    std::vector<unsigned int> texIndices;
+};
+
+struct ObjParseStats {
+    size_t bytes = 0;
+    size_t faceCount = 0;
+    size_t triangleCount = 0;
+    // Face corners without a normal, which got a generated one
+    size_t generatedNormalCount = 0;
+    unsigned int threadCount = 0;
+    size_t chunkCount = 0;
+    double parseMs = 0.0;
+
+    [[nodiscard]] double megabytesPerSecond() const {
+        return parseMs > 0.0 ? (double)bytes / (1000.0 * parseMs) : 0.0;
+    }
+};
+
+// Reads Wavefront OBJ geometry. The file is mapped and split into chunks of
+// whole lines that are parsed in parallel, then stitched together.
+//
+// Faces may be v, v/vt, v//vn or v/vt/vn, with negative (relative) indices,
+// and polygons are fan triangulated. Corners without a normal get the area
+// weighted normal of their vertex. Everything but v, vt, vn and f (objects,
+// groups, materials, lines...) is skipped.
+class ObjParser {
+public:
+    // Chunks are at least this big, small files are parsed on one thread
+    static constexpr size_t MIN_CHUNK_SIZE = 1 << 20;
+
+    // Parses on threadCount threads (0 for every hardware thread). Throws
+    // std::runtime_error with the file and line of the first error.
+    static ObjData parse(const std::string& path, unsigned int threadCount = 0, ObjParseStats* stats = nullptr);
+};
+
+#endif //OBJPARSER_H
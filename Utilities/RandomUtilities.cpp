@@ -2,14 +2,19 @@
 // Created by Samuel on 2025-07-31.
 //
 
-#include <random>
+#include <algorithm>
+#include <cmath>
+#include <thread>
 #include <glm/geometric.hpp>
 #include <glm/vec3.hpp>
 
+#include "Sampler.h"
+
+// Free standing random numbers for code outside the path tracer (which uses
+// a Sampler so that its renders are deterministic). One PCG32 stream per thread.
 inline float randomFloat() {
-    static std::uniform_real_distribution<float> distribution(0.0, 1.0);
-    static std::mt19937 generator;
-    return distribution(generator);
+    thread_local PCG32 generator(0x853c49e6748fea9bULL, std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    return generator.nextFloat();
 }
 
 inline float randomFloat(float min, float max) {
@@ -21,17 +26,15 @@ static glm::vec3 randomVec3() {
 }
 
 static glm::vec3 randomVec3(float min, float max) {
-    return glm::vec3(randomFloat(min, max), randomFloat(), randomFloat());
+    return glm::vec3(randomFloat(min, max), randomFloat(min, max), randomFloat(min, max));
 }
 
+// Uniform on the unit sphere, mapped directly instead of rejection sampling
 inline glm::vec3 random_unit_vector() {
-    while (true) {
-        auto p = randomVec3(-1.0f, 1.0f);
-        auto lensq = glm::length(p) * glm::length(p);
-        if (1e-160 < lensq && lensq <= 1.0f) {
-            return glm::normalize(p);
-        }
-    }
+    float z = 1.0f - 2.0f * randomFloat();
+    float radius = std::sqrt(std::max(0.0f, 1.0f - z * z));
+    float phi = 2.0f * 3.14159265358979f * randomFloat();
+    return glm::vec3(radius * std::cos(phi), radius * std::sin(phi), z);
 }
 
 inline glm::vec3 onUnitSphere(glm::vec3 normal) {
@@ -0,0 +1,161 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#include "Sampler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr float PI = 3.14159265358979f;
+
+uint32_t hashBits(uint32_t x) {
+    // Integer hash with good avalanche (Wellons' lowbias32)
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+uint32_t hashCombine(uint32_t seed, uint32_t value) {
+    return seed ^ (hashBits(value) + 0x9e3779b9U + (seed << 6) + (seed >> 2));
+}
+
+uint32_t reverseBits(uint32_t x) {
+    x = ((x >> 1) & 0x55555555U) | ((x & 0x55555555U) << 1);
+    x = ((x >> 2) & 0x33333333U) | ((x & 0x33333333U) << 2);
+    x = ((x >> 4) & 0x0F0F0F0FU) | ((x & 0x0F0F0F0FU) << 4);
+    x = ((x >> 8) & 0x00FF00FFU) | ((x & 0x00FF00FFU) << 8);
+    return (x >> 16) | (x << 16);
+}
+
+// Hash that only lets lower bits affect higher bits, applied to the reversed
+// value it permutes every subtree of the binary digits like Owen scrambling
+uint32_t laineKarrasPermutation(uint32_t x, uint32_t seed) {
+    x += seed;
+    x ^= x * 0x6c50b47cU;
+    x ^= x * 0xb82f1e52U;
+    x ^= x * 0xc7afe638U;
+    x ^= x * 0x8d22f6e6U;
+    return x;
+}
+
+uint32_t nestedUniformScramble(uint32_t x, uint32_t seed) {
+    return reverseBits(laineKarrasPermutation(reverseBits(x), seed));
+}
+
+// First two Sobol dimensions as 0.32 fixed point: van der Corput and the
+// x + 1 polynomial, together a (0,2)-sequence
+uint32_t sobolDimension0(uint32_t index) {
+    return reverseBits(index);
+}
+
+uint32_t sobolDimension1(uint32_t index) {
+    uint32_t result = 0;
+    for (uint32_t direction = 1U << 31; index != 0; index >>= 1, direction ^= direction >> 1) {
+        if (index & 1U) {
+            result ^= direction;
+        }
+    }
+    return result;
+}
+
+float toUnitFloat(uint32_t x) {
+    return static_cast<float>(x >> 8) * 0x1p-24f;
+}
+
+}
+
+void PCG32::advance(uint64_t delta) {
+    // Brown, "Random Number Generation with Arbitrary Stride"
+    uint64_t accumulatedMultiplier = 1;
+    uint64_t accumulatedIncrement = 0;
+    uint64_t currentMultiplier = MULTIPLIER;
+    uint64_t currentIncrement = increment;
+    while (delta > 0) {
+        if (delta & 1) {
+            accumulatedMultiplier *= currentMultiplier;
+            accumulatedIncrement = accumulatedIncrement * currentMultiplier + currentIncrement;
+        }
+        currentIncrement = (currentMultiplier + 1) * currentIncrement;
+        currentMultiplier *= currentMultiplier;
+        delta >>= 1;
+    }
+    state = accumulatedMultiplier * state + accumulatedIncrement;
+}
+
+const char* samplerTypeName(SamplerType type) {
+    switch (type) {
+        case SamplerType::Sobol:
+            return "Sobol";
+        default:
+            return "independent";
+    }
+}
+
+void IndependentSampler::startPixelSample(glm::ivec2 pixel, uint32_t sampleIndex, uint32_t dimension) {
+    // One stream per pixel, the sample index picks the starting point
+    uint32_t pixelHash = hashCombine(hashCombine(seed, (uint32_t)pixel.x), (uint32_t)pixel.y);
+    generator.seed(hashBits(sampleIndex) | ((uint64_t)sampleIndex << 32), pixelHash);
+    if (dimension > 0) {
+        generator.advance(dimension);
+    }
+}
+
+void SobolSampler::startPixelSample(glm::ivec2 pixel, uint32_t sampleIndex, uint32_t dimension) {
+    pixelSeed = hashCombine(hashCombine(seed, (uint32_t)pixel.x), (uint32_t)pixel.y);
+    this->sampleIndex = sampleIndex;
+    this->dimension = dimension;
+}
+
+float SobolSampler::next1D() {
+    uint32_t dimensionSeed = hashCombine(pixelSeed, dimension);
+    dimension++;
+    uint32_t index = nestedUniformScramble(sampleIndex, dimensionSeed);
+    return toUnitFloat(nestedUniformScramble(sobolDimension0(index), hashCombine(dimensionSeed, 0)));
+}
+
+glm::vec2 SobolSampler::next2D() {
+    uint32_t dimensionSeed = hashCombine(pixelSeed, dimension);
+    dimension += 2;
+    // Shuffling the index gives every pair its own order of the same points
+    uint32_t index = nestedUniformScramble(sampleIndex, dimensionSeed);
+    uint32_t x = nestedUniformScramble(sobolDimension0(index), hashCombine(dimensionSeed, 0));
+    uint32_t y = nestedUniformScramble(sobolDimension1(index), hashCombine(dimensionSeed, 1));
+    return {toUnitFloat(x), toUnitFloat(y)};
+}
+
+glm::vec3 sampleCosineHemisphere(const glm::vec3& normal, glm::vec2 u) {
+    // Concentric square to disk mapping (Shirley and Chiu)
+    glm::vec2 offset = 2.0f * u - 1.0f;
+    glm::vec2 disk(0.0f);
+    if (offset.x != 0.0f || offset.y != 0.0f) {
+        float radius;
+        float theta;
+        if (std::abs(offset.x) > std::abs(offset.y)) {
+            radius = offset.x;
+            theta = (PI / 4.0f) * (offset.y / offset.x);
+        }
+        else {
+            radius = offset.y;
+            theta = (PI / 2.0f) - (PI / 4.0f) * (offset.x / offset.y);
+        }
+        disk = radius * glm::vec2(std::cos(theta), std::sin(theta));
+    }
+    // Projecting the disk up onto the hemisphere gives the cosine distribution
+    float z = std::sqrt(std::max(0.0f, 1.0f - disk.x * disk.x - disk.y * disk.y));
+
+    // Orthonormal basis around the normal without branches on its direction
+    // (Duff et al., "Building an Orthonormal Basis, Revisited")
+    float sign = std::copysign(1.0f, normal.z);
+    float a = -1.0f / (sign + normal.z);
+    float b = normal.x * normal.y * a;
+    glm::vec3 tangent(1.0f + sign * normal.x * normal.x * a, sign * b, -sign * normal.x);
+    glm::vec3 bitangent(b, sign + normal.y * normal.y * a, -normal.y);
+
+    return tangent * disk.x + bitangent * disk.y + normal * z;
+}
@@ -0,0 +1,113 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#ifndef SAMPLER_H
+#define SAMPLER_H
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+// PCG32 (O'Neill), 64 bits of state, one independent stream per increment
+class PCG32 {
+public:
+    PCG32() = default;
+    PCG32(uint64_t initState, uint64_t stream) {
+        seed(initState, stream);
+    }
+
+    void seed(uint64_t initState, uint64_t stream) {
+        state = 0;
+        increment = (stream << 1u) | 1u;
+        nextUInt();
+        state += initState;
+        nextUInt();
+    }
+
+    uint32_t nextUInt() {
+        uint64_t oldState = state;
+        state = oldState * MULTIPLIER + increment;
+        uint32_t xorShifted = static_cast<uint32_t>(((oldState >> 18u) ^ oldState) >> 27u);
+        uint32_t rotation = static_cast<uint32_t>(oldState >> 59u);
+        return (xorShifted >> rotation) | (xorShifted << ((0u - rotation) & 31u));
+    }
+
+    // Uniform in [0, 1)
+    float nextFloat() {
+        return static_cast<float>(nextUInt() >> 8) * 0x1p-24f;
+    }
+
+    // Jumps delta steps ahead in O(log delta)
+    void advance(uint64_t delta);
+
+private:
+    static constexpr uint64_t MULTIPLIER = 6364136223846793005ULL;
+    uint64_t state = 0x853c49e6748fea9bULL;
+    uint64_t increment = 0xda3e39cb94b95bdbULL;
+};
+
+enum class SamplerType {
+    // PCG32 stream per pixel sample
+    Independent,
+    // Owen-scrambled Sobol (0,2)-sequence, padded per dimension pair
+    Sobol
+};
+
+const char* samplerTypeName(SamplerType type);
+
+// Source of the random numbers of one path. Everything is a function of
+// (seed, pixel, sample index, dimension), never of the calling thread, so
+// renders are the same whatever the thread count or the tile order.
+class Sampler {
+public:
+    virtual ~Sampler() = default;
+
+    // Restarts at the given dimension of the given pixel sample. Paths that
+    // are traced in pieces (packets) pick up where the previous piece stopped.
+    virtual void startPixelSample(glm::ivec2 pixel, uint32_t sampleIndex, uint32_t dimension = 0) = 0;
+    virtual float next1D() = 0;
+    virtual glm::vec2 next2D() = 0;
+};
+
+class IndependentSampler final : public Sampler {
+public:
+    explicit IndependentSampler(uint32_t seed = 0) : seed(seed) {}
+
+    void startPixelSample(glm::ivec2 pixel, uint32_t sampleIndex, uint32_t dimension = 0) override;
+    float next1D() override {
+        return generator.nextFloat();
+    }
+    glm::vec2 next2D() override {
+        float x = generator.nextFloat();
+        return {x, generator.nextFloat()};
+    }
+
+private:
+    uint32_t seed;
+    PCG32 generator;
+};
+
+// Burley, "Practical Hash-based Owen Scrambling" (2020). Every 1D or 2D draw
+// gets its own shuffled and scrambled copy of the sequence, seeded from the
+// pixel and the dimension, which decorrelates the pairs and the pixels while
+// keeping the stratification of each pair.
+class SobolSampler final : public Sampler {
+public:
+    explicit SobolSampler(uint32_t seed = 0) : seed(seed) {}
+
+    void startPixelSample(glm::ivec2 pixel, uint32_t sampleIndex, uint32_t dimension = 0) override;
+    float next1D() override;
+    glm::vec2 next2D() override;
+
+private:
+    uint32_t seed;
+    uint32_t pixelSeed = 0;
+    uint32_t sampleIndex = 0;
+    uint32_t dimension = 0;
+};
+
+// Cosine weighted direction around the unit normal, from a 2D sample through
+// the concentric disk mapping (keeps the stratification of the sample)
+glm::vec3 sampleCosineHemisphere(const glm::vec3& normal, glm::vec2 u);
+
+#endif //SAMPLER_H
@@ -0,0 +1,274 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#include "SceneLoader.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+
+#include <nlohmann/json.hpp>
+
+#include "MeshBuilder.h"
+#include "ThreadPool.h"
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+namespace {
+
+using clock = std::chrono::steady_clock;
+
+double millisecondsSince(clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+}
+
+glm::vec3 readVec3(const json& object, const char* key, glm::vec3 fallback) {
+    auto it = object.find(key);
+    if (it == object.end()) {
+        return fallback;
+    }
+    if (!it->is_array() || it->size() != 3) {
+        throw std::runtime_error(std::string("\"") + key + "\" must be an array of 3 numbers");
+    }
+    return glm::vec3((*it)[0].get<float>(), (*it)[1].get<float>(), (*it)[2].get<float>());
+}
+
+float readFloat(const json& object, const char* key, float fallback) {
+    auto it = object.find(key);
+    return it == object.end() ? fallback : it->get<float>();
+}
+
+const std::string& readString(const json& object, const char* key) {
+    auto it = object.find(key);
+    if (it == object.end() || !it->is_string()) {
+        throw std::runtime_error(std::string("missing \"") + key + "\"");
+    }
+    return it->get_ref<const std::string&>();
+}
+
+}
+
+void SceneLoadReport::print(std::ostream& out, size_t slowestMeshes) const {
+    out << "Scene loaded in " << totalMs << " ms: "
+        << sphereCount << " spheres, " << meshInstanceCount << " mesh instances of "
+        << meshFileMs.size() << " files, " << uniqueMaterialCount << " materials ("
+        << materialCount << " defined)" << std::endl;
+    out << "  parse:                  " << parseMs << " ms" << std::endl;
+
+    double meshTotal = 0.0;
+    for (const auto& [file, ms] : meshFileMs) {
+        meshTotal += ms;
+    }
+    out << "  meshes:                 " << meshLoadMs << " ms on " << threadCount << " threads ("
+        << meshTotal << " ms summed)" << std::endl;
+
+    std::vector<std::pair<std::string, double>> slowest = meshFileMs;
+    std::sort(slowest.begin(), slowest.end(), [](const auto& a, const auto& b) {
+        return a.second > b.second;
+    });
+    for (size_t i = 0; i < std::min(slowestMeshes, slowest.size()); i++) {
+        out << "    " << slowest[i].first << ": " << slowest[i].second << " ms" << std::endl;
+    }
+
+    out << "  objects:                " << objectsMs << " ms" << std::endl;
+    out << "  acceleration structure: " << accelerationMs << " ms" << std::endl;
+}
+
+SceneFile SceneLoader::load(const std::string& path, Scene& scene, unsigned int threadCount) {
+    auto start = clock::now();
+    SceneFile result;
+    SceneLoadReport& report = result.report;
+
+    // Every error names the file, and the object when there is one
+    std::string context;
+    try {
+        std::ifstream stream(path);
+        if (!stream) {
+            throw std::runtime_error("can't open the file");
+        }
+        const json root = json::parse(stream);
+        report.parseMs = millisecondsSince(start);
+
+        if (auto it = root.find("camera"); it != root.end()) {
+            context = "camera";
+            result.camera.position = readVec3(*it, "position", result.camera.position);
+            result.camera.lookAt = readVec3(*it, "lookAt", result.camera.lookAt);
+            result.camera.up = readVec3(*it, "up", result.camera.up);
+            result.camera.fov = readFloat(*it, "fov", result.camera.fov);
+        }
+
+        // Materials with the same values share one instance, so the scene's
+        // MaterialTable holds each of them once. The same goes for the
+        // materials of imported files.
+        auto objectsStart = clock::now();
+        std::map<std::string, std::shared_ptr<Material>> materials;
+        std::map<std::array<float, 8>, std::shared_ptr<Material>> uniqueMaterials;
+        auto uniqueMaterial = [&](const std::shared_ptr<Material>& material) {
+            const glm::vec3 color = material->getColor();
+            const glm::vec3 emissionColor = material->getEmissionColor();
+            std::array<float, 8> key = {color.x, color.y, color.z, emissionColor.x, emissionColor.y, emissionColor.z,
+                material->getEmissionStrength(), material->getSpecular()};
+            std::shared_ptr<Material>& unique = uniqueMaterials[key];
+            if (!unique) {
+                unique = material;
+            }
+            return unique;
+        };
+        if (auto it = root.find("materials"); it != root.end()) {
+            for (const auto& [name, definition] : it->items()) {
+                context = "material \"" + name + "\"";
+                glm::vec3 color = readVec3(definition, "color", glm::vec3(1.0f));
+                glm::vec3 emissionColor = readVec3(definition, "emissionColor", glm::vec3(0.0f));
+                float emissionStrength = readFloat(definition, "emissionStrength", 0.0f);
+                float specular = readFloat(definition, "specular", 0.0f);
+
+                materials[name] = uniqueMaterial(std::make_shared<Material>(color, emissionColor, emissionStrength, specular));
+            }
+        }
+        report.materialCount = materials.size();
+        report.uniqueMaterialCount = uniqueMaterials.size();
+
+        auto findMaterial = [&](const json& object) {
+            const std::string& name = readString(object, "material");
+            auto it = materials.find(name);
+            if (it == materials.end()) {
+                throw std::runtime_error("unknown material \"" + name + "\"");
+            }
+            return it->second;
+        };
+
+        const json noObjects = json::array();
+        const json& sphereList = root.contains("spheres") ? root["spheres"] : noObjects;
+        const json& meshList = root.contains("meshes") ? root["meshes"] : noObjects;
+
+        std::vector<SphereObject>& spheres = scene.getSpheres();
+        spheres.reserve(spheres.size() + sphereList.size());
+        for (size_t i = 0; i < sphereList.size(); i++) {
+            context = "sphere " + std::to_string(i);
+            const json& sphere = sphereList[i];
+            spheres.emplace_back(
+                readFloat(sphere, "radius", 1.0f),
+                readVec3(sphere, "position", glm::vec3(0.0f)),
+                readVec3(sphere, "rotation", glm::vec3(0.0f)),
+                readVec3(sphere, "scale", glm::vec3(1.0f)),
+                findMaterial(sphere)
+            );
+        }
+        report.sphereCount = sphereList.size();
+
+        // Mesh paths are relative to the scene file, normalized so the same
+        // file always hits the same MeshBuilder cache entry
+        const fs::path sceneDirectory = fs::path(path).parent_path();
+        std::vector<std::string> meshFiles(meshList.size());
+        std::map<std::string, size_t> fileIndices;
+        std::vector<std::string> uniqueFiles;
+        // Files with a mesh that takes the file's own materials, which are
+        // imported as one part per material
+        std::vector<bool> importMaterials;
+        for (size_t i = 0; i < meshList.size(); i++) {
+            context = "mesh " + std::to_string(i);
+            fs::path file = readString(meshList[i], "file");
+            if (file.is_relative()) {
+                file = sceneDirectory / file;
+            }
+            meshFiles[i] = file.lexically_normal().generic_string();
+            if (fileIndices.emplace(meshFiles[i], uniqueFiles.size()).second) {
+                uniqueFiles.push_back(meshFiles[i]);
+                importMaterials.push_back(false);
+            }
+            if (!meshList[i].contains("material")) {
+                importMaterials[fileIndices[meshFiles[i]]] = true;
+            }
+        }
+        report.objectsMs = millisecondsSince(objectsStart);
+
+        // Largest files first, so a big mesh doesn't start last and hold up the rest
+        context.clear();
+        std::vector<uintmax_t> fileSizes(uniqueFiles.size(), 0);
+        for (size_t i = 0; i < uniqueFiles.size(); i++) {
+            std::error_code error;
+            fileSizes[i] = fs::file_size(uniqueFiles[i], error);
+        }
+        std::vector<size_t> loadOrder(uniqueFiles.size());
+        for (size_t i = 0; i < loadOrder.size(); i++) {
+            loadOrder[i] = i;
+        }
+        std::stable_sort(loadOrder.begin(), loadOrder.end(), [&](size_t a, size_t b) {
+            return fileSizes[a] > fileSizes[b];
+        });
+
+        auto meshStart = clock::now();
+        std::vector<std::vector<ImportedPart>> loadedParts(uniqueFiles.size());
+        report.meshFileMs.resize(uniqueFiles.size());
+        if (!uniqueFiles.empty()) {
+            // No point in more threads than files. What the files leave of the
+            // budget goes to each file's parser, rather than every parser
+            // starting a thread per core next to the loaders.
+            const unsigned int budget = threadCount == 0 ? ThreadPool::defaultThreadCount() : threadCount;
+            report.threadCount = std::min<unsigned int>(budget, (unsigned int)uniqueFiles.size());
+            const unsigned int parseThreads = std::max(1u, budget / report.threadCount);
+            ThreadPool pool(report.threadCount);
+            pool.parallelFor(uniqueFiles.size(), [&](size_t task, unsigned int) {
+                const size_t file = loadOrder[task];
+                auto fileStart = clock::now();
+                if (importMaterials[file]) {
+                    loadedParts[file] = MeshBuilder::getModel(uniqueFiles[file], parseThreads).parts;
+                }
+                else {
+                    loadedParts[file] = {{"", MeshBuilder::getMesh(uniqueFiles[file], parseThreads), nullptr}};
+                }
+                report.meshFileMs[file] = {uniqueFiles[file], millisecondsSince(fileStart)};
+            });
+        }
+        report.meshLoadMs = millisecondsSince(meshStart);
+
+        // Every part of a file becomes an object, with the mesh's material or
+        // else the part's own
+        objectsStart = clock::now();
+        std::vector<MeshObject>& meshes = scene.getMeshes();
+        const size_t firstMesh = meshes.size();
+        for (size_t i = 0; i < meshList.size(); i++) {
+            context = "mesh " + std::to_string(i);
+            const json& mesh = meshList[i];
+            std::shared_ptr<Material> meshMaterial = mesh.contains("material") ? findMaterial(mesh) : nullptr;
+            for (const ImportedPart& part : loadedParts[fileIndices[meshFiles[i]]]) {
+                std::shared_ptr<Material> material = meshMaterial ? meshMaterial : part.material;
+                if (!material) {
+                    throw std::runtime_error("missing \"material\", " + meshFiles[i] + " has none of its own");
+                }
+                if (!meshMaterial) {
+                    material = uniqueMaterial(material);
+                }
+                meshes.emplace_back(
+                    readVec3(mesh, "position", glm::vec3(0.0f)),
+                    readVec3(mesh, "rotation", glm::vec3(0.0f)),
+                    readVec3(mesh, "scale", glm::vec3(1.0f)),
+                    material
+                );
+                meshes.back().setMesh(part.mesh);
+            }
+        }
+        report.meshInstanceCount = meshes.size() - firstMesh;
+        report.uniqueMaterialCount = uniqueMaterials.size();
+        report.objectsMs += millisecondsSince(objectsStart);
+
+        context.clear();
+        auto accelerationStart = clock::now();
+        scene.updateAccelerationStructure();
+        scene.updateMaterialTable();
+        report.accelerationMs = millisecondsSince(accelerationStart);
+    }
+    catch (const std::exception& error) {
+        std::string where = context.empty() ? path : path + ", " + context;
+        throw std::runtime_error("Failed to load scene " + where + ": " + error.what());
+    }
+
+    report.totalMs = millisecondsSince(start);
+    return result;
+}
@@ -0,0 +1,82 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#ifndef SCENELOADER_H
+#define SCENELOADER_H
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+#include "../Camera.h"
+#include "../Scene.h"
+
+// Camera of a scene file, the aspect ratio comes from the output
+struct CameraDescription {
+    glm::vec3 position = glm::vec3(0.0f, 0.0f, 0.0f);
+    // Point the camera looks at
+    glm::vec3 lookAt = glm::vec3(0.0f, 0.0f, -1.0f);
+    glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f);
+    // Vertical, in degrees
+    float fov = 60.0f;
+
+    [[nodiscard]] Camera createCamera(float aspectRatio) const {
+        return Camera(fov, position, lookAt, up, aspectRatio);
+    }
+};
+
+struct SceneLoadReport {
+    double parseMs = 0.0;
+    // Wall time of the parallel mesh loads, and the time each file took
+    double meshLoadMs = 0.0;
+    std::vector<std::pair<std::string, double>> meshFileMs;
+    double objectsMs = 0.0;
+    double accelerationMs = 0.0;
+    double totalMs = 0.0;
+
+    size_t materialCount = 0;
+    // Materials left once identical definitions are merged
+    size_t uniqueMaterialCount = 0;
+    size_t sphereCount = 0;
+    // Objects created for the meshes, more than the meshes when a file is
+    // split by its materials
+    size_t meshInstanceCount = 0;
+    unsigned int threadCount = 0;
+
+    // Breakdown of the load time, with the slowest mesh files
+    void print(std::ostream& out, size_t slowestMeshes = 5) const;
+};
+
+struct SceneFile {
+    CameraDescription camera;
+    SceneLoadReport report;
+};
+
+// Loads JSON scene files:
+//
+// {
+//   "camera": { "position": [x, y, z], "lookAt": [x, y, z], "up": [x, y, z], "fov": 60 },
+//   "materials": {
+//     "name": { "color": [r, g, b], "emissionColor": [r, g, b], "emissionStrength": 0, "specular": 0 }
+//   },
+//   "spheres": [ { "radius": 1, "position": [...], "rotation": [...], "scale": [...], "material": "name" } ],
+//   "meshes": [ { "file": "../Meshes/a.obj", "position": [...], "rotation": [...], "scale": [...], "material": "name" } ]
+// }
+//
+// Rotations are in degrees. Everything but the material of an object and the
+// file of a mesh has a default. Mesh paths are relative to the scene file.
+// A mesh from a file with materials (glTF, FBX...) may leave out its
+// material, it then becomes one object per material of the file.
+class SceneLoader {
+public:
+    // Adds the objects of the file to scene, loading the distinct mesh files
+    // in parallel on threadCount threads in all, parsers included (0 for every
+    // hardware thread), and builds the acceleration structure. Throws std::runtime_error with the
+    // file and the problem when the scene can't be loaded.
+    static SceneFile load(const std::string& path, Scene& scene, unsigned int threadCount = 0);
+};
+
+#endif //SCENELOADER_H
@@ -0,0 +1,140 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned int threadCount) {
+    if (threadCount == 0) {
+        threadCount = defaultThreadCount();
+    }
+
+    queues.reserve(threadCount);
+    for (unsigned int i = 0; i < threadCount; i++) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+
+    workers.reserve(threadCount);
+    for (unsigned int i = 0; i < threadCount; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stopping = true;
+    }
+    jobCondition.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+unsigned int ThreadPool::defaultThreadCount() {
+    unsigned int count = std::thread::hardware_concurrency();
+    return count == 0 ? 1 : count;
+}
+
+void ThreadPool::parallelFor(size_t taskCount, const std::function<void(size_t, unsigned int)>& body) {
+    if (taskCount == 0) {
+        return;
+    }
+
+    // Only one job can be in flight at a time
+    std::lock_guard<std::mutex> submitLock(submitMutex);
+
+    // Hand out contiguous blocks so that every worker starts on its own
+    // region of the task range
+    size_t workerCount = queues.size();
+    for (size_t w = 0; w < workerCount; w++) {
+        size_t begin = taskCount * w / workerCount;
+        size_t end = taskCount * (w + 1) / workerCount;
+        std::lock_guard<std::mutex> queueLock(queues[w]->mutex);
+        for (size_t task = begin; task < end; task++) {
+            queues[w]->tasks.push_back(task);
+        }
+    }
+
+    failed = false;
+    firstError = nullptr;
+
+    std::unique_lock<std::mutex> lock(jobMutex);
+    job = &body;
+    busyWorkers = static_cast<unsigned int>(workerCount);
+    jobGeneration++;
+    jobCondition.notify_all();
+    doneCondition.wait(lock, [this] { return busyWorkers == 0; });
+    job = nullptr;
+
+    if (firstError) {
+        std::rethrow_exception(firstError);
+    }
+}
+
+void ThreadPool::workerLoop(unsigned int workerIndex) {
+    uint64_t seenGeneration = 0;
+    while (true) {
+        const std::function<void(size_t, unsigned int)>* currentJob;
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            jobCondition.wait(lock, [&] { return stopping || jobGeneration != seenGeneration; });
+            if (stopping) {
+                return;
+            }
+            seenGeneration = jobGeneration;
+            currentJob = job;
+        }
+
+        size_t task;
+        while (popTask(workerIndex, task)) {
+            // After a failure the remaining tasks are drained without running
+            if (failed) {
+                continue;
+            }
+            try {
+                (*currentJob)(task, workerIndex);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(jobMutex);
+                if (!firstError) {
+                    firstError = std::current_exception();
+                }
+                failed = true;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(jobMutex);
+        busyWorkers--;
+        if (busyWorkers == 0) {
+            doneCondition.notify_one();
+        }
+    }
+}
+
+bool ThreadPool::popTask(unsigned int workerIndex, size_t& task) {
+    {
+        WorkQueue& own = *queues[workerIndex];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = own.tasks.front();
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+
+    // Own queue is empty, steal from the back of the other workers' queues.
+    // No tasks are added while a job runs, so finding every queue empty means
+    // this worker is done.
+    size_t workerCount = queues.size();
+    for (size_t offset = 1; offset < workerCount; offset++) {
+        WorkQueue& victim = *queues[(workerIndex + offset) % workerCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.back();
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
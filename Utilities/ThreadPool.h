@@ -0,0 +1,69 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent pool of worker threads. Every parallelFor call hands each worker
+// a contiguous block of task indices in its own deque. A worker pops its own
+// tasks from the front (so neighbouring tasks stay on the same core) and,
+// once it runs dry, steals from the back of another worker's deque.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned int threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    [[nodiscard]] unsigned int size() const {
+        return static_cast<unsigned int>(workers.size());
+    }
+
+    // Runs body(taskIndex, workerIndex) for every task in [0, taskCount) and
+    // blocks until all of them are done. The first exception thrown by a task
+    // is rethrown here once the other workers have stopped.
+    void parallelFor(size_t taskCount, const std::function<void(size_t, unsigned int)>& body);
+
+    static unsigned int defaultThreadCount();
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+
+    std::mutex submitMutex;
+    std::mutex jobMutex;
+    std::condition_variable jobCondition;
+    std::condition_variable doneCondition;
+
+    const std::function<void(size_t, unsigned int)>* job = nullptr;
+    uint64_t jobGeneration = 0;
+    unsigned int busyWorkers = 0;
+    bool stopping = false;
+
+    std::atomic<bool> failed = false;
+    std::exception_ptr firstError;
+
+    void workerLoop(unsigned int workerIndex);
+    bool popTask(unsigned int workerIndex, size_t& task);
+};
+
+
+
+#endif //THREADPOOL_H
@@ -0,0 +1,93 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#include "VertexPacking.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+uint32_t packSnorm(float value) {
+    return (uint32_t)(uint16_t)(int16_t)std::round(std::clamp(value, -1.0f, 1.0f) * 32767.0f);
+}
+
+float unpackSnorm(uint32_t bits) {
+    return std::max((float)(int16_t)(uint16_t)bits / 32767.0f, -1.0f);
+}
+
+uint32_t floatBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+float bitsToFloat(uint32_t bits) {
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+uint32_t quantize(float value, float min, float step) {
+    if (step <= 0.0f) {
+        return 0;
+    }
+    return (uint32_t)std::clamp(std::round((value - min) / step), 0.0f, (float)VertexPacking::QUANTIZED_MAX);
+}
+
+}
+
+uint32_t VertexPacking::encodeNormal(const glm::vec3& normal) {
+    const float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    if (!(length > 0.0f)) {
+        // Decodes to +Z, degenerate normals are already meaningless
+        return 0;
+    }
+    float x = normal.x / length;
+    float y = normal.y / length;
+    if (normal.z < 0.0f) {
+        // Fold the lower half over the diagonals
+        const float foldedX = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        const float foldedY = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = foldedX;
+        y = foldedY;
+    }
+    return packSnorm(x) | packSnorm(y) << 16;
+}
+
+glm::vec3 VertexPacking::decodeNormal(uint32_t encoded) {
+    glm::vec3 normal(unpackSnorm(encoded & 0xFFFF), unpackSnorm(encoded >> 16), 0.0f);
+    normal.z = 1.0f - std::abs(normal.x) - std::abs(normal.y);
+    const float fold = std::max(-normal.z, 0.0f);
+    normal.x += normal.x >= 0.0f ? -fold : fold;
+    normal.y += normal.y >= 0.0f ? -fold : fold;
+    return glm::normalize(normal);
+}
+
+glm::vec3 VertexPacking::quantizationStep(const glm::vec3& min, const glm::vec3& max) {
+    return glm::max(max - min, glm::vec3(0.0f)) / (float)QUANTIZED_MAX;
+}
+
+void VertexPacking::pack(VertexFormat format, const glm::vec3& position, const glm::vec3& normal,
+    const glm::vec3& min, const glm::vec3& step, uint32_t* words) {
+    if (format == VertexFormat::Quantized) {
+        words[0] = quantize(position.x, min.x, step.x) | quantize(position.y, min.y, step.y) << 16;
+        words[1] = quantize(position.z, min.z, step.z);
+        words[2] = encodeNormal(normal);
+        return;
+    }
+    words[0] = floatBits(position.x);
+    words[1] = floatBits(position.y);
+    words[2] = floatBits(position.z);
+    words[3] = encodeNormal(normal);
+}
+
+glm::vec3 VertexPacking::unpackPosition(VertexFormat format, const uint32_t* words,
+    const glm::vec3& min, const glm::vec3& step) {
+    if (format == VertexFormat::Quantized) {
+        return min + glm::vec3((float)(words[0] & 0xFFFF), (float)(words[0] >> 16), (float)words[1]) * step;
+    }
+    return glm::vec3(bitsToFloat(words[0]), bitsToFloat(words[1]), bitsToFloat(words[2]));
+}
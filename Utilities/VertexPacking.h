@@ -0,0 +1,50 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#ifndef VERTEXPACKING_H
+#define VERTEXPACKING_H
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+// Layouts of the packed mesh vertices, which the shaders' vertex SSBO holds
+// as is. A vertex is a few 32 bit words, the last one its normal:
+//   Float:     x, y, z (float bits), normal
+//   Quantized: x | y << 16, z, normal
+// Quantized positions are 16 bit steps across the mesh bounds, from the
+// bounds' minimum.
+enum class VertexFormat : uint32_t {
+    Float = 0,
+    Quantized = 1
+};
+
+// Encoding and decoding of packed vertices, the raytrace shader decodes them
+// the same way
+class VertexPacking {
+public:
+    static constexpr uint32_t QUANTIZED_MAX = 0xFFFF;
+
+    // Words per vertex
+    [[nodiscard]] static uint32_t stride(VertexFormat format) {
+        return format == VertexFormat::Quantized ? 3 : 4;
+    }
+
+    // Unit vector folded onto an octahedron and stored as two 16 bit snorms,
+    // like GLSL's packSnorm2x16. Decodes within 0.04 degrees.
+    [[nodiscard]] static uint32_t encodeNormal(const glm::vec3& normal);
+    // Normalized, like unpackSnorm2x16 and the unfolding in the shader
+    [[nodiscard]] static glm::vec3 decodeNormal(uint32_t encoded);
+
+    // Distance between neighbouring quantized positions along each axis,
+    // zero along a flat axis
+    [[nodiscard]] static glm::vec3 quantizationStep(const glm::vec3& min, const glm::vec3& max);
+
+    // Writes stride(format) words. min and step only matter when quantized.
+    static void pack(VertexFormat format, const glm::vec3& position, const glm::vec3& normal,
+        const glm::vec3& min, const glm::vec3& step, uint32_t* words);
+    [[nodiscard]] static glm::vec3 unpackPosition(VertexFormat format, const uint32_t* words,
+        const glm::vec3& min, const glm::vec3& step);
+};
+
+#endif //VERTEXPACKING_H
@@ -0,0 +1,122 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#include "WavefrontTracer.h"
+
+#include <algorithm>
+#include <cstdio>
+
+bool WavefrontTracer::isSupported() {
+    static const bool supported = [] {
+        GLint blocks = 0, bindings = 0;
+        glGetIntegerv(GL_MAX_COMPUTE_SHADER_STORAGE_BLOCKS, &blocks);
+        glGetIntegerv(GL_MAX_SHADER_STORAGE_BUFFER_BINDINGS, &bindings);
+        if (blocks < STORAGE_BLOCKS || bindings <= (GLint)DISPATCH_BINDING) {
+            printf("Wavefront unavailable: %d storage blocks per compute shader, %d bindings\n", blocks, bindings);
+            return false;
+        }
+        return true;
+    }();
+    return supported;
+}
+
+void WavefrontTracer::createBuffers() {
+    const int pixelCount = width * height;
+    // Whole samples per batch, at least one
+    pathCapacity = std::max(pixelCount, MAX_PATHS / pixelCount * pixelCount);
+
+    pathBuffer = createBuffer(PATH_BINDING, pathCapacity * PATH_STATE_SIZE);
+    pathHitBuffer = createBuffer(PATH_HIT_BINDING, pathCapacity * PATH_HIT_SIZE);
+    // Four counts, then two queues of pathCapacity slots
+    queueBuffer = createBuffer(QUEUE_BINDING, 4 * sizeof(GLuint) + 2 * pathCapacity * sizeof(GLuint));
+    dispatchBuffer = createBuffer(DISPATCH_BINDING, 3 * sizeof(GLuint));
+}
+
+GLuint WavefrontTracer::createBuffer(GLuint binding, size_t size) {
+    GLuint buffer;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+    // Only ever written and read by the kernels
+    glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)size, nullptr, GL_DYNAMIC_COPY);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, buffer);
+    return buffer;
+}
+
+void WavefrontTracer::release() {
+    for (GLuint* buffer : {&pathBuffer, &pathHitBuffer, &queueBuffer, &dispatchBuffer}) {
+        glDeleteBuffers(1, buffer);
+        *buffer = 0;
+    }
+    pathCapacity = 0;
+}
+
+WavefrontTracer::Kernels& WavefrontTracer::getKernels(bool denoise) {
+    auto found = kernels.find(denoise);
+    if (found != kernels.end()) {
+        return found->second;
+    }
+    if (kernels.empty()) {
+        queueKernel = ComputeShader("Shaders/wavefront_queue.comp.glsl", sceneDefines);
+    }
+    ShaderDefines defines = sceneDefines;
+    defines["DENOISER"] = denoise ? "1" : "0";
+    // All of them compile at once, finished at their first use
+    Kernels created{
+        ComputeShader("Shaders/wavefront_generate.comp.glsl", defines),
+        ComputeShader("Shaders/wavefront_extend.comp.glsl", defines),
+        ComputeShader("Shaders/wavefront_shade.comp.glsl", defines),
+        ComputeShader("Shaders/wavefront_resolve.comp.glsl", defines),
+    };
+    return kernels.emplace(denoise, std::move(created)).first->second;
+}
+
+void WavefrontTracer::trace(bool denoise, int raysPerPixel, int maxBounces, GLuint noisyTexture) {
+    if (pathCapacity == 0) {
+        createBuffers();
+    }
+    Kernels& k = getKernels(denoise);
+    const int pixelCount = width * height;
+    const int samples = denoise ? 1 : raysPerPixel;
+    const int pathLength = denoise ? maxBounces + 1 : maxBounces;
+    const int samplesPerBatch = pathCapacity / pixelCount;
+
+    // Resolve adds each batch to the sum of the previous ones
+    glBindImageTexture(0, noisyTexture, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA32F);
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, dispatchBuffer);
+
+    for (int firstSample = 0; firstSample < samples; firstSample += samplesPerBatch) {
+        const int batchSamples = std::min(samplesPerBatch, samples - firstSample);
+        const int pathCount = batchSamples * pixelCount;
+
+        k.generate.use();
+        k.generate.setInt("PathCount", pathCount);
+        k.generate.setInt("FirstSample", firstSample);
+        k.generate.dispatch((pathCount + GROUP_SIZE - 1) / GROUP_SIZE, 1, 1, GL_SHADER_STORAGE_BARRIER_BIT);
+
+        // Bounces past the end of the longest path find empty queues and
+        // dispatch no groups
+        for (int bounce = 0; bounce < pathLength; bounce++) {
+            const int queue = bounce & 1;
+            queueKernel.use();
+            queueKernel.setInt("CurrentQueue", queue);
+            queueKernel.dispatch(1, 1, 1, GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+
+            k.extend.use();
+            k.extend.setInt("PathCount", pathCount);
+            k.extend.setInt("CurrentQueue", queue);
+            k.extend.dispatchIndirect(0, GL_SHADER_STORAGE_BARRIER_BIT);
+
+            k.shade.use();
+            k.shade.setInt("PathCount", pathCount);
+            k.shade.setInt("CurrentQueue", queue);
+            k.shade.dispatchIndirect(0, GL_SHADER_STORAGE_BARRIER_BIT);
+        }
+
+        k.resolve.use();
+        k.resolve.setInt("PathCount", pathCount);
+        k.resolve.setInt("FirstSample", firstSample);
+        k.resolve.setInt("SamplesPerBatch", batchSamples);
+        k.resolve.dispatch((width + 15) / 16, (height + 15) / 16, 1, GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    }
+}
@@ -0,0 +1,76 @@
+//
+// Created by Samuel on 10/17/2026.
+//
+
+#ifndef WAVEFRONTTRACER_H
+#define WAVEFRONTTRACER_H
+#include <map>
+
+#include "ComputeShader.h"
+
+// Path tracing split into small kernels over queues of paths instead of one
+// thread following its path to the end. Each bounce runs extend (closest
+// hit) then shade (light and next ray) on only the paths still alive, which
+// shade compacts into the next queue, so warps stay full at any depth. The
+// queue sizes never come back to the CPU: a one-invocation kernel turns
+// them into glDispatchComputeIndirect arguments.
+//
+// Renders the same image as the raytrace megakernel, except that the
+// samples of a pixel don't share one random sequence without the denoiser.
+class WavefrontTracer {
+public:
+    // Paths per batch, samples beyond it are traced in several batches
+    static constexpr int MAX_PATHS = 1 << 21;
+    // Match PathState, PathHit and WAVEFRONT_GROUP_SIZE of wavefront.glsl
+    static constexpr size_t PATH_STATE_SIZE = 64;
+    static constexpr size_t PATH_HIT_SIZE = 32;
+    static constexpr int GROUP_SIZE = 64;
+    // SSBO bindings after the scene's
+    static constexpr GLuint PATH_BINDING = 8;
+    static constexpr GLuint PATH_HIT_BINDING = 9;
+    static constexpr GLuint QUEUE_BINDING = 10;
+    static constexpr GLuint DISPATCH_BINDING = 11;
+    // Scene and path buffers declared by extend and shade, over the 8 that
+    // GL 4.3 guarantees
+    static constexpr GLint STORAGE_BLOCKS = 11;
+
+    // Whether the driver allows STORAGE_BLOCKS buffers in one compute shader
+    // and bindings up to DISPATCH_BINDING. Asked once, needs the GL context.
+    [[nodiscard]] static bool isSupported();
+
+    WavefrontTracer(int width, int height) : width(width), height(height) {
+    }
+
+    void release();
+    // Kernels are compiled at their first trace() with these, which describe
+    // the scene like the megakernel's
+    void setSceneDefines(const ShaderDefines& defines) {
+        sceneDefines = defines;
+    }
+
+    // Writes the frame's radiance to noisyTexture, and the G-buffer images
+    // bound by SVGFDenoiser::bindTexture when denoising. FrameData and the
+    // scene buffers have to be bound. The path buffers, over 200 MiB at 1080p,
+    // are only created by the first call.
+    void trace(bool denoise, int raysPerPixel, int maxBounces, GLuint noisyTexture);
+
+private:
+    struct Kernels {
+        ComputeShader generate, extend, shade, resolve;
+    };
+
+    int width, height;
+    int pathCapacity = 0;
+    GLuint pathBuffer = 0, pathHitBuffer = 0, queueBuffer = 0, dispatchBuffer = 0;
+
+    ShaderDefines sceneDefines;
+    // By denoiser setting
+    std::map<bool, Kernels> kernels;
+    ComputeShader queueKernel;
+
+    void createBuffers();
+    Kernels& getKernels(bool denoise);
+    GLuint createBuffer(GLuint binding, size_t size);
+};
+
+#endif //WAVEFRONTTRACER_H
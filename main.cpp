@@ -1,4 +1,3 @@
-#define STB_IMAGE_WRITE_IMPLEMENTATION
 #include <filesystem>
 
 #include <fstream>
@@ -22,6 +21,9 @@
 #include "Engine.h"
 #include "Scene.h"
 #include "iostream"
+#include "Utilities/Benchmark.h"
+#include "Utilities/ImageWriter.h"
+#include "Utilities/SceneLoader.h"
 
 
 struct RayTracerSettings {
@@ -29,53 +31,6 @@ struct RayTracerSettings {
     int rayPerPixel;
 };
 
-void convertDataToPPM(const char *filename, int width, int height, const std::vector<glm::vec3> data) {
-
-    std::vector<unsigned char> image;
-    image.reserve(width * height * 3);
-
-    for (const auto &color : data) {
-        glm::vec3 correctedColor = glm::clamp(color, glm::vec3(0, 0, 0), glm::vec3(1, 1, 1));
-        image.push_back(static_cast<unsigned char>(correctedColor.x * 255.999));
-        image.push_back(static_cast<unsigned char>(correctedColor.y * 255.999));
-        image.push_back(static_cast<unsigned char>(correctedColor.z * 255.999));
-    }
-
-    FILE *file = fopen(filename, "wb");
-    if (!file) {
-        perror("Failed to open file");
-        return;
-    }
-
-    // Write the header
-    fprintf(file, "P6\n"); // P6 indicates a binary PPM file
-    fprintf(file, "%d %d\n", width, height);
-    fprintf(file, "255\n"); // Maximum color value
-
-
-    fwrite(image.data(), 1, image.size(), file);
-
-    fclose(file);
-}
-
-void writePPM(const char *filename, int width, int height, const std::vector<unsigned char> image) {
-    FILE *file = fopen(filename, "wb");
-    if (!file) {
-        perror("Failed to open file");
-        return;
-    }
-
-    // Write the header
-    fprintf(file, "P6\n"); // P6 indicates a binary PPM file
-    fprintf(file, "%d %d\n", width, height);
-    fprintf(file, "255\n"); // Maximum color value
-
-
-    fwrite(image.data(), 1, image.size(), file);
-
-    fclose(file);
-}
-
 void showTime(double time, std::string title) {
     std::cout << title << " (s): " << time << " seconds" << std::endl;
     std::cout << title << " (min): " << time / 60 << " minutes" << std::endl;
@@ -101,7 +56,7 @@ bool initializeGLFW(int width, int height, const char *title, GLFWwindow **windo
     return true;
 }
 
-int main() {
+int main(int argc, char** argv) {
     std::cout << "Hello World!\n";
 
     int width = 1920;
@@ -112,7 +67,68 @@ int main() {
 
     Camera camera(60.f, glm::vec3(-8, -0, -1), glm::vec3(-0.78f, -1.f, -0.01f), glm::vec3(0.0f, 1.0f, 0.0f), aspectRatio);
     Scene scene(5, 10, &camera);
-    scene.buildDefaultScene();
+    // --scene <file> opens a scene file instead of the built in scene
+    if (argc > 2 && std::string(argv[1]) == "--scene") {
+        try {
+            SceneFile file = SceneLoader::load(argv[2], scene);
+            file.report.print(std::cout);
+            camera = file.camera.createCamera(aspectRatio);
+        }
+        catch (const std::runtime_error& error) {
+            printf("%s\n", error.what());
+            return 1;
+        }
+    }
+    else {
+        scene.buildDefaultScene();
+    }
+
+    // CPU tracer benchmark, doesn't need a window
+    if (argc > 1 && std::string(argv[1]) == "--cpu-benchmark") {
+        RenderSettings settings;
+        settings.width = width / 4;
+        settings.height = height / 4;
+        benchmarkCPURender(scene, settings);
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "--scaling-benchmark") {
+        benchmarkObjectScaling();
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "--packet-benchmark") {
+        RenderSettings settings;
+        settings.width = width / 4;
+        settings.height = height / 4;
+        benchmarkPacketTracing(scene, settings);
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "--bvh-benchmark") {
+        benchmarkBVHLayouts();
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "--obj-benchmark") {
+        benchmarkObjParser();
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "--mesh-cache-benchmark") {
+        benchmarkMeshCache();
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "--sampler-benchmark") {
+        RenderSettings settings;
+        settings.width = width / 4;
+        settings.height = height / 4;
+        benchmarkSamplers(scene, settings);
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "--adaptive-benchmark") {
+        RenderSettings settings;
+        settings.width = width / 4;
+        settings.height = height / 4;
+        benchmarkAdaptiveSampling(scene, settings);
+        writeImage("sampleCounts.ppm", settings.width, settings.height, scene.getSampleCountImage());
+        return 0;
+    }
 
     Engine engine("Hello World", width, height);
 
@@ -123,8 +139,15 @@ int main() {
 
     engine.run();
 /*
-    std::vector<glm::vec3> image = scene.renderTest();
-    convertDataToPPM("renderTest.ppm", width, height, image);
+    RenderSettings settings;
+    settings.width = width;
+    settings.height = height;
+    settings.onProgress = [](int tilesDone, int tileCount) {
+        printf("\rTiles: %d/%d", tilesDone, tileCount);
+    };
+    std::vector<glm::vec3> image = scene.render(settings);
+    writeImage("renderTest.ppm", width, height, image);
+    writeImage("sampleCounts.ppm", width, height, scene.getSampleCountImage());
 */
     return 0;
 }
\ No newline at end of file